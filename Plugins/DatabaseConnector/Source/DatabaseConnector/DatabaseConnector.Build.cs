@@ -28,6 +28,9 @@ public class DatabaseConnector : ModuleRules
 		if (Target.Platform == UnrealTargetPlatform.Win64)
         {
 			AddLibrary(Path.Combine(NanodbcRootPath, "lib/nanodbc.lib"));
+
+			// Also called directly for what nanodbc doesn't expose.
+			PublicSystemLibraries.Add("odbc32.lib");
 		}
 
 		// Linux Libraries
@@ -73,6 +76,9 @@ public class DatabaseConnector : ModuleRules
 
 		// Definitions
 		PublicDefinitions.Add("WITH_DATABASE_ODBC_CONNECTOR=1");
+
+		// ODBC only notifies asynchronous completions with Windows events.
+		PublicDefinitions.Add("WITH_DATABASE_ASYNC_EXECUTION=" + (Target.Platform == UnrealTargetPlatform.Win64 ? "1" : "0"));
 	}
 
 	/**
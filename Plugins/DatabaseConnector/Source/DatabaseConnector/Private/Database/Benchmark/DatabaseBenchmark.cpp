@@ -0,0 +1,546 @@
+// Copyright Pandores Marketplace 2021. All Rights Reserved.
+
+#include "CoreMinimal.h"
+
+#if !UE_BUILD_SHIPPING
+
+#include "HAL/IConsoleManager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Misc/EngineVersion.h"
+#include "Async/ParallelFor.h"
+#include "UObject/StructOnScope.h"
+
+#include "Database/Value.h"
+#include "Database/QueryResult.h"
+#include "Database/PoolSettings.h"
+#include "Database/Core/QueryResultInternal.h"
+#include "Database/Core/OdbClient.h"
+#include "Database/Nodes/DatabaseNodes.h"
+
+#include "DatabaseConnectorModule.h"
+
+/**
+ * Measures the hot paths of the plugin and saves the results as JSON so they can be compared across versions.
+ * Offline benchmarks only use in-memory results. ODBC ones need a connection string, a file-backed driver
+ * such as SQLite ODBC runs them without network.
+ *
+ * Usage: Database.Benchmark [Rows=10000] [Url="DRIVER=SQLite3;Database=Benchmark.db"]
+*/
+class FDatabaseBenchmark
+{
+private:
+	struct FResult
+	{
+		FString Name;
+		int64	Operations;
+		double	Seconds;
+	};
+
+	/**
+	 * The connections opened for ODBC benchmarks.
+	*/
+	static constexpr int32 ConnectionCount = 4;
+
+	/**
+	 * Threads acquiring connections per opened connection, to measure contention.
+	*/
+	static constexpr int32 ContentionFactor = 4;
+
+public:
+	FDatabaseBenchmark(FOutputDevice& InAr, const int32 InRowCount)
+		: Ar(InAr)
+		, RowCount(FMath::Max(InRowCount, 1))
+	{
+	}
+
+	void RunOffline()
+	{
+		RunValueBenchmarks();
+		RunColumnBenchmarks();
+		RunAccessorBenchmarks();
+		RunBlueprintBenchmarks();
+	}
+
+	void RunOdbc(const FString& Url)
+	{
+		FConnectionPool Pool;
+
+		if (Pool.Create(Url, FDatabasePoolSettings::Fixed(ConnectionCount)) != EDatabaseError::None)
+		{
+			Ar.Log(TEXT("Failed to connect: ODBC benchmarks skipped."));
+			return;
+		}
+
+		RunPoolBenchmarks(Pool, Url);
+		RunDecodeBenchmarks(Pool, Url);
+	}
+
+	/**
+	 * Writes the results to Saved/DatabaseConnector/Benchmarks.
+	*/
+	void Save() const
+	{
+		FString Json = TEXT("{\n");
+
+		Json += FString::Printf(TEXT("\t\"engine\": \"%s\",\n"),   *FEngineVersion::Current().ToString());
+		Json += FString::Printf(TEXT("\t\"platform\": \"%s\",\n"), ANSI_TO_TCHAR(FPlatformProperties::IniPlatformName()));
+		Json += FString::Printf(TEXT("\t\"date\": \"%s\",\n"),	   *FDateTime::UtcNow().ToIso8601());
+		Json += FString::Printf(TEXT("\t\"rows\": %d,\n"),		   RowCount);
+		Json += TEXT("\t\"results\": [\n");
+
+		for (int32 i = 0; i < Results.Num(); ++i)
+		{
+			const FResult& Result = Results[i];
+
+			Json += FString::Printf(TEXT("\t\t{ \"name\": \"%s\", \"operations\": %lld, \"totalMs\": %.3f, \"nsPerOperation\": %.2f }%s\n"),
+				*Result.Name, Result.Operations, Result.Seconds * 1000., GetNanosecondsPerOperation(Result), i + 1 < Results.Num() ? TEXT(",") : TEXT(""));
+		}
+
+		Json += TEXT("\t]\n}\n");
+
+		const FString Path = FPaths::ProjectSavedDir() / TEXT("DatabaseConnector/Benchmarks")
+			/ FString::Printf(TEXT("Benchmark-%s.json"), *FDateTime::UtcNow().ToString());
+
+		if (FFileHelper::SaveStringToFile(Json, *Path))
+		{
+			Ar.Logf(TEXT("Benchmark results saved to %s."), *FPaths::ConvertRelativePathToFull(Path));
+		}
+		else
+		{
+			Ar.Logf(TEXT("Failed to save benchmark results to %s."), *Path);
+		}
+	}
+
+private:
+	/**
+	 * Runs the function once and records its duration.
+	 * @param Operations The number of operations the function does, to report the cost of one.
+	*/
+	template<typename TFunction>
+	void Measure(const TCHAR* const Name, const int64 Operations, TFunction&& Function)
+	{
+		const double Start = FPlatformTime::Seconds();
+
+		Function();
+
+		FResult& Result = Results.Add_GetRef({ Name, Operations, FPlatformTime::Seconds() - Start });
+
+		Ar.Logf(TEXT("%-32s %10.2f ns/op (%lld ops)"), Name, GetNanosecondsPerOperation(Result), Operations);
+	}
+
+	static double GetNanosecondsPerOperation(const FResult& Result)
+	{
+		return Result.Operations > 0 ? Result.Seconds * 1000000000. / Result.Operations : 0.;
+	}
+
+	/**
+	 * Keeps the compiler from removing the measured work.
+	*/
+	void Consume(const FDatabaseValue& Value)
+	{
+		Sink += (int64)Value.GetType();
+	}
+
+	static FString MakeString(const int32 Index)
+	{
+		return FString::Printf(TEXT("Benchmark string %d"), Index % 64);
+	}
+
+	static FDatabaseValue MakeValue(const EDatabaseValueType Type, const int32 Index)
+	{
+		switch (Type)
+		{
+		case EDatabaseValueType::Boolean:	return FDatabaseValue(Index % 2 == 0);
+		case EDatabaseValueType::Int32:		return FDatabaseValue((int32)Index);
+		case EDatabaseValueType::Int64:		return FDatabaseValue((int64)Index * 1000000);
+		case EDatabaseValueType::Double:	return FDatabaseValue(Index * 0.5);
+		case EDatabaseValueType::String:	return FDatabaseValue(MakeString(Index));
+		case EDatabaseValueType::Timestamp: return FDatabaseValue(FDatabaseTimestamp::Now());
+		case EDatabaseValueType::Date:		return FDatabaseValue(FDatabaseDate::Now());
+		default:							return FDatabaseValue::Null();
+		}
+	}
+
+	/**
+	 * The types measured, also the columns of generated results and of the benchmark table.
+	*/
+	static const TArray<EDatabaseValueType>& GetValueTypes()
+	{
+		static const TArray<EDatabaseValueType> Types =
+		{
+			EDatabaseValueType::Boolean, EDatabaseValueType::Int32,		EDatabaseValueType::Int64, EDatabaseValueType::Double,
+			EDatabaseValueType::String,	 EDatabaseValueType::Timestamp, EDatabaseValueType::Date
+		};
+
+		return Types;
+	}
+
+	static const TCHAR* GetTypeName(const EDatabaseValueType Type)
+	{
+		switch (Type)
+		{
+		case EDatabaseValueType::Boolean:	return TEXT("Boolean");
+		case EDatabaseValueType::Int32:		return TEXT("Int32");
+		case EDatabaseValueType::Int64:		return TEXT("Int64");
+		case EDatabaseValueType::Double:	return TEXT("Double");
+		case EDatabaseValueType::String:	return TEXT("String");
+		case EDatabaseValueType::Timestamp: return TEXT("Timestamp");
+		case EDatabaseValueType::Date:		return TEXT("Date");
+		default:							return TEXT("Null");
+		}
+	}
+
+	/**
+	 * A result with a column of each type, as a query would return it.
+	*/
+	FQueryResult MakeResult() const
+	{
+		const TArray<EDatabaseValueType>& Types = GetValueTypes();
+
+		TArray<FString> Headers;
+		TArray<FColumnMetadata> Metadata;
+
+		for (int32 i = 0; i < Types.Num(); ++i)
+		{
+			Headers.Add(FString::Printf(TEXT("%sValue"), GetTypeName(Types[i])));
+			Metadata.AddDefaulted();
+		}
+
+		TArray64<TArray<FDatabaseValue>> Rows;
+		Rows.Reserve(RowCount);
+
+		for (int32 Row = 0; Row < RowCount; ++Row)
+		{
+			TArray<FDatabaseValue>& Values = Rows.AddDefaulted_GetRef();
+
+			for (const EDatabaseValueType Type : Types)
+			{
+				Values.Add(MakeValue(Type, Row));
+			}
+		}
+
+		return FQueryResult(MoveTemp(Headers), MoveTemp(Rows), MoveTemp(Metadata), 0);
+	}
+
+	void RunValueBenchmarks()
+	{
+		for (const EDatabaseValueType Type : { EDatabaseValueType::Int64, EDatabaseValueType::String, EDatabaseValueType::Timestamp })
+		{
+			TArray<FDatabaseValue> Values;
+			Values.Reserve(RowCount);
+
+			for (int32 i = 0; i < RowCount; ++i)
+			{
+				Values.Add(MakeValue(Type, i));
+			}
+
+			Measure(*FString::Printf(TEXT("Value.Copy.%s"), GetTypeName(Type)), RowCount, [&]()
+			{
+				TArray<FDatabaseValue> Copy = Values;
+
+				Consume(Copy.Last());
+			});
+		}
+	}
+
+	/**
+	 * The cost of storing decoded cells, then of boxing them back, per type.
+	*/
+	void RunColumnBenchmarks()
+	{
+		for (const EDatabaseValueType Type : GetValueTypes())
+		{
+			TArray<FDatabaseValue> Values;
+			Values.Reserve(RowCount);
+
+			for (int32 i = 0; i < RowCount; ++i)
+			{
+				Values.Add(MakeValue(Type, i));
+			}
+
+			FQueryResultColumn Column(Type);
+
+			Measure(*FString::Printf(TEXT("Column.Add.%s"), GetTypeName(Type)), RowCount, [&]()
+			{
+				Column.Reserve(RowCount);
+
+				for (const FDatabaseValue& Value : Values)
+				{
+					Column.AddValue(Value);
+				}
+			});
+
+			Measure(*FString::Printf(TEXT("Column.Get.%s"), GetTypeName(Type)), RowCount, [&]()
+			{
+				for (int64 Row = 0; Row < Column.Num(); ++Row)
+				{
+					Consume(Column.GetValue(Row));
+				}
+			});
+		}
+	}
+
+	void RunAccessorBenchmarks()
+	{
+		const FQueryResult Result = MakeResult();
+
+		const TArray<FString>& Columns = Result.GetColumns();
+
+		const int64 Operations = (int64)RowCount * Columns.Num();
+
+		Measure(TEXT("Result.GetByIndex"), Operations, [&]()
+		{
+			for (int64 Row = 0; Row < RowCount; ++Row)
+			{
+				for (int32 Column = 0; Column < Columns.Num(); ++Column)
+				{
+					Consume(Result.Get(Column, Row));
+				}
+			}
+		});
+
+		Measure(TEXT("Result.GetByName"), Operations, [&]()
+		{
+			for (int64 Row = 0; Row < RowCount; ++Row)
+			{
+				for (const FString& Column : Columns)
+				{
+					Consume(Result.Get(Column, Row));
+				}
+			}
+		});
+
+		TArray<FQueryColumnHandle> Handles;
+
+		for (const FString& Column : Columns)
+		{
+			Handles.Add(Result.GetColumnHandle(Column));
+		}
+
+		Measure(TEXT("Result.GetByHandle"), Operations, [&]()
+		{
+			for (int64 Row = 0; Row < RowCount; ++Row)
+			{
+				for (const FQueryColumnHandle& Handle : Handles)
+				{
+					Consume(Result.Get(Handle, Row));
+				}
+			}
+		});
+	}
+
+	/**
+	 * Calls the library through the Blueprint VM, as a graph does.
+	*/
+	void RunBlueprintBenchmarks()
+	{
+		const FQueryResult Result = MakeResult();
+
+		UDatabaseConnectorBlueprintLibrary* const Library = GetMutableDefault<UDatabaseConnectorBlueprintLibrary>();
+
+		UFunction* const ByIndex = Library->FindFunctionChecked(TEXT("GetByColumnIndex"));
+		UFunction* const ByName	 = Library->FindFunctionChecked(TEXT("GetByColumnName"));
+
+		const int64 Operations = (int64)RowCount * Result.GetColumns().Num();
+
+		{
+			FStructOnScope Parameters(ByIndex);
+
+			SetParameter(ByIndex, Parameters, TEXT("QueryResult"), Result);
+
+			Measure(TEXT("Blueprint.GetByColumnIndex"), Operations, [&]()
+			{
+				for (int64 Row = 0; Row < RowCount; ++Row)
+				{
+					SetParameter(ByIndex, Parameters, TEXT("RowIndex"), Row);
+
+					for (int32 Column = 0; Column < Result.GetColumns().Num(); ++Column)
+					{
+						SetParameter(ByIndex, Parameters, TEXT("ColumnIndex"), Column);
+
+						Library->ProcessEvent(ByIndex, Parameters.GetStructMemory());
+					}
+				}
+			});
+		}
+
+		{
+			FStructOnScope Parameters(ByName);
+
+			SetParameter(ByName, Parameters, TEXT("QueryResult"), Result);
+
+			Measure(TEXT("Blueprint.GetByColumnName"), Operations, [&]()
+			{
+				for (int64 Row = 0; Row < RowCount; ++Row)
+				{
+					SetParameter(ByName, Parameters, TEXT("RowIndex"), Row);
+
+					for (const FString& Column : Result.GetColumns())
+					{
+						SetParameter(ByName, Parameters, TEXT("ColumnName"), Column);
+
+						Library->ProcessEvent(ByName, Parameters.GetStructMemory());
+					}
+				}
+			});
+		}
+	}
+
+	template<typename T>
+	static void SetParameter(UFunction* const Function, FStructOnScope& Parameters, const TCHAR* const Name, const T& Value)
+	{
+		FProperty* const Property = Function->FindPropertyByName(Name);
+
+		check(Property && Property->GetSize() == sizeof(T));
+
+		Property->CopyCompleteValue(Property->ContainerPtrToValuePtr<void>(Parameters.GetStructMemory()), &Value);
+	}
+
+	void RunPoolBenchmarks(FConnectionPool& Pool, const FString& Url)
+	{
+		const int32 QueryCount = FMath::Max(RowCount / 10, 1);
+
+		Measure(TEXT("Pool.Throughput"), (int64)QueryCount * ConnectionCount, [&]()
+		{
+			ParallelFor(ConnectionCount, [&](int32)
+			{
+				for (int32 i = 0; i < QueryCount; ++i)
+				{
+					FConnectionHandle Handle(Pool);
+
+					if (Handle.IsValid())
+					{
+						EDatabaseError Error;
+
+						Handle.Get().Query(TEXT("SELECT 1"), Url, {}, Error);
+					}
+				}
+			});
+		});
+
+		const int32 ThreadCount = ConnectionCount * ContentionFactor;
+
+		Measure(TEXT("Pool.AcquireContention"), (int64)RowCount * ThreadCount, [&]()
+		{
+			ParallelFor(ThreadCount, [&](int32)
+			{
+				for (int32 i = 0; i < RowCount; ++i)
+				{
+					FConnectionHandle Handle(Pool);
+				}
+			});
+		});
+	}
+
+	/**
+	 * Reads a column of each type from a table filled by the benchmark.
+	*/
+	void RunDecodeBenchmarks(FConnectionPool& Pool, const FString& Url)
+	{
+		FConnectionHandle Handle(Pool);
+
+		if (!Handle.IsValid())
+		{
+			return;
+		}
+
+		FConnection& Connection = Handle.Get();
+
+		EDatabaseError Error;
+
+		// Fails if the table doesn't exist yet.
+		Connection.Query(TEXT("DROP TABLE DatabaseConnectorBenchmark"), Url, {}, Error);
+
+		Connection.Query(TEXT("CREATE TABLE DatabaseConnectorBenchmark (BooleanValue SMALLINT, Int32Value INTEGER, Int64Value BIGINT, ")
+			TEXT("DoubleValue DOUBLE PRECISION, StringValue VARCHAR(64), TimestampValue TIMESTAMP, DateValue DATE)"), Url, {}, Error);
+
+		if (Error != EDatabaseError::None)
+		{
+			Ar.Log(TEXT("Failed to create the benchmark table: decode benchmarks skipped."));
+			return;
+		}
+
+		const TArray<EDatabaseValueType>& Types = GetValueTypes();
+
+		TArray<FDatabaseBatch> Batches;
+
+		FDatabaseBatch& Insert = Batches.AddDefaulted_GetRef();
+
+		Insert.Query = TEXT("INSERT INTO DatabaseConnectorBenchmark VALUES (?, ?, ?, ?, ?, ?, ?)");
+		Insert.Rows.Reserve(RowCount);
+
+		for (int32 Row = 0; Row < RowCount; ++Row)
+		{
+			TArray<FDatabaseValue>& Values = Insert.Rows.AddDefaulted_GetRef();
+
+			for (const EDatabaseValueType Type : Types)
+			{
+				// Drivers without booleans store them as integers.
+				Values.Add(Type == EDatabaseValueType::Boolean ? FDatabaseValue((int32)(Row % 2)) : MakeValue(Type, Row));
+			}
+		}
+
+		Measure(TEXT("Odbc.InsertBatch"), RowCount, [&]()
+		{
+			Connection.ExecuteBatch(Batches, Url, Error);
+		});
+
+		for (const EDatabaseValueType Type : Types)
+		{
+			const FString Query = FString::Printf(TEXT("SELECT %sValue FROM DatabaseConnectorBenchmark"), GetTypeName(Type));
+
+			Measure(*FString::Printf(TEXT("Odbc.Decode.%s"), GetTypeName(Type)), RowCount, [&]()
+			{
+				const FQueryResult Result = Connection.Query(Query, Url, {}, Error);
+
+				Sink += Result.GetRowCount();
+			});
+		}
+
+		Connection.Query(TEXT("DROP TABLE DatabaseConnectorBenchmark"), Url, {}, Error);
+	}
+
+private:
+	FOutputDevice& Ar;
+
+	const int32 RowCount;
+
+	TArray<FResult> Results;
+
+	int64 Sink = 0;
+};
+
+static void RunDatabaseBenchmark(const TArray<FString>& Args, FOutputDevice& Ar)
+{
+	const FString Command = FString::Join(Args, TEXT(" "));
+
+	int32 RowCount = 10000;
+	FString Url;
+
+	FParse::Value(*Command, TEXT("Rows="), RowCount);
+	FParse::Value(*Command, TEXT("Url="),  Url, false);
+
+	FDatabaseBenchmark Benchmark(Ar, RowCount);
+
+	Benchmark.RunOffline();
+
+	if (!Url.IsEmpty())
+	{
+		Benchmark.RunOdbc(Url);
+	}
+	else
+	{
+		Ar.Log(TEXT("No Url= given: ODBC benchmarks skipped."));
+	}
+
+	Benchmark.Save();
+}
+
+static FAutoConsoleCommandWithArgsAndOutputDevice DatabaseBenchmarkCommand(
+	TEXT("Database.Benchmark"),
+	TEXT("Measures the plugin's hot paths and saves the results to Saved/DatabaseConnector/Benchmarks. ")
+	TEXT("Usage: Database.Benchmark [Rows=10000] [Url=\"<ODBC connection string>\"]"),
+	FConsoleCommandWithArgsAndOutputDeviceDelegate::CreateStatic(&RunDatabaseBenchmark));
+
+#endif // !UE_BUILD_SHIPPING
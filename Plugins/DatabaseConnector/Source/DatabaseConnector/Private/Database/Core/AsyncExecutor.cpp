@@ -0,0 +1,241 @@
+// Copyright Pandores Marketplace 2021. All Rights Reserved.
+
+#include "AsyncExecutor.h"
+
+#if WITH_DATABASE_ASYNC_EXECUTION
+
+#include "HAL/Runnable.h"
+#include "HAL/RunnableThread.h"
+#include "Misc/ScopeLock.h"
+#include "Windows/WindowsHWrapper.h"
+
+#include "Database/Core/DatabasePoolTasks.h"
+
+#include "DatabaseConnectorModule.h"
+
+class FAsyncQueryExecutor::FIoThread final : public FRunnable
+{
+private:
+	/**
+	 * The threads only wait, they don't need a large stack.
+	*/
+	static constexpr uint32 ThreadStackSize = 32768u;
+
+	struct FOperation
+	{
+		HANDLE		Event;
+		FCompletion Completion;
+
+		FQueuedThreadPool*		Pool;
+		EDatabaseQueryPriority	Priority;
+	};
+
+public:
+	FIoThread(const int32 Index)
+		: WakeEvent(::CreateEventW(nullptr, false, false, nullptr))
+		, OperationCount(0)
+		, bStopping(false)
+	{
+		Thread = FRunnableThread::Create(this, *FString::Printf(TEXT("DatabaseConnector_IO_%d"), Index), ThreadStackSize, EThreadPriority::TPri_AboveNormal);
+	}
+
+	~FIoThread()
+	{
+		Stop();
+
+		::CloseHandle(WakeEvent);
+	}
+
+	void Stop()
+	{
+		{
+			FScopeLock Lock(&Section);
+
+			bStopping = true;
+		}
+
+		::SetEvent(WakeEvent);
+
+		if (Thread)
+		{
+			Thread->WaitForCompletion();
+			delete Thread;
+
+			Thread = nullptr;
+		}
+	}
+
+	bool TryAdd(void* Event, FQueuedThreadPool* const Pool, const EDatabaseQueryPriority Priority, FCompletion& Completion)
+	{
+		{
+			FScopeLock Lock(&Section);
+
+			if (bStopping || OperationCount >= MaxOperationsPerThread)
+			{
+				return false;
+			}
+
+			++OperationCount;
+
+			Queued.Add({ (HANDLE)Event, MoveTemp(Completion), Pool, Priority });
+		}
+
+		::SetEvent(WakeEvent);
+
+		return true;
+	}
+
+	virtual uint32 Run() override
+	{
+		TArray<FOperation> Operations;
+		TArray<HANDLE> Handles;
+
+		// Operations are still completed when stopping so their connections get released.
+		while (!bStopping || Operations.Num() > 0 || HasQueuedOperations())
+		{
+			{
+				FScopeLock Lock(&Section);
+
+				for (FOperation& Operation : Queued)
+				{
+					Operations.Emplace(MoveTemp(Operation));
+				}
+
+				Queued.Reset();
+			}
+
+			Handles.Reset();
+			Handles.Add(WakeEvent);
+
+			for (const FOperation& Operation : Operations)
+			{
+				Handles.Add(Operation.Event);
+			}
+
+			const DWORD Signaled = ::WaitForMultipleObjects(Handles.Num(), Handles.GetData(), false, INFINITE);
+
+			if (Signaled == WAIT_FAILED)
+			{
+				UE_LOG(LogDatabaseConnector, Error, TEXT("Failed to wait for asynchronous statements. Error: %d."), ::GetLastError());
+
+				FPlatformProcess::Sleep(0.001f);
+				continue;
+			}
+
+			const int32 Index = (int32)(Signaled - WAIT_OBJECT_0) - 1;
+
+			if (Operations.IsValidIndex(Index))
+			{
+				Complete(Operations, Index);
+			}
+
+			// Only the first signaled event is returned: poll the others
+			// so the last operations don't starve behind the first ones.
+			for (int32 i = Operations.Num() - 1; i >= 0; --i)
+			{
+				if (::WaitForSingleObject(Operations[i].Event, 0) == WAIT_OBJECT_0)
+				{
+					Complete(Operations, i);
+				}
+			}
+		}
+
+		return 0;
+	}
+
+private:
+	void Complete(TArray<FOperation>& Operations, const int32 Index)
+	{
+		FOperation Operation = MoveTemp(Operations[Index]);
+
+		Operations.RemoveAtSwap(Index);
+
+		// Reading the results would hold the other statements of this thread.
+		// Once stopping, the pool's threads might be gone.
+		if (bStopping)
+		{
+			Operation.Completion();
+		}
+		else
+		{
+			NDatabasePoolThread::AsyncTask(Operation.Pool, Operation.Priority, MoveTemp(Operation.Completion));
+		}
+
+		FScopeLock Lock(&Section);
+
+		--OperationCount;
+	}
+
+	bool HasQueuedOperations()
+	{
+		FScopeLock Lock(&Section);
+
+		return Queued.Num() > 0;
+	}
+
+private:
+	const HANDLE WakeEvent;
+
+	FRunnableThread* Thread;
+
+	/**
+	 * Protects the queued operations and the count.
+	*/
+	FCriticalSection Section;
+
+	/**
+	 * Operations added since the thread last started waiting.
+	*/
+	TArray<FOperation> Queued;
+
+	/**
+	 * Queued and waited operations.
+	*/
+	int32 OperationCount;
+
+	TAtomic<bool> bStopping;
+};
+
+FAsyncQueryExecutor::FAsyncQueryExecutor(const int32 MaxOperations)
+	: NextThread(0)
+{
+	const int32 ThreadCount = FMath::Max(FMath::DivideAndRoundUp(MaxOperations, MaxOperationsPerThread), 1);
+
+	for (int32 i = 0; i < ThreadCount; ++i)
+	{
+		Threads.Emplace(MakeUnique<FIoThread>(i));
+	}
+}
+
+FAsyncQueryExecutor::~FAsyncQueryExecutor()
+{
+	Threads.Empty();
+}
+
+void FAsyncQueryExecutor::Wait(void* Event, FQueuedThreadPool* const Pool, const EDatabaseQueryPriority Priority, FCompletion&& Completion)
+{
+	const uint32 First = NextThread++;
+
+	for (int32 i = 0; i < Threads.Num(); ++i)
+	{
+		if (Threads[(First + i) % Threads.Num()]->TryAdd(Event, Pool, Priority, Completion))
+		{
+			return;
+		}
+	}
+
+	// Only when more statements run than the executor was sized for, or once stopped.
+	::WaitForSingleObject((HANDLE)Event, INFINITE);
+
+	Completion();
+}
+
+void FAsyncQueryExecutor::Stop()
+{
+	for (const TUniquePtr<FIoThread>& Thread : Threads)
+	{
+		Thread->Stop();
+	}
+}
+
+#endif // WITH_DATABASE_ASYNC_EXECUTION
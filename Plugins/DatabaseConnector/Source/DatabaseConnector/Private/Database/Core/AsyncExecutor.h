@@ -0,0 +1,62 @@
+// Copyright Pandores Marketplace 2021. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Database/QueryOptions.h"
+
+#if WITH_DATABASE_ASYNC_EXECUTION
+
+class FQueuedThreadPool;
+
+/**
+ * Waits for asynchronous statements to complete on a few I/O threads,
+ * so connections don't need a blocked thread each while the database works.
+*/
+class FAsyncQueryExecutor
+{
+public:
+	using FCompletion = TUniqueFunction<void()>;
+
+	/**
+	 * The number of statements a thread waits for. Windows waits for at most 64 events, one wakes the thread up.
+	*/
+	static constexpr int32 MaxOperationsPerThread = 63;
+
+private:
+	class FIoThread;
+
+public:
+	/**
+	 * @param MaxOperations The number of statements executed at once, usually the number of connections.
+	*/
+	explicit FAsyncQueryExecutor(const int32 MaxOperations);
+	~FAsyncQueryExecutor();
+
+	FAsyncQueryExecutor(const FAsyncQueryExecutor&) = delete;
+	FAsyncQueryExecutor& operator=(const FAsyncQueryExecutor&) = delete;
+
+	/**
+	 * Queues the completion on the thread pool once the event is signaled.
+	 * The I/O threads only wait: the results are fetched by the completion on the pool's threads.
+	 * If the threads already wait for as many statements as they can, or are stopped, waits on the calling thread.
+	 * @param Event		The Windows event signaled by the driver.
+	 * @param Pool		The threads the completion runs on.
+	 * @param Priority	The priority the completion is queued with.
+	*/
+	void Wait(void* Event, FQueuedThreadPool* const Pool, const EDatabaseQueryPriority Priority, FCompletion&& Completion);
+
+	/**
+	 * Waits for the statements being executed and stops the I/O threads.
+	 * Must be called before the thread pools the completions are queued on are destroyed.
+	 * Completions of statements that end meanwhile run on the I/O threads.
+	*/
+	void Stop();
+
+private:
+	TArray<TUniquePtr<FIoThread>> Threads;
+
+	TAtomic<uint32> NextThread;
+};
+
+#endif // WITH_DATABASE_ASYNC_EXECUTION
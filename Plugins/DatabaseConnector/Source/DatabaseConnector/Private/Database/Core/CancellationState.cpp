@@ -0,0 +1,144 @@
+// Copyright Pandores Marketplace 2021. All Rights Reserved.
+
+#include "CancellationState.h"
+#include "Misc/ScopeLock.h"
+
+#include "DatabaseConnectorModule.h"
+
+FDatabaseCancellationState::FDatabaseCancellationState()
+	: bHasStatement(false)
+	, bCancelled(false)
+	, bAbandoned(false)
+	, bDetached(false)
+	, CallerCount(0)
+	, bCallerCancelled(false)
+{
+}
+
+bool FDatabaseCancellationState::SetStatement(const nanodbc::statement& InStatement)
+{
+	FScopeLock Lock(&Section);
+
+	if (bCancelled)
+	{
+		return false;
+	}
+
+	Statement	  = InStatement;
+	bHasStatement = true;
+
+	return true;
+}
+
+void FDatabaseCancellationState::ClearStatement()
+{
+	FScopeLock Lock(&Section);
+
+	// Release our reference so the statement isn't kept alive by the token.
+	Statement	  = nanodbc::statement();
+	bHasStatement = false;
+}
+
+void FDatabaseCancellationState::Cancel()
+{
+	if (Execution)
+	{
+		bCancelled = true;
+
+		Detach(true);
+		return;
+	}
+
+	FScopeLock Lock(&Section);
+
+	bCancelled = true;
+
+	if (bHasStatement)
+	{
+		// ODBC allows cancelling a statement from another thread than the one executing it.
+		try
+		{
+			Statement.cancel();
+		}
+		catch (const nanodbc::database_error& Error)
+		{
+			UE_LOG(LogDatabaseConnector, Warning, TEXT("Failed to cancel statement. State: %s, Reason: %s"),
+				UTF8_TO_TCHAR(Error.state().c_str()), UTF8_TO_TCHAR(Error.what()));
+		}
+	}
+}
+
+void FDatabaseCancellationState::Abandon()
+{
+	bAbandoned = true;
+
+	if (Execution)
+	{
+		Detach(false);
+	}
+}
+
+bool FDatabaseCancellationState::IsCancelled() const
+{
+	return bCancelled;
+}
+
+bool FDatabaseCancellationState::ShouldDrop() const
+{
+	return bCancelled || bAbandoned;
+}
+
+bool FDatabaseCancellationState::Attach(FDatabaseCancellationState& InExecution)
+{
+	int32 Count = InExecution.CallerCount;
+
+	do
+	{
+		// The execution is being cancelled.
+		if (Count < 0)
+		{
+			return false;
+		}
+	}
+	while (!InExecution.CallerCount.CompareExchange(Count, Count + 1));
+
+	Execution = InExecution.AsShared();
+
+	return true;
+}
+
+void FDatabaseCancellationState::Detach(const bool bCancel)
+{
+	// A caller can be both abandoned and cancelled.
+	if (bDetached.Exchange(true))
+	{
+		return;
+	}
+
+	if (bCancel)
+	{
+		Execution->bCallerCancelled = true;
+	}
+
+	if (--Execution->CallerCount > 0)
+	{
+		return;
+	}
+
+	// Closed by the last caller only, unless a new one attached in the meantime.
+	int32 Expected = 0;
+
+	if (!Execution->CallerCount.CompareExchange(Expected, -1))
+	{
+		return;
+	}
+
+	if (Execution->bCallerCancelled)
+	{
+		Execution->Cancel();
+	}
+	else
+	{
+		Execution->Abandon();
+	}
+}
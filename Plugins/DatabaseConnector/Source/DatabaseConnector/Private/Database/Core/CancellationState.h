@@ -0,0 +1,96 @@
+// Copyright Pandores Marketplace 2021. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+#if PLATFORM_WINDOWS
+#	include "Windows/AllowWindowsPlatformTypes.h"
+#endif
+
+THIRD_PARTY_INCLUDES_START
+#	include <nanodbc/nanodbc.h>
+THIRD_PARTY_INCLUDES_END
+
+#if PLATFORM_WINDOWS
+#	include "Windows/HideWindowsPlatformTypes.h"
+#endif // PLATFORM_WINDOWS
+
+/**
+ * Shared between a cancellation token and the thread executing its query.
+ * Coalesced queries have a state per caller, attached to the state of their shared execution.
+*/
+struct FDatabaseCancellationState : public TSharedFromThis<FDatabaseCancellationState, ESPMode::ThreadSafe>
+{
+public:
+	FDatabaseCancellationState();
+
+	/**
+	 * Sets the statement being executed so it can be cancelled.
+	 * @return False if the query was cancelled and the statement must not be executed.
+	*/
+	bool SetStatement(const nanodbc::statement& Statement);
+
+	/**
+	 * Called once the statement completed. It can no more be cancelled.
+	*/
+	void ClearStatement();
+
+	void Cancel();
+
+	void Abandon();
+
+	bool IsCancelled() const;
+
+	/**
+	 * If the query must not be started.
+	*/
+	bool ShouldDrop() const;
+
+	/**
+	 * Makes this caller one of the callers of a coalesced execution.
+	 * Cancelling or abandoning the caller only detaches it,
+	 * the execution is cancelled or abandoned once all its callers are.
+	 * @return False if all the callers already left the execution.
+	*/
+	bool Attach(FDatabaseCancellationState& Execution);
+
+private:
+	/**
+	 * Removes this caller from its execution.
+	 * @param bCancel If the caller was cancelled rather than abandoned.
+	*/
+	void Detach(const bool bCancel);
+
+private:
+	/**
+	 * Protects the statement as it's cancelled from another thread.
+	*/
+	FCriticalSection Section;
+
+	nanodbc::statement Statement;
+	bool bHasStatement;
+
+	TAtomic<bool> bCancelled;
+	TAtomic<bool> bAbandoned;
+
+	/**
+	 * The execution this caller is attached to, if coalesced.
+	*/
+	TSharedPtr<FDatabaseCancellationState, ESPMode::ThreadSafe> Execution;
+
+	/**
+	 * If this caller left its execution.
+	*/
+	TAtomic<bool> bDetached;
+
+	/**
+	 * The callers still attached to this execution. -1 once they all left.
+	*/
+	TAtomic<int32> CallerCount;
+
+	/**
+	 * If one of the callers that left this execution was cancelled.
+	*/
+	TAtomic<bool> bCallerCancelled;
+};
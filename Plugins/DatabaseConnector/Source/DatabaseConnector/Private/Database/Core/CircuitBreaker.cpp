@@ -0,0 +1,106 @@
+// Copyright Pandores Marketplace 2021. All Rights Reserved.
+
+#include "CircuitBreaker.h"
+#include "Misc/ScopeLock.h"
+
+#include "DatabaseConnectorModule.h"
+
+FDatabaseCircuitBreaker::FDatabaseCircuitBreaker()
+	: FailureThreshold(0)
+	, ProbeInterval(0.)
+	, ConsecutiveFailures(0)
+	, bOpen(false)
+	, NextProbeTime(0.)
+{
+}
+
+void FDatabaseCircuitBreaker::Configure(const FDatabaseCircuitBreakerSettings& Settings)
+{
+	FailureThreshold = Settings.FailureThreshold;
+	ProbeInterval	 = Settings.ProbeInterval;
+}
+
+bool FDatabaseCircuitBreaker::Allow()
+{
+	if (!bOpen)
+	{
+		return true;
+	}
+
+	const double Now = FPlatformTime::Seconds();
+
+	FScopeLock Lock(&Section);
+
+	if (!bOpen)
+	{
+		return true;
+	}
+
+	if (Now < NextProbeTime)
+	{
+		return false;
+	}
+
+	// Only one probe per interval: if it never reports, the next interval sends another.
+	NextProbeTime = Now + ProbeInterval;
+
+	UE_LOG(LogDatabaseConnector, Log, TEXT("Probing the database."));
+
+	return true;
+}
+
+bool FDatabaseCircuitBreaker::IsOpen() const
+{
+	return bOpen;
+}
+
+void FDatabaseCircuitBreaker::OnSuccess()
+{
+	// Don't write the shared counter on every query.
+	if (ConsecutiveFailures.Load(EMemoryOrder::Relaxed) != 0)
+	{
+		ConsecutiveFailures = 0;
+	}
+
+	if (!bOpen)
+	{
+		return;
+	}
+
+	FScopeLock Lock(&Section);
+
+	if (bOpen)
+	{
+		bOpen = false;
+
+		UE_LOG(LogDatabaseConnector, Log, TEXT("The database answers again. Resuming queries."));
+	}
+}
+
+void FDatabaseCircuitBreaker::OnFailure()
+{
+	if (FailureThreshold <= 0)
+	{
+		return;
+	}
+
+	const int32 Failures = ++ConsecutiveFailures;
+
+	if (Failures < FailureThreshold && !bOpen)
+	{
+		return;
+	}
+
+	FScopeLock Lock(&Section);
+
+	// A failed probe waits for the next interval.
+	NextProbeTime = FPlatformTime::Seconds() + ProbeInterval;
+
+	if (!bOpen)
+	{
+		bOpen = true;
+
+		UE_LOG(LogDatabaseConnector, Warning, TEXT("The database failed %d times in a row. Queries fail with Unavailable until it answers again, probing every %.1fs."),
+			Failures, ProbeInterval);
+	}
+}
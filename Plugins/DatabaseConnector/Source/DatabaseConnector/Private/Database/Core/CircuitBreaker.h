@@ -0,0 +1,57 @@
+// Copyright Pandores Marketplace 2021. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Database/PoolSettings.h"
+
+/**
+ * Stops a pool from using its connections once the database failed too many times in a row.
+ * While open, a connection is let through every probe interval: the first success closes it again.
+ * Closed breakers are checked without lock.
+*/
+class FDatabaseCircuitBreaker
+{
+public:
+	FDatabaseCircuitBreaker();
+
+	FDatabaseCircuitBreaker(const FDatabaseCircuitBreaker&) = delete;
+	FDatabaseCircuitBreaker& operator=(const FDatabaseCircuitBreaker&) = delete;
+
+	/**
+	 * Must be called before the pool is used.
+	*/
+	void Configure(const FDatabaseCircuitBreakerSettings& Settings);
+
+	/**
+	 * If a connection can be used. Takes the probe if the breaker is open and it is time to probe.
+	*/
+	bool Allow();
+
+	bool IsOpen() const;
+
+	/**
+	 * The database answered.
+	*/
+	void OnSuccess();
+
+	/**
+	 * The database couldn't be reached, or the connection was lost.
+	*/
+	void OnFailure();
+
+private:
+	int32  FailureThreshold;
+	double ProbeInterval;
+
+	TAtomic<int32> ConsecutiveFailures;
+
+	TAtomic<bool> bOpen;
+
+	/**
+	 * Protects the transitions and the probe time.
+	*/
+	FCriticalSection Section;
+
+	double NextProbeTime;
+};
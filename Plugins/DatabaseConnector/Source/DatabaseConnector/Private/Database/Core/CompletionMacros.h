@@ -0,0 +1,22 @@
+// Copyright Pandores Marketplace 2021. All Rights Reserved.
+
+#pragma once
+
+#include "CompletionQueue.h"
+
+/**
+ * Moves a variable into a lambda capture.
+*/
+#define LAMBDA_MOVE_TEMP(Var) Var = MoveTemp(Var)
+
+/**
+ * Queues the code up to END_GAME_THREAD_COMPLETION() to run on the Game Thread, with the captures listed.
+ * @param Queue The pool's FDatabaseCompletionQueue.
+*/
+#define START_GAME_THREAD_COMPLETION(Queue, ...)				\
+	Queue->Enqueue([											\
+		__VA_ARGS__												\
+	]() mutable -> void											\
+	{
+
+#define END_GAME_THREAD_COMPLETION() })
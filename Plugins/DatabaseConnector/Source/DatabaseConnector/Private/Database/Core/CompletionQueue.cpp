@@ -0,0 +1,105 @@
+// Copyright Pandores Marketplace 2021. All Rights Reserved.
+
+#include "CompletionQueue.h"
+
+#include "Async/Async.h"
+#include "Misc/ScopeLock.h"
+
+#include "DatabaseConnectorModule.h"
+
+FDatabaseCompletionQueue::FDatabaseCompletionQueue()
+	: PendingCount(0)
+	, bDetached(false)
+{
+}
+
+void FDatabaseCompletionQueue::Enqueue(FCompletion&& Completion)
+{
+	Queue.Enqueue({ MoveTemp(Completion), FPlatformTime::Seconds() });
+
+	++PendingCount;
+
+	// The pool was destroyed while we were queuing.
+	if (bDetached)
+	{
+		Flush();
+	}
+}
+
+int32 FDatabaseCompletionQueue::Drain(const double Budget)
+{
+	check(IsInGameThread());
+
+	const double StartTime = FPlatformTime::Seconds();
+
+	int32  Count		= 0;
+	double TotalLatency = 0.;
+	double MaxLatency	= 0.;
+
+	FEntry Entry;
+
+	while (Queue.Dequeue(Entry))
+	{
+		--PendingCount;
+
+		const double Latency = FPlatformTime::Seconds() - Entry.QueuedTime;
+
+		TotalLatency += Latency;
+		MaxLatency	  = FMath::Max(MaxLatency, Latency);
+
+		Entry.Completion();
+		Entry.Completion.Reset();
+
+		++Count;
+
+		if (Budget > 0. && FPlatformTime::Seconds() - StartTime >= Budget)
+		{
+			break;
+		}
+	}
+
+	const double ElapsedTime = FPlatformTime::Seconds() - StartTime;
+
+	Stats.Pending			= PendingCount;
+	Stats.LastFrameCount	= Count;
+	Stats.LastFrameTime		= (float)(ElapsedTime * 1000.);
+	Stats.AverageLatency	= Count > 0 ? (float)(TotalLatency / Count * 1000.) : 0.f;
+	Stats.MaxLatency		= (float)(MaxLatency * 1000.);
+	Stats.TotalCount	   += Count;
+
+	if (Count > 0 && Stats.Pending > 0)
+	{
+		UE_LOG(LogDatabaseConnector, Verbose, TEXT("Called %d database callbacks in %.2f ms, %d left for the next frame."), 
+			Count, Stats.LastFrameTime, Stats.Pending);
+	}
+
+	return Count;
+}
+
+void FDatabaseCompletionQueue::Detach()
+{
+	bDetached = true;
+
+	Flush();
+}
+
+FDatabaseCompletionStats FDatabaseCompletionQueue::GetStats() const
+{
+	check(IsInGameThread());
+
+	return Stats;
+}
+
+void FDatabaseCompletionQueue::Flush()
+{
+	FScopeLock Lock(&FlushSection);
+
+	FEntry Entry;
+
+	while (Queue.Dequeue(Entry))
+	{
+		--PendingCount;
+
+		AsyncTask(ENamedThreads::GameThread, MoveTemp(Entry.Completion));
+	}
+}
@@ -0,0 +1,79 @@
+// Copyright Pandores Marketplace 2021. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Containers/Queue.h"
+#include "Database/PoolStats.h"
+
+/**
+ * The callbacks of a pool waiting to be called on the Game Thread.
+ * Filled from any thread and drained once per frame within a time budget,
+ * so bursts of completions are spread over several frames.
+*/
+class FDatabaseCompletionQueue
+{
+public:
+	using FCompletion = TUniqueFunction<void()>;
+
+public:
+	FDatabaseCompletionQueue();
+
+	FDatabaseCompletionQueue(const FDatabaseCompletionQueue&) = delete;
+	FDatabaseCompletionQueue& operator=(const FDatabaseCompletionQueue&) = delete;
+
+	/**
+	 * Queues a callback. Can be called from any thread.
+	*/
+	void Enqueue(FCompletion&& Completion);
+
+	/**
+	 * Calls the queued callbacks until the budget is spent, leaving the others to the next frame.
+	 * At least one is called so the queue always progresses. Must be called on the Game Thread.
+	 * @param Budget Seconds the callbacks can take. 0 for no limit.
+	 * @return The number of callbacks called.
+	*/
+	int32 Drain(const double Budget);
+
+	/**
+	 * Stops queuing: pending and later callbacks are posted to the Game Thread as tasks.
+	 * Called when the pool is destroyed as nothing drains the queue anymore.
+	*/
+	void Detach();
+
+	/**
+	 * Must be called on the Game Thread.
+	*/
+	FDatabaseCompletionStats GetStats() const;
+
+private:
+	/**
+	 * Posts the queued callbacks to the Game Thread as tasks.
+	*/
+	void Flush();
+
+private:
+	struct FEntry
+	{
+		FCompletion Completion;
+
+		/* Platform seconds when the callback was queued. */
+		double QueuedTime;
+	};
+
+	TQueue<FEntry, EQueueMode::Mpsc> Queue;
+
+	TAtomic<int32> PendingCount;
+
+	TAtomic<bool> bDetached;
+
+	/**
+	 * Protects the consumer side once detached as any thread can flush.
+	*/
+	FCriticalSection FlushSection;
+
+	/**
+	 * Only accessed on Game Thread.
+	*/
+	FDatabaseCompletionStats Stats;
+};
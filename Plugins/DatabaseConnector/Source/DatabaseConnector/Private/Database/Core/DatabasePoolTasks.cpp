@@ -15,8 +15,9 @@ THIRD_PARTY_INCLUDES_END
 #endif // PLATFORM_WINDOWS
 
 #include "Async/Async.h"
+#include "HAL/Event.h"
+#include "Runtime/Launch/Resources/Version.h"
 
-#include "Database/Core/DatabaseValueInternal.h"
 #include "DatabaseConnectorModule.h"
 
 class FDatabasePoolWorkBase : public IQueuedWork
@@ -39,9 +40,105 @@ protected:
 	TUniqueFunction<void()> Function;
 };
 
+/**
+ * Shared by the threads running the indices of a ParallelFor().
+ * Threads starting once all the indices are taken leave without calling the function, that might be gone.
+*/
+struct FDatabaseParallelForState
+{
+	FDatabaseParallelForState(const int32 InNum, TFunctionRef<void(int32)> InFunction)
+		: Function(InFunction)
+		, Num(InNum)
+		, NextIndex(0)
+		, CompletedCount(0)
+		, Completed(FPlatformProcess::GetSynchEventFromPool(true))
+	{
+	}
+
+	~FDatabaseParallelForState()
+	{
+		FPlatformProcess::ReturnSynchEventToPool(Completed);
+	}
+
+	/**
+	 * Runs the next index not taken yet.
+	 * @return False if all the indices were taken.
+	*/
+	bool RunNext()
+	{
+		const int32 Index = NextIndex++;
+
+		if (Index >= Num)
+		{
+			return false;
+		}
+
+		Function(Index);
+
+		if (++CompletedCount == Num)
+		{
+			Completed->Trigger();
+		}
+
+		return true;
+	}
+
+	TFunctionRef<void(int32)> Function;
+
+	const int32 Num;
+
+	TAtomic<int32> NextIndex;
+	TAtomic<int32> CompletedCount;
+
+	FEvent* const Completed;
+};
+
 void NDatabasePoolThread::AsyncTask(FQueuedThreadPool* const Pool, TUniqueFunction<void()> Function)
 {
 	Pool->AddQueuedWork(new FDatabasePoolWorkBase(MoveTemp(Function)));
 }
 
+void NDatabasePoolThread::AsyncTask(FQueuedThreadPool* const Pool, const EDatabaseQueryPriority Priority, TUniqueFunction<void()> Function)
+{
+#if ENGINE_MAJOR_VERSION > 4
+	EQueuedWorkPriority WorkPriority;
+
+	switch (Priority)
+	{
+	case EDatabaseQueryPriority::Critical:		WorkPriority = EQueuedWorkPriority::Highest;	break;
+	case EDatabaseQueryPriority::Background:	WorkPriority = EQueuedWorkPriority::Low;		break;
+	default:									WorkPriority = EQueuedWorkPriority::Normal;
+	}
+
+	Pool->AddQueuedWork(new FDatabasePoolWorkBase(MoveTemp(Function)), WorkPriority);
+#else
+	// Work is executed in order on older engines.
+	Pool->AddQueuedWork(new FDatabasePoolWorkBase(MoveTemp(Function)));
+#endif
+}
 
+void NDatabasePoolThread::ParallelFor(FQueuedThreadPool* const Pool, const EDatabaseQueryPriority Priority, const int32 Num, TFunctionRef<void(int32)> Function)
+{
+	if (Num <= 0)
+	{
+		return;
+	}
+
+	TSharedRef<FDatabaseParallelForState, ESPMode::ThreadSafe> State = MakeShared<FDatabaseParallelForState, ESPMode::ThreadSafe>(Num, Function);
+
+	for (int32 i = 1; i < Num; ++i)
+	{
+		AsyncTask(Pool, Priority, [State]() -> void
+		{
+			while (State->RunNext())
+			{
+			}
+		});
+	}
+
+	while (State->RunNext())
+	{
+	}
+
+	State->Completed->Wait();
+}
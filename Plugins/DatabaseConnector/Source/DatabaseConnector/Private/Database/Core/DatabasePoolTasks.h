@@ -5,6 +5,7 @@
 #include "CoreMinimal.h"
 #include "Database/Value.h"
 #include "Database/Errors.h"
+#include "Database/QueryOptions.h"
 #include "Database/Core/NanoDefinitions.h"
 #include "Database/Core/ThreadPool.h"
 #include "Misc/IQueuedWork.h"
@@ -12,4 +13,16 @@
 namespace NDatabasePoolThread
 {
 	void AsyncTask(FQueuedThreadPool* const Pool, TUniqueFunction<void()> Function);
+
+	/**
+	 * Queues the function ahead of the work of lower priorities.
+	*/
+	void AsyncTask(FQueuedThreadPool* const Pool, const EDatabaseQueryPriority Priority, TUniqueFunction<void()> Function);
+
+	/**
+	 * Calls the function for each index on the pool's threads, the calling thread included, and waits for all of them.
+	 * Unlike ParallelFor(), functions waiting for the database don't hold the task graph's workers.
+	 * The calling thread runs the indices no other thread took, so it never waits for busy threads.
+	*/
+	void ParallelFor(FQueuedThreadPool* const Pool, const EDatabaseQueryPriority Priority, const int32 Num, TFunctionRef<void(int32)> Function);
 };
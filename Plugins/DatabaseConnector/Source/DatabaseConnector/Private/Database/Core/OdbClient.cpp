@@ -4,19 +4,61 @@
 #include "Misc/ScopeLock.h"
 #include "Database/Core/SqlTypes.h"
 #include "Database/Core/SqlErrors.h"
+#include "Database/Core/QueryResultInternal.h"
+#include "Database/Core/CancellationState.h"
+#include "Database/Core/QueryKey.h"
+#include "Database/Core/DatabasePoolTasks.h"
+#include "Misc/ScopeExit.h"
+#include "Hash/CityHash.h"
 
 #include "DatabaseConnectorModule.h"
 
-#include <forward_list>
+#if WITH_DATABASE_ASYNC_EXECUTION
+#	include "Windows/WindowsHWrapper.h"
 
-#define DECLARE_CACHE(type) std::forward_list<TUniquePtr<type>> Cache_ ## type;
-#define CACHE_DATA(type, value, ...) do {					\
-	TUniquePtr<type> Cached = MakeUnique<type>(value);		\
-	Statement.bind(i, Cached.Get() __VA_ARGS__);			\
-	Cache_ ## type .emplace_front(MoveTemp(Cached));		\
-	} while(0)
+// Defined by sqlext.h since ODBC 3.8.
+#	ifndef SQL_ASYNC_NOTIFICATION
+#		define SQL_ASYNC_NOTIFICATION			10025
+#		define SQL_ASYNC_NOTIFICATION_CAPABLE	0x00000001L
+#	endif
+#endif
+
+// ODBC functions called on the native handles for what nanodbc doesn't expose.
+// Declared by sql.h, that isn't shipped with nanodbc, unless a file of the same unity build included it.
+#ifndef SQL_CLOSE
+#	if PLATFORM_WINDOWS
+#		define DATABASE_SQL_API __stdcall
+#	else
+#		define DATABASE_SQL_API
+#	endif
+
+// Same signature as sql.h so both declarations can be seen together.
+extern "C" int16 DATABASE_SQL_API SQLFreeStmt(void* StatementHandle, uint16 Option);
+
+#	undef DATABASE_SQL_API
+#endif
+
+namespace NOdbcApi
+{
+#ifdef SQL_CLOSE
+	static constexpr uint16 CloseCursor = SQL_CLOSE;
+#else
+	static constexpr uint16 CloseCursor = 0;
+#endif
+}
 
-static constexpr int32 ExecuteQueryConnectionLostRetryCount = 2;
+/**
+ * Seconds a health check waits for the database before the connection is considered lost.
+*/
+static constexpr int32 HealthCheckTimeout = 5;
+
+/**
+ * Converts a timeout to the whole seconds ODBC expects, rounding up so short timeouts aren't disabled.
+*/
+static long GetStatementTimeout(const float Timeout)
+{
+	return Timeout > 0.f ? (long)FMath::CeilToInt(Timeout) : 0;
+}
 
 static nanodbc::timestamp Convert(const FDatabaseTimestamp & Timestamp)
 {
@@ -71,13 +113,39 @@ static FDatabaseDate Convert(const nanodbc::date & RawDate)
 	return Date;
 }
 
-static FDatabaseValue Convert(const nanodbc::result& QueryResult, int32 Index)
+/**
+ * ODBC wide characters are UTF-16 on all our platforms, as TCHAR is.
+ * Wide strings are copied as is, without transcoding.
+*/
+static_assert(sizeof(nanodbc::wide_char_t) == sizeof(TCHAR), "ODBC wide characters and TCHAR must have the same encoding.");
+
+static nanodbc::wide_string ToWideString(const FString& String)
 {
-	if (QueryResult.is_null(Index))
+	return nanodbc::wide_string((const nanodbc::wide_char_t*)*String, (size_t)String.Len());
+}
+
+/**
+ * Checks if a column holds wide characters, which nanodbc fetches as SQLWCHAR.
+*/
+static bool IsWideCharacterColumn(const nanodbc::result& QueryResult, int32 Index)
+{
+	switch (QueryResult.column_datatype(Index))
 	{
-		return FDatabaseValue::Null();
+	case SQL_WCHAR:
+	case SQL_WVARCHAR:
+	case SQL_WLONGVARCHAR:
+		return true;
 	}
 
+	return false;
+}
+
+/**
+ * Gets the type a SQL column is exposed as.
+ * Unsupported types are exposed as NULL.
+*/
+static EDatabaseValueType GetColumnValueType(const nanodbc::result& QueryResult, int32 Index)
+{
 	const int32 Type = QueryResult.column_datatype(Index);
 	switch (Type)
 	{
@@ -88,33 +156,30 @@ static FDatabaseValue Convert(const nanodbc::result& QueryResult, int32 Index)
 	case SQL_WVARCHAR:
 	case SQL_WLONGVARCHAR:
 	case SQL_LONGVARCHAR:
-		return UTF8_TO_TCHAR(QueryResult.get<std::string>(Index, "").c_str());
+		return EDatabaseValueType::String;
 
 	case SQL_FLOAT:
-		return(QueryResult.get<float>(Index, 0.f));
-		break;
-
 	case SQL_DOUBLE:
 	case SQL_NUMERIC:
 	case SQL_DECIMAL:
 	case SQL_REAL:
-		return(QueryResult.get<double>(Index, 0.));
+		return EDatabaseValueType::Double;
 
 	case SQL_INTEGER:
 	case SQL_BIGINT:
-		return(QueryResult.get<int64>(Index, 0));
+		return EDatabaseValueType::Int64;
 
 	case SQL_SMALLINT:
 	case SQL_TINYINT:
 	case SQL_TYPE_TINYINT:
-		return(QueryResult.get<int32>(Index, 0));
+		return EDatabaseValueType::Int32;
 
 	case SQL_DATETIME:
-		return Convert(QueryResult.get<nanodbc::date>(Index, nanodbc::date()));
+		return EDatabaseValueType::Date;
 
 	case SQL_TIMESTAMP:
 	case SQL_TYPE_TIMESTAMP:
-		return Convert(QueryResult.get<nanodbc::timestamp>(Index, nanodbc::timestamp()));
+		return EDatabaseValueType::Timestamp;
 
 	default:
 	{
@@ -130,317 +195,2290 @@ static FDatabaseValue Convert(const nanodbc::result& QueryResult, int32 Index)
 	}
 
 	case SQL_UNKNOWN_TYPE:
-		return FDatabaseValue::Null();
+		return EDatabaseValueType::Null;
 	}
 
-	return FDatabaseValue::Null();
+	return EDatabaseValueType::Null;
 }
 
-static nanodbc::result ExecuteStatementWithParameters(nanodbc::statement& Statement, const TArray<FDatabaseValue>& Parameters)
+/**
+ * Stores the repeated strings of a column once: cells with the same text share their range of the character arena.
+ * Gives up on columns with too many distinct values, where lookups would cost more than they save.
+*/
+class FStringDeduplicator
 {
-	using StdString		= std::string;
-	using NanoTimestamp = nanodbc::timestamp;
-	using NanoDate		= nanodbc::date;
+public:
+	/**
+	 * The number of distinct values past which a column isn't deduplicated anymore.
+	*/
+	static constexpr int32 MaxDistinctValues = 1024;
+
+public:
+	/**
+	 * Forgets the strings seen so far, as they point to the arena of the previous chunk.
+	*/
+	void Reset(const bool bEnable)
+	{
+		bEnabled = bEnable;
+		Spans.Reset();
+	}
 
-	// The parameters must outlive the query.
-	// We store them with only one copy in unique pointers inside lists
-	// so they get released only after the query.
-	DECLARE_CACHE(bool);
-	DECLARE_CACHE(int32);
-	DECLARE_CACHE(int64);
-	DECLARE_CACHE(double);
-	DECLARE_CACHE(StdString);
-	DECLARE_CACHE(NanoTimestamp);
-	DECLARE_CACHE(NanoDate);
+	FORCEINLINE bool IsEnabled() const { return bEnabled; }
 
-	for (int32 i = 0; i < Parameters.Num(); ++i)
+	void Add(FQueryResultColumn& Column, const TCHAR* const Data, const int32 Length)
 	{
-		const FDatabaseValue& Value = Parameters[i];
-		switch (Value.GetType())
+		if (!bEnabled)
 		{
-		case EDatabaseValueType::String:	CACHE_DATA(StdString, TCHAR_TO_UTF8(*Value.ToString()), ->c_str()); break;
-		case EDatabaseValueType::Timestamp: CACHE_DATA(NanoTimestamp, Convert(Value.ToTimestamp()));	break;
-		case EDatabaseValueType::Date:		CACHE_DATA(NanoDate,      Convert(Value.ToDate()));			break;
-		case EDatabaseValueType::Uint8:		CACHE_DATA(int32,  Value);		break; // Use int32 cache as nanodbc doesn't support unsigned char.
-		case EDatabaseValueType::Int32:		CACHE_DATA(int32,  Value);		break;
-		case EDatabaseValueType::Int64:		CACHE_DATA(int64,  Value);		break;
-		case EDatabaseValueType::Double:	CACHE_DATA(double, Value);		break;
-		case EDatabaseValueType::Boolean:	CACHE_DATA(int32,  Value);		break; // Use int32 cache as nanodbc doesn't support bool.
-		case EDatabaseValueType::Null: 		Statement.bind_null(i);			break;
-		default:
-			UE_LOG(LogDatabaseConnector, Error, TEXT("Unhandled type %d. Using NULL instead."), (int32)Value.GetType());
-			Statement.bind_null(i);
+			Column.AddString(Data, Length);
+			return;
 		}
-	}
 
-	return nanodbc::execute(Statement);
-}
+		const uint32 Hash = CityHash32((const char*)Data, Length * sizeof(TCHAR));
 
-static FQueryResult GetQueryResult(nanodbc::result& QueryResult, EDatabaseError& OutError)
-{
-	TArray<FString>						Headers;
-	TArray<FColumnMetadata>				Metadata;
-	TArray64<TArray<FDatabaseValue>>	Body;
+		for (auto It = Spans.CreateConstKeyIterator(Hash); It; ++It)
+		{
+			const FQueryStringSpan& Span = It.Value();
 
-	const int32 ColumnCount = (int32)QueryResult.columns();
-	const int64 AffectedRowsCount = QueryResult.affected_rows();
+			if (Span.Length == Length && FMemory::Memcmp(Column.Characters.GetData() + Span.Offset, Data, Length * sizeof(TCHAR)) == 0)
+			{
+				Column.AddStringSpan(Span);
+				return;
+			}
+		}
 
-	Headers .Reserve(ColumnCount);
-	Metadata.Reserve(ColumnCount);
+		if (Spans.Num() < MaxDistinctValues)
+		{
+			Spans.Add(Hash, { Column.Characters.Num(), Length });
+		}
+		else
+		{
+			bEnabled = false;
+			Spans.Empty();
+		}
 
-	if (QueryResult.affected_rows() > 0)
-	{
-		Body.Reserve(QueryResult.affected_rows());
+		Column.AddString(Data, Length);
 	}
 
-	for (int32 i = 0; i < ColumnCount; ++i)
+private:
+	TMultiMap<uint32, FQueryStringSpan> Spans;
+
+	bool bEnabled = false;
+};
+
+/**
+ * What a column reuses across its cells to avoid temporary strings.
+*/
+struct FColumnScratch
+{
+	std::string				Narrow;
+	nanodbc::wide_string	Wide;
+	TArray<TCHAR>			Widened;
+
+	FStringDeduplicator Deduplicator;
+};
+
+/**
+ * Reads a cell of the current row and appends it to its column.
+ * @param QueryResult	The result positioned on the row to read.
+ * @param Index			The column of the cell.
+ * @param Column		The column to append to.
+ * @param Scratch		The buffers of the column.
+*/
+using FColumnDecoder = void(*)(const nanodbc::result& QueryResult, const short Index, FQueryResultColumn& Column, FColumnScratch& Scratch);
+
+static void DecodeNull(const nanodbc::result&, const short, FQueryResultColumn& Column, FColumnScratch&)
+{
+	Column.AddNull();
+}
+
+static bool IsAscii(const char* const Data, const int32 Length)
+{
+	for (int32 i = 0; i < Length; ++i)
 	{
-		Headers.Add(UTF8_TO_TCHAR(QueryResult.column_name(i).c_str()));
+		if ((uint8)Data[i] >= 0x80)
+		{
+			return false;
+		}
+	}
 
-		FColumnMetadata& Meta = Metadata.Emplace_GetRef();
+	return true;
+}
 
-		Meta.DecimalDigits	= QueryResult.column_decimal_digits(i);
-		Meta.DataTypeName	= UTF8_TO_TCHAR(QueryResult.column_datatype_name(i).c_str());
-		Meta.Size			= QueryResult.column_size(i);
+/**
+ * Reads a narrow string, expected to be UTF-8.
+*/
+static void DecodeString(const nanodbc::result& QueryResult, const short Index, FQueryResultColumn& Column, FColumnScratch& Scratch)
+{
+	if (QueryResult.is_null(Index))
+	{
+		Column.AddNull();
+		return;
 	}
 
-	try
+	QueryResult.get_ref<std::string>(Index, Scratch.Narrow);
+
+	const char* const Data	 = Scratch.Narrow.data();
+	const int32		  Length = (int32)Scratch.Narrow.size();
+
+	// Most text is ASCII: it is widened without decoding nor temporary allocation.
+	if (IsAscii(Data, Length))
 	{
-		for (int32 i = 0; QueryResult.next(); ++i)
+		TCHAR* Widened;
+
+		if (Scratch.Deduplicator.IsEnabled())
+		{
+			Scratch.Widened.SetNumUninitialized(Length, false);
+			Widened = Scratch.Widened.GetData();
+		}
+		else
 		{
-			TArray<FDatabaseValue>& Row = Body.Emplace_GetRef();
+			Widened = Column.AddStringUninitialized(Length);
+		}
 
-			Row.Reserve(ColumnCount);
+		for (int32 i = 0; i < Length; ++i)
+		{
+			Widened[i] = (TCHAR)Data[i];
+		}
 
-			for (int32 j = 0; j < ColumnCount; ++j)
-			{
-				Row.Add(Convert(QueryResult, j));
-			}
+		if (Scratch.Deduplicator.IsEnabled())
+		{
+			Scratch.Deduplicator.Add(Column, Widened, Length);
 		}
+
+		return;
 	}
-	catch (const nanodbc::database_error& Error)
-	{
-		UE_LOG(LogDatabaseConnector, Error, TEXT("Failed to fetch results. Code: %d. Reason: %s"), Error.native(), UTF8_TO_TCHAR(Error.what()));
 
-		//UE_LOG(LogTemp, Error, TEXT("Native error: %d, State: %s"), Error.native(), UTF8_TO_TCHAR(Error.state().c_str()));
+	const FUTF8ToTCHAR Converted(Data, Length);
+	Scratch.Deduplicator.Add(Column, Converted.Get(), Converted.Length());
+}
 
-		OutError = NSqlErrors::ConvertState(Error.state());;
-	}
-	catch (const nanodbc::index_range_error& Exception)
+/**
+ * Reads a wide string, already in the encoding of TCHAR.
+*/
+static void DecodeWideString(const nanodbc::result& QueryResult, const short Index, FQueryResultColumn& Column, FColumnScratch& Scratch)
+{
+	if (QueryResult.is_null(Index))
 	{
-		UE_LOG(LogDatabaseConnector, Error, TEXT("Failed to fetch results because of index error. Reason: %s"), UTF8_TO_TCHAR(Exception.what()));
+		Column.AddNull();
+		return;
 	}
 
-	return FQueryResult(MoveTemp(Headers), MoveTemp(Body), MoveTemp(Metadata), AffectedRowsCount);
+	QueryResult.get_ref<nanodbc::wide_string>(Index, Scratch.Wide);
+
+	Scratch.Deduplicator.Add(Column, (const TCHAR*)Scratch.Wide.data(), (int32)Scratch.Wide.size());
 }
 
-//////////////////////////////////////////////////////////////
-// FConnection
+static void DecodeDouble(const nanodbc::result& QueryResult, const short Index, FQueryResultColumn& Column, FColumnScratch&)
+{
+	double Value = 0.;
+
+	if (QueryResult.is_null(Index))
+	{
+		Column.AddNull();
+		return;
+	}
+
+	QueryResult.get_ref<double>(Index, Value);
+	Column.AddDouble(Value);
+}
 
-FConnection::FConnection(const FString& Url)
-	: Connection(TCHAR_TO_UTF8(*Url))
-	, bIsAvailable(true)
+static void DecodeInteger(const nanodbc::result& QueryResult, const short Index, FQueryResultColumn& Column, FColumnScratch&)
 {
+	int64 Value = 0;
+
+	if (QueryResult.is_null(Index))
+	{
+		Column.AddNull();
+		return;
+	}
+
+	QueryResult.get_ref<int64>(Index, Value);
+	Column.AddInteger(Value);
 }
 
-bool FConnection::TryAcquire()
+static void DecodeDate(const nanodbc::result& QueryResult, const short Index, FQueryResultColumn& Column, FColumnScratch&)
 {
-	bool bExpected = true;
-	return bIsAvailable.CompareExchange(bExpected, false);
+	nanodbc::date Value;
+
+	if (QueryResult.is_null(Index))
+	{
+		Column.AddNull();
+		return;
+	}
+
+	QueryResult.get_ref<nanodbc::date>(Index, Value);
+	Column.AddDate(Convert(Value));
 }
 
-void FConnection::Lock()
+static void DecodeTimestamp(const nanodbc::result& QueryResult, const short Index, FQueryResultColumn& Column, FColumnScratch&)
 {
-	const bool bIsConnectionAvailable = bIsAvailable.Exchange(false);
-	
-	check(bIsConnectionAvailable);
+	nanodbc::timestamp Value;
+
+	if (QueryResult.is_null(Index))
+	{
+		Column.AddNull();
+		return;
+	}
+
+	QueryResult.get_ref<nanodbc::timestamp>(Index, Value);
+	Column.AddTimestamp(Convert(Value));
 }
 
-void FConnection::Unlock()
+/**
+ * Resolves once per column how its cells are read.
+*/
+static FColumnDecoder GetColumnDecoder(const FQueryResultColumn& Column)
 {
-	const bool bWasConnectionLocked = !bIsAvailable.Exchange(true);
+	switch (Column.Storage)
+	{
+	case EQueryColumnStorage::String:		return &DecodeString;
+	case EQueryColumnStorage::Double:		return &DecodeDouble;
+	case EQueryColumnStorage::Integer:		return &DecodeInteger;
+	case EQueryColumnStorage::Date:			return &DecodeDate;
+	case EQueryColumnStorage::Timestamp:	return &DecodeTimestamp;
+	}
 
-	check(bWasConnectionLocked);
+	return &DecodeNull;
 }
 
-bool FConnection::Connect(const FString& Dsn, const int32 Timeout)
+/**
+ * Picks how many rows are fetched per round trip for the next execution of a statement.
+ * Statements are first executed row by row until we know all their columns can be bound,
+ * the rowset then grows with the size of the previous result, up to the pool's limit.
+ * @param Prepared		The cached statement, or nullptr if it isn't cached.
+ * @param Parameters	The parameters bound to this execution.
+ * @param MaxRowsetSize	The largest rowset allowed.
+ * @return The rowset size.
+*/
+static long GetRowsetSize(const FPreparedStatement* const Prepared, const TArray<FDatabaseValue>& Parameters, const int32 MaxRowsetSize)
 {
-	try
+	// nanodbc uses the rowset size as the parameter set size as well, while each
+	// parameter is bound to a single value: the driver would read past the values.
+	if (!Prepared || !Prepared->bSupportsRowsets || MaxRowsetSize <= 1 || Parameters.Num() > 0)
 	{
-		Connection.connect(TCHAR_TO_UTF8(*Dsn), Timeout);
+		return 1;
 	}
-	catch (const nanodbc::database_error& DatabaseError)
+
+	const uint32 ExpectedRows = (uint32)FMath::Clamp<int64>(Prepared->LastRowCount, 1, MaxRowsetSize);
+
+	return FMath::Min<long>(FMath::RoundUpToPowerOfTwo(ExpectedRows), MaxRowsetSize);
+}
+
+/**
+ * Checks if nanodbc bound all the columns of a result to buffers.
+ * Unbound columns are read with SQLGetData, which most drivers don't support within a rowset.
+*/
+static bool AreAllColumnsBound(const nanodbc::result& QueryResult)
+{
+	const short ColumnCount = QueryResult.columns();
+
+	for (short i = 0; i < ColumnCount; ++i)
 	{
-		UE_LOG(LogDatabaseConnector, Error, TEXT("Failed to connect. Code: %d. Reason: %s"),
-			DatabaseError.native(), UTF8_TO_TCHAR(DatabaseError.what()));
-		return false;
+		if (!QueryResult.is_bound(i))
+		{
+			return false;
+		}
 	}
 
 	return true;
 }
 
-FQueryResult FConnection::Query(const FString& Sql, const FString& Dsn, const TArray<FDatabaseValue>& Parameters, EDatabaseError& OutError, int32 RecursiveCount)
+using WideString = nanodbc::wide_string;
+
+#if ENGINE_MAJOR_VERSION > 4
+using FUtf8Char = UTF8CHAR;
+#else
+using FUtf8Char = ANSICHAR;
+#endif
+
+//////////////////////////////////////////////////////////////
+// FParameterArena
+
+int32 FParameterArena::GetBoundSize(const FDatabaseValue& Value, const bool bWideStrings)
 {
-	OutError = EDatabaseError::None;
-	
-	nanodbc::result QueryResult;
+	int32 Size = 0;
 
+	switch (Value.GetType())
 	{
-		std::string Utf8Query = TCHAR_TO_UTF8(*Sql);
+	case EDatabaseValueType::String:
+		Size = bWideStrings
+			? (Value.String.Len() + 1) * sizeof(nanodbc::wide_char_t)
+			: FTCHARToUTF8_Convert::ConvertedLength(*Value.String, Value.String.Len()) + 1;
+		break;
+	case EDatabaseValueType::Timestamp: Size = sizeof(nanodbc::timestamp);	break;
+	case EDatabaseValueType::Date:		Size = sizeof(nanodbc::date);		break;
+	case EDatabaseValueType::Uint8:		Size = sizeof(int32);				break;
+	case EDatabaseValueType::Int32:		Size = sizeof(int32);				break;
+	case EDatabaseValueType::Int64:		Size = sizeof(int64);				break;
+	case EDatabaseValueType::Double:	Size = sizeof(double);				break;
+	case EDatabaseValueType::Boolean:	Size = sizeof(int32);				break;
+	default:							Size = 0;							break;
+	}
 
-		try
-		{
-			nanodbc::statement Statement(Connection);
+	return Align(Size, Alignment);
+}
 
-			nanodbc::prepare(Statement, Utf8Query);
+uint8* FParameterArena::Allocate(const int32 Size)
+{
+	const int32 Offset = Buffer.Num();
 
-			QueryResult = ExecuteStatementWithParameters(Statement, Parameters);
-		}
-		catch (const nanodbc::database_error& Error)
-		{
-			UE_LOG(LogDatabaseConnector, Error, TEXT("Failed to query database. State: %s, Reason: %s"), 
-				UTF8_TO_TCHAR(Error.state().c_str()), UTF8_TO_TCHAR(Error.what()));
+	// Growing the buffer would move the values already bound.
+	check(Offset + Size <= Buffer.Max());
 
-			OutError = NSqlErrors::ConvertState(Error.state());;
-		}
+	Buffer.AddUninitialized(Size);
+
+	return Buffer.GetData() + Offset;
+}
+
+void FParameterArena::Bind(nanodbc::statement& Statement, const TArray<FDatabaseValue>& Parameters, const bool bWideStrings)
+{
+	// Cached statements keep the bindings of their previous execution,
+	// which point to values of the buffer about to be overwritten.
+	Statement.reset_parameters();
+
+	int32 Size = 0;
+
+	for (const FDatabaseValue& Value : Parameters)
+	{
+		Size += GetBoundSize(Value, bWideStrings);
 	}
 
-	if (OutError != EDatabaseError::None)
+	// Only reallocated when too small, or to release the memory a large query left behind.
+	if (Buffer.Max() < Size || (Buffer.Max() > MaxRetainedSize && Size <= MaxRetainedSize))
 	{
-		// We try to reconnect if the connection was closed.
-		if (OutError == EDatabaseError::ConnectionClosed)
+		Buffer.Empty(Size);
+	}
+
+	Buffer.Reset();
+
+	for (int32 i = 0; i < Parameters.Num(); ++i)
+	{
+		const FDatabaseValue& Value = Parameters[i];
+		switch (Value.GetType())
+		{
+		case EDatabaseValueType::String:
 		{
-			if (RecursiveCount < ExecuteQueryConnectionLostRetryCount)
+			const FString& String = Value.String;
+
+			if (bWideStrings)
 			{
-				UE_LOG(LogDatabaseConnector, Warning, TEXT("Connection lost. Trying to reconnect..."))
+				nanodbc::wide_char_t* const Chars = (nanodbc::wide_char_t*)Allocate(GetBoundSize(Value, true));
 
-				if (Connect(Dsn))
-				{
-					UE_LOG(LogDatabaseConnector, Log, TEXT("Reconnected. Restarting query."));
-				}
-				else
-				{
-					UE_LOG(LogDatabaseConnector, Warning, TEXT("Failed to reconnect."));
-				}
+				FMemory::Memcpy(Chars, *String, String.Len() * sizeof(TCHAR));
+				Chars[String.Len()] = 0;
 
-				return Query(Sql, Dsn, Parameters, OutError, ++RecursiveCount);
+				Statement.bind(i, (const nanodbc::wide_char_t*)Chars);
 			}
+			else
+			{
+				const int32 Length = FTCHARToUTF8_Convert::ConvertedLength(*String, String.Len());
 
-			UE_LOG(LogDatabaseConnector, Error, TEXT("Query dropped has it failed to reconnect."));
-		}
+				char* const Chars = (char*)Allocate(Align(Length + 1, Alignment));
 
-		return FQueryResult();
-	}
+				FTCHARToUTF8_Convert::Convert((FUtf8Char*)Chars, Length, *String, String.Len());
+				Chars[Length] = '\0';
 
-	if (!QueryResult || QueryResult.columns() <= 0)
-	{
-		UE_LOG(LogDatabaseConnector, Log, TEXT("Query didn't return a result."));
-		return FQueryResult(QueryResult.affected_rows());
+				Statement.bind(i, (const char*)Chars);
+			}
+			break;
+		}
+		case EDatabaseValueType::Timestamp: Statement.bind(i, Emplace<nanodbc::timestamp>(Convert(Value.ToTimestamp())));	break;
+		case EDatabaseValueType::Date:		Statement.bind(i, Emplace<nanodbc::date>	  (Convert(Value.ToDate())));		break;
+		case EDatabaseValueType::Uint8:		Statement.bind(i, Emplace<int32> (Value));	break; // Bound as int32 as nanodbc doesn't support unsigned char.
+		case EDatabaseValueType::Int32:		Statement.bind(i, Emplace<int32> (Value));	break;
+		case EDatabaseValueType::Int64:		Statement.bind(i, Emplace<int64> (Value));	break;
+		case EDatabaseValueType::Double:	Statement.bind(i, Emplace<double>(Value));	break;
+		case EDatabaseValueType::Boolean:	Statement.bind(i, Emplace<int32> (Value));	break; // Bound as int32 as nanodbc doesn't support bool.
+		case EDatabaseValueType::Null: 		Statement.bind_null(i);						break;
+		default:
+			UE_LOG(LogDatabaseConnector, Error, TEXT("Unhandled type %d. Using NULL instead."), (int32)Value.GetType());
+			Statement.bind_null(i);
+		}
 	}
-
-	return GetQueryResult(QueryResult, OutError);
 }
 
-//////////////////////////////////////////////////////////////////////
-// FConnectionPool
-
-FConnectionPool::~FConnectionPool()
+/**
+ * Binds the parameters and executes the statement.
+ * @param Timeout Seconds before the execution is aborted. 0 for none.
+*/
+static nanodbc::result ExecuteStatementWithParameters(nanodbc::statement& Statement, const TArray<FDatabaseValue>& Parameters, FParameterArena& Arena, const long RowsetSize, const long Timeout, const bool bWideStrings)
 {
+	Arena.Bind(Statement, Parameters, bWideStrings);
 
+	// nanodbc sets the timeout of the statement on each execution.
+	return Statement.execute(RowsetSize, Timeout);
 }
 
-EDatabaseError FConnectionPool::Create(const FString& Url, const int32 Count)
+/**
+ * The values bound to one parameter marker for every row of a batch.
+ * Only the array matching the type is used. Must outlive the execution of the batch.
+*/
+struct FBatchParameterColumn
 {
-	try
-	{
-		// We no more need lock here
-		// Implementation prevents concurrency.
-		// i.e. can't use a pool while it is created.
-		Connections.Reserve(Count);
-		for (int32 i = 0; i < Count; ++i)
-		{
-			Connections.Emplace(MakeUnique<FConnection>(Url));
-		}
-	}
+	EDatabaseValueType Type = EDatabaseValueType::Null;
 
-	catch (const nanodbc::database_error& Exception)
-	{
-		UE_LOG(LogDatabaseConnector, Error, TEXT("Failed to create pool. Code: %d. Reason: %s"), Exception.native(), UTF8_TO_TCHAR(Exception.what()));
+	TArray<int32>				Int32s; // Also used for Uint8 and Boolean as nanodbc doesn't support them.
+	TArray<int64>				Int64s;
+	TArray<double>				Doubles;
+	TArray<nanodbc::timestamp>	Timestamps;
+	TArray<nanodbc::date>		Dates;
+	std::vector<std::string>	Strings;
+	std::vector<WideString>		WideStrings;
 
-		return EDatabaseError::FailedToOpenConnection;
-	}
+	TArray<bool> Nulls;
 
-	return EDatabaseError::None;
-}
+	void Reset(const int32 RowCount)
+	{
+		Int32s		.Reset(RowCount);
+		Int64s		.Reset(RowCount);
+		Doubles		.Reset(RowCount);
+		Timestamps	.Reset(RowCount);
+		Dates		.Reset(RowCount);
+		Nulls		.Reset(RowCount);
+
+		Strings.clear();
+		WideStrings.clear();
+	}
+};
 
-FConnection& FConnectionPool::AcquireOne()
+/**
+ * Gets the type a parameter is bound as for the whole batch: the type of its first non-NULL value.
+*/
+static EDatabaseValueType GetBatchParameterType(const TArray<TArray<FDatabaseValue>>& Rows, const int32 Index)
 {
-	for (const TUniquePtr<FConnection>& Connection : Connections)
+	for (const TArray<FDatabaseValue>& Row : Rows)
 	{
-		if (Connection->TryAcquire())
+		if (!Row[Index].IsNull())
 		{
-			return *Connection;
+			return Row[Index].GetType();
 		}
 	}
 
-	// With the current implementation where threadCount <=> connectionCount,
-	// this code is never executed.
-	// We have a guard for it just in case.
-	{ 
-		std::unique_lock<std::mutex> Locker(Sleeper);
-		SleeperCondition.wait(Locker);
-	}
-
-	return AcquireOne();
+	return EDatabaseValueType::Null;
 }
 
-int32 FConnectionPool::GetPoolSize() const
+/**
+ * Binds the parameters of a range of rows as column-wise arrays and executes them at once.
+ * Values of another type than their column's are converted. NULL values still take a slot in the arrays.
+ * @param Timeout		Seconds before the range is aborted. 0 for none.
+ * @param bWideStrings	If strings are bound as wide characters rather than UTF-8.
+ * @return The number of rows affected by the whole range.
+*/
+static int64 ExecuteStatementWithBatch(nanodbc::statement& Statement, const TArray<TArray<FDatabaseValue>>& Rows, const int32 FirstRow, const int32 RowCount, TArray<FBatchParameterColumn>& Columns, const long Timeout, const bool bWideStrings)
 {
-	return Connections.Num();
-}
+	Statement.reset_parameters();
 
-void FConnectionPool::Reconnect(const FString& Dsn, const int32 Timeout, int32& Reconnected, int32& Skipped, int32& Failed)
-{
-	Reconnected = Skipped = Failed = 0;
-	for (const TUniquePtr<FConnection>& Connection : Connections)
+	for (int32 i = 0; i < Columns.Num(); ++i)
 	{
-		if (Connection->TryAcquire())
+		FBatchParameterColumn& Column = Columns[i];
+
+		if (Column.Type == EDatabaseValueType::Null)
+		{
+			Statement.bind_null(i, RowCount);
+			continue;
+		}
+
+		Column.Reset(RowCount);
+
+		if (Column.Type == EDatabaseValueType::String)
 		{
-			if (Connection->Connect(Dsn, Timeout))
+			if (bWideStrings)
 			{
-				++Reconnected;
+				Column.WideStrings.reserve(RowCount);
 			}
 			else
 			{
-				++Failed;
+				Column.Strings.reserve(RowCount);
+			}
+		}
+
+		for (int32 RowIndex = FirstRow; RowIndex < FirstRow + RowCount; ++RowIndex)
+		{
+			const FDatabaseValue& Value	  = Rows[RowIndex][i];
+			const bool			  bIsNull = Value.IsNull();
+
+			Column.Nulls.Add(bIsNull);
+
+			switch (Column.Type)
+			{
+			case EDatabaseValueType::String:
+				if (bWideStrings)
+				{
+					Column.WideStrings.emplace_back(bIsNull ? WideString() : ToWideString(Value.ToString(false)));
+				}
+				else
+				{
+					Column.Strings.emplace_back(bIsNull ? "" : TCHAR_TO_UTF8(*Value.ToString(false)));
+				}
+				break;
+			case EDatabaseValueType::Timestamp: Column.Timestamps.Add(bIsNull ? nanodbc::timestamp{} : Convert(Value.ToTimestamp()));	break;
+			case EDatabaseValueType::Date:		Column.Dates.Add(bIsNull ? nanodbc::date{} : Convert(Value.ToDate()));						break;
+			case EDatabaseValueType::Int64:		Column.Int64s.Add(bIsNull ? 0 : Value.ToInt64());		break;
+			case EDatabaseValueType::Double:	Column.Doubles.Add(bIsNull ? 0. : Value.ToDouble());	break;
+			default:							Column.Int32s.Add(bIsNull ? 0 : Value.ToInt32());		break;
 			}
+		}
 
-			Connection->Unlock();
+		switch (Column.Type)
+		{
+		case EDatabaseValueType::String:
+			if (bWideStrings)
+			{
+				Statement.bind_strings(i, Column.WideStrings, Column.Nulls.GetData());
+			}
+			else
+			{
+				Statement.bind_strings(i, Column.Strings, Column.Nulls.GetData());
+			}
+			break;
+		case EDatabaseValueType::Timestamp: Statement.bind(i, Column.Timestamps.GetData(), RowCount, Column.Nulls.GetData());	break;
+		case EDatabaseValueType::Date:		Statement.bind(i, Column.Dates.GetData(),	   RowCount, Column.Nulls.GetData());	break;
+		case EDatabaseValueType::Int64:		Statement.bind(i, Column.Int64s.GetData(),	   RowCount, Column.Nulls.GetData());	break;
+		case EDatabaseValueType::Double:	Statement.bind(i, Column.Doubles.GetData(),	   RowCount, Column.Nulls.GetData());	break;
+		default:							Statement.bind(i, Column.Int32s.GetData(),	   RowCount, Column.Nulls.GetData());	break;
 		}
-		else ++Skipped;
 	}
-}
-
-//////////////////////////////////////////////////////////////////////
-// FConnectionHandle
 
+	// Binding arrays of RowCount values makes the driver send all the rows in one round trip.
+	nanodbc::result Result = Statement.execute(RowCount, Timeout);
 
-FConnectionHandle::FConnectionHandle(FConnectionPool& InPool)
-	: Pool(&InPool)
-{
-	Connection = &Pool->AcquireOne();
+	return FMath::Max<int64>(Result.affected_rows(), 0);
 }
 
-FConnectionHandle::~FConnectionHandle()
+/**
+ * The columns of a result set: their names, types and how they are read.
+ * Resolved once per prepared statement and shared by its results.
+*/
+struct FResultColumns
 {
-	Connection->Unlock();
+	TArray<FString>				Headers;
+	TArray<FColumnMetadata>		Metadata;
+
+	TSharedPtr<const FQueryColumnIndex, ESPMode::ThreadSafe> ColumnIndex;
+	TArray<EDatabaseValueType>	Types;
+	TArray<FColumnDecoder>		Decoders;
+
+	/**
+	 * The SQL data type of each column, to detect a result set that changed since it was described.
+	*/
+	TArray<int32>				DataTypes;
+};
+
+/**
+ * Reads a result set, all at once or chunk by chunk.
+ * The headers, metadata and column decoders are resolved once for all the chunks,
+ * and reused from the previous executions of the statement.
+*/
+class FQueryResultReader
+{
+public:
+	/**
+	 * @param Prepared				The cached statement the result comes from, or nullptr.
+	 * @param bDeduplicateStrings	If repeated strings of a column are stored once.
+	*/
+	FQueryResultReader(nanodbc::result& InQueryResult, FPreparedStatement* const Prepared, const bool bInDeduplicateStrings);
+
+	/**
+	 * Reads the next rows of the result set.
+	 * @param MaxRows	The maximum number of rows to read. Reads all the remaining rows if negative.
+	 * @param OutError	Set if fetching failed.
+	 * @return The rows read.
+	*/
+	FQueryResult Read(const int64 MaxRows, EDatabaseError& OutError);
+
+	/**
+	 * If all the rows have been read.
+	 * As we can't peek rows, a chunk filled to MaxRows might be followed by an empty one.
+	*/
+	FORCEINLINE bool IsDone() const { return bIsDone; }
+
+	/**
+	 * The number of rows read so far.
+	*/
+	FORCEINLINE int64 GetRowCount() const { return RowCount; }
+
+private:
+	nanodbc::result& QueryResult;
+
+	int64 AffectedRows;
+
+	TSharedPtr<const FResultColumns> Columns;
+
+	/**
+	 * Reused across cells to avoid temporary strings.
+	*/
+	TArray<FColumnScratch> Scratches;
+
+	bool bDeduplicateStrings;
+
+	int64 RowCount;
+	bool  bIsDone;
+};
+
+/**
+ * Describes the columns of a result set.
+*/
+static TSharedRef<const FResultColumns> DescribeColumns(const nanodbc::result& QueryResult)
+{
+	TSharedRef<FResultColumns> Columns = MakeShared<FResultColumns>();
+
+	const int32 ColumnCount = (int32)QueryResult.columns();
+
+	Columns->Headers .Reserve(ColumnCount);
+	Columns->Metadata.Reserve(ColumnCount);
+	Columns->Types	 .Reserve(ColumnCount);
+	Columns->Decoders.Reserve(ColumnCount);
+	Columns->DataTypes.Reserve(ColumnCount);
+
+	for (int32 i = 0; i < ColumnCount; ++i)
+	{
+		Columns->Headers.Add(UTF8_TO_TCHAR(QueryResult.column_name(i).c_str()));
+
+		FColumnMetadata& Meta = Columns->Metadata.Emplace_GetRef();
+
+		Meta.DecimalDigits	= QueryResult.column_decimal_digits(i);
+		Meta.DataTypeName	= UTF8_TO_TCHAR(QueryResult.column_datatype_name(i).c_str());
+		Meta.Size			= QueryResult.column_size(i);
+
+		const EDatabaseValueType Type = Columns->Types.Add_GetRef(GetColumnValueType(QueryResult, i));
+
+		// nanodbc binds wide columns as SQLWCHAR: we read them as is rather than through UTF-8.
+		Columns->Decoders.Add(Type == EDatabaseValueType::String && IsWideCharacterColumn(QueryResult, i) 
+			? &DecodeWideString : GetColumnDecoder(FQueryResultColumn(Type)));
+
+		Columns->DataTypes.Add(QueryResult.column_datatype(i));
+	}
+
+	Columns->ColumnIndex = MakeShared<FQueryColumnIndex, ESPMode::ThreadSafe>(Columns->Headers);
+
+	return Columns;
+}
+
+/**
+ * Checks that the columns described by a previous execution still match the result set,
+ * e.g. after a schema change or for a statement returning different result sets.
+*/
+static bool MatchesColumns(const FResultColumns& Columns, const nanodbc::result& QueryResult)
+{
+	const int32 ColumnCount = (int32)QueryResult.columns();
+
+	if (Columns.Headers.Num() != ColumnCount)
+	{
+		return false;
+	}
+
+	for (int32 i = 0; i < ColumnCount; ++i)
+	{
+		if (Columns.DataTypes[i] != QueryResult.column_datatype(i) ||
+			!Columns.Headers[i].Equals(UTF8_TO_TCHAR(QueryResult.column_name(i).c_str()), ESearchCase::CaseSensitive))
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+FQueryResultReader::FQueryResultReader(nanodbc::result& InQueryResult, FPreparedStatement* const Prepared, const bool bInDeduplicateStrings)
+	: QueryResult(InQueryResult)
+	, AffectedRows(InQueryResult.affected_rows())
+	, bDeduplicateStrings(bInDeduplicateStrings)
+	, RowCount(0)
+	, bIsDone(false)
+{
+	const int32 ColumnCount = (int32)QueryResult.columns();
+
+	if (Prepared && Prepared->Columns && MatchesColumns(*Prepared->Columns, QueryResult))
+	{
+		Columns = Prepared->Columns;
+	}
+	else
+	{
+		Columns = DescribeColumns(QueryResult);
+
+		if (Prepared)
+		{
+			Prepared->Columns = Columns;
+		}
+	}
+
+	Scratches.SetNum(ColumnCount);
+}
+
+FQueryResult FQueryResultReader::Read(const int64 MaxRows, EDatabaseError& OutError)
+{
+	TSharedRef<FQueryResultInternal, ESPMode::ThreadSafe> Result = MakeShared<FQueryResultInternal, ESPMode::ThreadSafe>(AffectedRows);
+
+	TArray<FQueryResultColumn>& ResultColumns = Result->Columns;
+
+	const TArray<EDatabaseValueType>&	Types		= Columns->Types;
+	const TArray<FColumnDecoder>&		Decoders	= Columns->Decoders;
+
+	const int32 ColumnCount		= Types.Num();
+	const int64 ExpectedRows	= MaxRows >= 0 ? MaxRows : AffectedRows;
+
+	Result->Headers		= Columns->Headers;
+	Result->Metadata	= Columns->Metadata;
+	Result->ColumnIndex = Columns->ColumnIndex;
+
+	ResultColumns.Reserve(ColumnCount);
+
+	for (int32 i = 0; i < ColumnCount; ++i)
+	{
+		FQueryResultColumn& Column = ResultColumns.Emplace_GetRef(Types[i]);
+
+		if (ExpectedRows > 0)
+		{
+			Column.Reserve(ExpectedRows);
+		}
+
+		Scratches[i].Deduplicator.Reset(bDeduplicateStrings && Column.Storage == EQueryColumnStorage::String);
+	}
+
+	try
+	{
+		// With a rowset size greater than 1, next() only goes
+		// to the driver once all the rows of the rowset are read.
+		while (MaxRows < 0 || Result->RowCount < MaxRows)
+		{
+			if (!QueryResult.next())
+			{
+				bIsDone = true;
+				break;
+			}
+
+			for (int32 j = 0; j < ColumnCount; ++j)
+			{
+				Decoders[j](QueryResult, (short)j, ResultColumns[j], Scratches[j]);
+			}
+
+			++Result->RowCount;
+		}
+	}
+	catch (const nanodbc::database_error& Error)
+	{
+		UE_LOG(LogDatabaseConnector, Error, TEXT("Failed to fetch results. Code: %d. Reason: %s"), Error.native(), UTF8_TO_TCHAR(Error.what()));
+
+		//UE_LOG(LogTemp, Error, TEXT("Native error: %d, State: %s"), Error.native(), UTF8_TO_TCHAR(Error.state().c_str()));
+
+		OutError = NSqlErrors::ConvertState(Error.state());;
+		bIsDone	 = true;
+	}
+	catch (const nanodbc::index_range_error& Exception)
+	{
+		UE_LOG(LogDatabaseConnector, Error, TEXT("Failed to fetch results because of index error. Reason: %s"), UTF8_TO_TCHAR(Exception.what()));
+		bIsDone = true;
+	}
+	catch (const nanodbc::type_incompatible_error& Exception)
+	{
+		UE_LOG(LogDatabaseConnector, Error, TEXT("Failed to fetch results because of a type mismatch. Reason: %s"), UTF8_TO_TCHAR(Exception.what()));
+
+		OutError = EDatabaseError::QueryFailed;
+		bIsDone	 = true;
+	}
+	catch (const std::exception& Exception)
+	{
+		UE_LOG(LogDatabaseConnector, Error, TEXT("Failed to fetch results. Reason: %s"), UTF8_TO_TCHAR(Exception.what()));
+
+		OutError = EDatabaseError::QueryFailed;
+		bIsDone	 = true;
+	}
+
+	// A failure in the middle of a row leaves it partially read.
+	// We complete it with NULLs to keep the columns aligned.
+	for (const FQueryResultColumn& Column : ResultColumns)
+	{
+		Result->RowCount = FMath::Max(Result->RowCount, Column.Num());
+	}
+
+	for (FQueryResultColumn& Column : ResultColumns)
+	{
+		while (Column.Num() < Result->RowCount)
+		{
+			Column.AddNull();
+		}
+	}
+
+	RowCount += Result->RowCount;
+
+	return FQueryResult(MoveTemp(Result));
+}
+
+/**
+ * Reads the result of an executed query and records its size for the next rowsets.
+*/
+static FQueryResult ReadQueryResult(nanodbc::result& QueryResult, FPreparedStatement* const Prepared, const bool bDeduplicateStrings, EDatabaseError& OutError)
+{
+	if (!QueryResult || QueryResult.columns() <= 0)
+	{
+		UE_LOG(LogDatabaseConnector, Log, TEXT("Query didn't return a result."));
+		return FQueryResult(QueryResult.affected_rows());
+	}
+
+	FQueryResultReader Reader(QueryResult, Prepared, bDeduplicateStrings);
+
+	FQueryResult Result = Reader.Read(-1, OutError);
+
+	if (Prepared)
+	{
+		Prepared->bSupportsRowsets	= AreAllColumnsBound(QueryResult);
+		Prepared->LastRowCount		= Reader.GetRowCount();
+	}
+
+	return Result;
+}
+
+#if WITH_DATABASE_ASYNC_EXECUTION
+/**
+ * Checks if the driver can signal an event when a statement completes.
+*/
+static bool SupportsAsyncNotification(const nanodbc::connection& Connection)
+{
+	try
+	{
+		return (Connection.get_info<uint32_t>(SQL_ASYNC_NOTIFICATION) & SQL_ASYNC_NOTIFICATION_CAPABLE) != 0;
+	}
+	catch (const nanodbc::database_error&)
+	{
+		// Drivers older than ODBC 3.8 don't know this information type.
+		return false;
+	}
+}
+#endif
+
+//////////////////////////////////////////////////////////////
+// FConnection
+
+#if WITH_DATABASE_ASYNC_EXECUTION
+struct FConnection::FPendingQuery
+{
+	FString Sql;
+
+	nanodbc::statement Statement;
+
+	FPreparedStatement* Prepared = nullptr;
+
+	long RowsetSize = 1;
+
+	/**
+	 * When the query started, in platform seconds.
+	*/
+	double StartTime = 0.;
+
+	FDatabaseCancellationState* Cancellation = nullptr;
+};
+#endif
+
+FConnection::FConnection()
+	: bIsAvailable(true)
+	, bIsOpen(false)
+	, LastUsedTime(0.)
+	, OpenTime(0.)
+	, LastCheckTime(0.)
+	, MaxRowsetSize(DefaultMaxRowsetSize)
+	, bWideStringParameters(false)
+	, bDeduplicateStrings(false)
+	, Metrics(nullptr)
+	, CircuitBreaker(nullptr)
+	, StatementCache(PreparedStatementCacheCapacity)
+#if WITH_DATABASE_ASYNC_EXECUTION
+	// Auto-reset so the event can be waited again for the next query.
+	, CompletionEvent(::CreateEventW(nullptr, false, false, nullptr))
+	, bSupportsAsyncExecution(false)
+#endif
+{
+}
+
+FConnection::~FConnection()
+{
+#if WITH_DATABASE_ASYNC_EXECUTION
+	check(!PendingQuery);
+
+	::CloseHandle((HANDLE)CompletionEvent);
+#endif
+}
+
+void FConnection::SetMaxRowsetSize(const int32 RowsetSize)
+{
+	MaxRowsetSize = FMath::Max(RowsetSize, 1);
+}
+
+void FConnection::SetStringOptions(const bool bInWideStringParameters, const bool bInDeduplicateStrings)
+{
+	bWideStringParameters = bInWideStringParameters;
+	bDeduplicateStrings	  = bInDeduplicateStrings;
+}
+
+void FConnection::SetMetrics(FDatabasePoolMetrics* InMetrics)
+{
+	Metrics = InMetrics;
+}
+
+void FConnection::SetFailurePolicy(const FDatabaseRetrySettings& InRetrySettings, FDatabaseCircuitBreaker* InCircuitBreaker)
+{
+	RetrySettings  = InRetrySettings;
+	CircuitBreaker = InCircuitBreaker;
+}
+
+const FDatabaseQueryTimings& FConnection::GetLastTimings() const
+{
+	return LastTimings;
+}
+
+void FConnection::Lock()
+{
+	const bool bIsConnectionAvailable = bIsAvailable.Exchange(false);
+	
+	check(bIsConnectionAvailable);
+}
+
+void FConnection::Unlock()
+{
+	const bool bWasConnectionLocked = !bIsAvailable.Exchange(true);
+
+	check(bWasConnectionLocked);
+}
+
+bool FConnection::BeginTransaction(EDatabaseError& OutError)
+{
+	OutError = EDatabaseError::None;
+
+	if (Transaction)
+	{
+		UE_LOG(LogDatabaseConnector, Error, TEXT("A transaction is already active on this connection."));
+
+		OutError = EDatabaseError::QueryFailed;
+		return false;
+	}
+
+	try
+	{
+		Transaction = MakeUnique<nanodbc::transaction>(Connection);
+	}
+	catch (const nanodbc::database_error& Error)
+	{
+		UE_LOG(LogDatabaseConnector, Error, TEXT("Failed to begin transaction. State: %s, Reason: %s"), 
+			UTF8_TO_TCHAR(Error.state().c_str()), UTF8_TO_TCHAR(Error.what()));
+
+		OutError = NSqlErrors::ConvertState(Error.state());
+		return false;
+	}
+
+	return true;
+}
+
+void FConnection::EndTransaction(const bool bCommit, EDatabaseError& OutError)
+{
+	OutError = EDatabaseError::None;
+
+	if (!Transaction)
+	{
+		OutError = EDatabaseError::TransactionEnded;
+		return;
+	}
+
+	try
+	{
+		if (bCommit)
+		{
+			Transaction->commit();
+		}
+		else
+		{
+			Transaction->rollback();
+		}
+	}
+	catch (const nanodbc::database_error& Error)
+	{
+		UE_LOG(LogDatabaseConnector, Error, TEXT("Failed to %s transaction. State: %s, Reason: %s"), bCommit ? TEXT("commit") : TEXT("roll back"),
+			UTF8_TO_TCHAR(Error.state().c_str()), UTF8_TO_TCHAR(Error.what()));
+
+		OutError = NSqlErrors::ConvertState(Error.state());
+	}
+
+	// Rolls back if the commit failed.
+	Transaction.Reset();
+}
+
+bool FConnection::IsInTransaction() const
+{
+	return Transaction.IsValid();
+}
+
+bool FConnection::Connect(const FString& Dsn, const int32 Timeout)
+{
+	// Statements belong to the previous connection handle
+	// and must be released before it gets closed.
+	StatementCache.Empty();
+
+	try
+	{
+		Connection.connect(TCHAR_TO_UTF8(*Dsn), Timeout);
+	}
+	catch (const nanodbc::database_error& DatabaseError)
+	{
+		UE_LOG(LogDatabaseConnector, Error, TEXT("Failed to connect. Code: %d. Reason: %s"),
+			DatabaseError.native(), UTF8_TO_TCHAR(DatabaseError.what()));
+
+		if (CircuitBreaker)
+		{
+			CircuitBreaker->OnFailure();
+		}
+
+		bIsOpen = false;
+		return false;
+	}
+
+	if (CircuitBreaker)
+	{
+		CircuitBreaker->OnSuccess();
+	}
+
+	OpenTime	  = FPlatformTime::Seconds();
+	LastCheckTime = OpenTime;
+
+#if WITH_DATABASE_ASYNC_EXECUTION
+	bSupportsAsyncExecution = SupportsAsyncNotification(Connection);
+#endif
+
+	bIsOpen = true;
+	return true;
+}
+
+void FConnection::Disconnect()
+{
+	StatementCache.Empty();
+
+	try
+	{
+		Connection.disconnect();
+	}
+	catch (const nanodbc::database_error& DatabaseError)
+	{
+		UE_LOG(LogDatabaseConnector, Warning, TEXT("Failed to disconnect. Code: %d. Reason: %s"),
+			DatabaseError.native(), UTF8_TO_TCHAR(DatabaseError.what()));
+	}
+
+	bIsOpen = false;
+}
+
+bool FConnection::IsOpen() const
+{
+	return bIsOpen;
+}
+
+double FConnection::GetLastUsedTime() const
+{
+	return LastUsedTime;
+}
+
+void FConnection::SetLastUsedTime(const double Time)
+{
+	LastUsedTime = Time;
+}
+
+double FConnection::GetOpenTime() const
+{
+	return OpenTime;
+}
+
+double FConnection::GetLastCheckTime() const
+{
+	return LastCheckTime;
+}
+
+bool FConnection::Ping(const FString& Sql, const int32 Timeout)
+{
+	try
+	{
+		nanodbc::just_execute(Connection, TCHAR_TO_UTF8(*Sql), 1, Timeout);
+	}
+	catch (const nanodbc::database_error& Error)
+	{
+		UE_LOG(LogDatabaseConnector, Warning, TEXT("Health check failed. State: %s, Reason: %s"), 
+			UTF8_TO_TCHAR(Error.state().c_str()), UTF8_TO_TCHAR(Error.what()));
+
+		return false;
+	}
+
+	LastCheckTime = FPlatformTime::Seconds();
+
+	if (CircuitBreaker)
+	{
+		CircuitBreaker->OnSuccess();
+	}
+
+	return true;
+}
+
+nanodbc::statement FConnection::Prepare(const FString& Sql, FPreparedStatement*& OutPrepared)
+{
+	// Only prepare the statement the first time we see this query
+	// so the server doesn't have to parse and plan it again.
+	OutPrepared = StatementCache.Find(Sql);
+
+	if (OutPrepared)
+	{
+		return OutPrepared->Statement;
+	}
+
+	nanodbc::statement Statement(Connection);
+
+	nanodbc::prepare(Statement, TCHAR_TO_UTF8(*Sql));
+
+	OutPrepared = StatementCache.Add(Sql, Statement);
+
+	return Statement;
+}
+
+nanodbc::result FConnection::Execute(const FString& Sql, const FString& Dsn, const TArray<FDatabaseValue>& Parameters, const int32 RowsetLimit, FPreparedStatement*& OutPrepared, EDatabaseError& OutError, const FExecutionContext& Context, int32 RecursiveCount)
+{
+	OutError	= EDatabaseError::None;
+	OutPrepared = nullptr;
+	
+	nanodbc::result QueryResult;
+
+	const double ExecuteStart = FPlatformTime::Seconds();
+
+	{
+		SCOPE_CYCLE_COUNTER(STAT_DatabaseExecute);
+
+		try
+		{
+			nanodbc::statement Statement = Prepare(Sql, OutPrepared);
+
+			if (Context.Cancellation && !Context.Cancellation->SetStatement(Statement))
+			{
+				OutError = EDatabaseError::Cancelled;
+				return nanodbc::result();
+			}
+
+			QueryResult = ExecuteStatementWithParameters(Statement, Parameters, ParameterArena, GetRowsetSize(OutPrepared, Parameters, FMath::Min<int32>(MaxRowsetSize, RowsetLimit)), GetStatementTimeout(Context.Timeout), bWideStringParameters);
+		}
+		catch (const nanodbc::database_error& Error)
+		{
+			// The statement might be left in an invalid state.
+			StatementCache.Remove(Sql);
+			OutPrepared = nullptr;
+
+			UE_LOG(LogDatabaseConnector, Error, TEXT("Failed to query database. State: %s, Reason: %s"), 
+				UTF8_TO_TCHAR(Error.state().c_str()), UTF8_TO_TCHAR(Error.what()));
+
+			OutError = NSqlErrors::ConvertState(Error.state());;
+		}
+	}
+
+	RecordExecution(ExecuteStart, OutError);
+
+	// Retries after a reconnection are added to the first attempt.
+	LastTimings.Execute += FPlatformTime::Seconds() - ExecuteStart;
+
+	if (OutError != EDatabaseError::None)
+	{
+		// We try to reconnect if the connection was closed.
+		if (OutError == EDatabaseError::ConnectionClosed)
+		{
+			// A write might have been applied before the connection was lost.
+			const bool bCanRetry = !RetrySettings.bOnlyRetryIdempotent || Context.bIdempotent || FQueryKey::IsReadStatement(Sql);
+
+			if (bCanRetry && PrepareRetry(Dsn, RecursiveCount, Context))
+			{
+				UE_LOG(LogDatabaseConnector, Log, TEXT("Restarting query."));
+
+				return Execute(Sql, Dsn, Parameters, RowsetLimit, OutPrepared, OutError, Context, ++RecursiveCount);
+			}
+
+			UE_LOG(LogDatabaseConnector, Error, TEXT("Query dropped as the connection was lost."));
+		}
+
+		return nanodbc::result();
+	}
+
+	return QueryResult;
+}
+
+FQueryResult FConnection::Query(const FString& Sql, const FString& Dsn, const TArray<FDatabaseValue>& Parameters, EDatabaseError& OutError, const FExecutionContext& Context)
+{
+	// The statement can be cancelled until its result is read.
+	ON_SCOPE_EXIT
+	{
+		if (Context.Cancellation)
+		{
+			Context.Cancellation->ClearStatement();
+		}
+	};
+
+	LastTimings = FDatabaseQueryTimings();
+
+	FPreparedStatement* Prepared = nullptr;
+
+	nanodbc::result QueryResult = Execute(Sql, Dsn, Parameters, MAX_int32, Prepared, OutError, Context);
+
+	if (OutError != EDatabaseError::None)
+	{
+		return FQueryResult();
+	}
+
+	return ReadResult(QueryResult, Prepared, OutError);
+}
+
+void FConnection::RecordExecution(const double StartTime, const EDatabaseError Error)
+{
+	if (Metrics)
+	{
+		Metrics->OnExecuted(StartTime, Error != EDatabaseError::None);
+	}
+
+	if (CircuitBreaker)
+	{
+		// Other errors come from the statement: the database answered.
+		if (Error == EDatabaseError::ConnectionClosed)
+		{
+			CircuitBreaker->OnFailure();
+		}
+		else
+		{
+			CircuitBreaker->OnSuccess();
+		}
+	}
+}
+
+bool FConnection::PrepareRetry(const FString& Dsn, const int32 Attempt, const FExecutionContext& Context)
+{
+	// Replaying the statement on a new connection would run it outside of the transaction.
+	if (Attempt >= RetrySettings.MaxRetries || Transaction)
+	{
+		return false;
+	}
+
+	// Fail fast while the database is down instead of adding to the load.
+	if (CircuitBreaker && CircuitBreaker->IsOpen())
+	{
+		return false;
+	}
+
+	const double Backoff = RetrySettings.GetBackoff(Attempt);
+
+	UE_LOG(LogDatabaseConnector, Warning, TEXT("Connection lost. Reconnecting in %.0fms (attempt %d of %d)..."), Backoff * 1000., Attempt + 1, RetrySettings.MaxRetries);
+
+	if (Backoff > 0.)
+	{
+		FPlatformProcess::Sleep((float)Backoff);
+	}
+
+	if (Context.Cancellation && Context.Cancellation->ShouldDrop())
+	{
+		return false;
+	}
+
+	if (Connect(Dsn))
+	{
+		if (Metrics)
+		{
+			Metrics->OnReconnected();
+		}
+
+		UE_LOG(LogDatabaseConnector, Log, TEXT("Reconnected."));
+	}
+	else
+	{
+		UE_LOG(LogDatabaseConnector, Warning, TEXT("Failed to reconnect."));
+	}
+
+	return true;
+}
+
+FQueryResult FConnection::ReadResult(nanodbc::result& QueryResult, FPreparedStatement* Prepared, EDatabaseError& OutError)
+{
+	SCOPE_CYCLE_COUNTER(STAT_DatabaseFetch);
+
+	const double FetchStart = FPlatformTime::Seconds();
+
+	FQueryResult Result = ReadQueryResult(QueryResult, Prepared, bDeduplicateStrings, OutError);
+
+	if (Metrics)
+	{
+		Metrics->OnFetched(FetchStart, Result.GetRowCount());
+	}
+
+	LastTimings.Fetch	 = FPlatformTime::Seconds() - FetchStart;
+	LastTimings.RowCount = Result.GetRowCount();
+
+	return Result;
+}
+
+#if WITH_DATABASE_ASYNC_EXECUTION
+bool FConnection::SupportsAsyncExecution() const
+{
+	return bSupportsAsyncExecution;
+}
+
+void* FConnection::GetCompletionEvent() const
+{
+	return CompletionEvent;
+}
+
+bool FConnection::BeginQuery(const FString& Sql, const TArray<FDatabaseValue>& Parameters, EDatabaseError& OutError, const FExecutionContext& Context)
+{
+	OutError = EDatabaseError::None;
+
+	check(!PendingQuery);
+
+	TUniquePtr<FPendingQuery> Query = MakeUnique<FPendingQuery>();
+
+	Query->Sql		 = Sql;
+	Query->StartTime = FPlatformTime::Seconds();
+
+	LastTimings = FDatabaseQueryTimings();
+
+	try
+	{
+		Query->Statement  = Prepare(Sql, Query->Prepared);
+		Query->RowsetSize = GetRowsetSize(Query->Prepared, Parameters, MaxRowsetSize);
+
+		const long Timeout = GetStatementTimeout(Context.Timeout);
+
+		if (Context.Cancellation && !Context.Cancellation->SetStatement(Query->Statement))
+		{
+			OutError = EDatabaseError::Cancelled;
+			return false;
+		}
+
+		Query->Cancellation = Context.Cancellation;
+
+		ParameterArena.Bind(Query->Statement, Parameters, bWideStringParameters);
+
+		// The driver completed it right away: signal it ourselves so it's completed like the others.
+		if (!Query->Statement.async_execute(CompletionEvent, Query->RowsetSize, Timeout))
+		{
+			::SetEvent((HANDLE)CompletionEvent);
+		}
+	}
+	catch (const nanodbc::database_error& Error)
+	{
+		// The statement might be left in an invalid state.
+		StatementCache.Remove(Sql);
+
+		if (Query->Cancellation)
+		{
+			Query->Cancellation->ClearStatement();
+		}
+
+		UE_LOG(LogDatabaseConnector, Error, TEXT("Failed to start query. State: %s, Reason: %s"), 
+			UTF8_TO_TCHAR(Error.state().c_str()), UTF8_TO_TCHAR(Error.what()));
+
+		OutError = NSqlErrors::ConvertState(Error.state());
+		return false;
+	}
+
+	PendingQuery = MoveTemp(Query);
+
+	return true;
+}
+
+FQueryResult FConnection::EndQuery(EDatabaseError& OutError)
+{
+	OutError = EDatabaseError::None;
+
+	check(PendingQuery);
+
+	TUniquePtr<FPendingQuery> Query = MoveTemp(PendingQuery);
+
+	ON_SCOPE_EXIT
+	{
+		if (Query->Cancellation)
+		{
+			Query->Cancellation->ClearStatement();
+		}
+	};
+
+	nanodbc::result QueryResult;
+
+	try
+	{
+		QueryResult = Query->Statement.complete_execute(Query->RowsetSize);
+	}
+	catch (const nanodbc::database_error& Error)
+	{
+		// It is left in asynchronous mode and can't be reused.
+		StatementCache.Remove(Query->Sql);
+
+		UE_LOG(LogDatabaseConnector, Error, TEXT("Failed to query database. State: %s, Reason: %s"), 
+			UTF8_TO_TCHAR(Error.state().c_str()), UTF8_TO_TCHAR(Error.what()));
+
+		OutError = NSqlErrors::ConvertState(Error.state());
+	}
+
+	RecordExecution(Query->StartTime, OutError);
+
+	LastTimings.Execute = FPlatformTime::Seconds() - Query->StartTime;
+
+	if (OutError != EDatabaseError::None)
+	{
+		return FQueryResult();
+	}
+
+	return ReadResult(QueryResult, Query->Prepared, OutError);
+}
+#endif
+
+void FConnection::QueryStream(const FString& Sql, const FString& Dsn, const TArray<FDatabaseValue>& Parameters, const int32 ChunkSize, TFunctionRef<bool(EDatabaseError, const FQueryResult&, bool)> OnChunk, const FExecutionContext& Context)
+{
+	// The statement can be cancelled until the last chunk is read.
+	ON_SCOPE_EXIT
+	{
+		if (Context.Cancellation)
+		{
+			Context.Cancellation->ClearStatement();
+		}
+	};
+
+	EDatabaseError Error;
+
+	FPreparedStatement* Prepared = nullptr;
+
+	// Rowsets larger than a chunk would only buffer rows we can't deliver yet.
+	nanodbc::result QueryResult = Execute(Sql, Dsn, Parameters, ChunkSize, Prepared, Error, Context);
+
+	if (Error != EDatabaseError::None)
+	{
+		OnChunk(Error, FQueryResult(), true);
+		return;
+	}
+
+	if (!QueryResult || QueryResult.columns() <= 0)
+	{
+		UE_LOG(LogDatabaseConnector, Log, TEXT("Query didn't return a result."));
+		OnChunk(Error, FQueryResult(QueryResult.affected_rows()), true);
+		return;
+	}
+
+	// Stopping before the last row leaves the cursor open on the cached statement,
+	// drivers without multiple active result sets would then reject the next query as busy.
+	ON_SCOPE_EXIT
+	{
+		SQLFreeStmt(QueryResult.native_statement_handle(), NOdbcApi::CloseCursor);
+	};
+
+	FQueryResultReader Reader(QueryResult, Prepared, bDeduplicateStrings);
+
+	bool bContinue = true;
+
+	while (bContinue && !Reader.IsDone())
+	{
+		const double FetchStart = FPlatformTime::Seconds();
+
+		FQueryResult Chunk;
+
+		{
+			SCOPE_CYCLE_COUNTER(STAT_DatabaseFetch);
+
+			Chunk = Reader.Read(ChunkSize, Error);
+		}
+
+		if (Metrics)
+		{
+			Metrics->OnFetched(FetchStart, Chunk.GetRowCount());
+		}
+
+		bContinue = OnChunk(Error, Chunk, Reader.IsDone()) && Error == EDatabaseError::None;
+	}
+
+	if (Prepared)
+	{
+		Prepared->bSupportsRowsets	= AreAllColumnsBound(QueryResult);
+		Prepared->LastRowCount		= Reader.GetRowCount();
+	}
+}
+
+FQueryResult FConnection::ExecuteBatch(const TArray<FDatabaseBatch>& Batches, const FString& Dsn, EDatabaseError& OutError, const FExecutionContext& Context, int32 RecursiveCount)
+{
+	OutError = EDatabaseError::None;
+
+	ON_SCOPE_EXIT
+	{
+		if (Context.Cancellation)
+		{
+			Context.Cancellation->ClearStatement();
+		}
+	};
+
+	int32 RowCount = 0;
+
+	for (const FDatabaseBatch& Batch : Batches)
+	{
+		const int32 ParameterCount = Batch.Rows.Num() > 0 ? Batch.Rows[0].Num() : 0;
+
+		for (const TArray<FDatabaseValue>& Row : Batch.Rows)
+		{
+			if (Row.Num() != ParameterCount)
+			{
+				UE_LOG(LogDatabaseConnector, Error, TEXT("All the rows of a batch must have the same number of parameters. Expected %d, got %d."), ParameterCount, Row.Num());
+
+				OutError = EDatabaseError::QueryFailed;
+				return FQueryResult();
+			}
+		}
+
+		RowCount += Batch.Rows.Num();
+	}
+
+	if (RowCount <= 0)
+	{
+		return FQueryResult(0);
+	}
+
+	TArray<FBatchParameterColumn> Columns;
+
+	uint64 AffectedRows = 0;
+
+	// The statement being executed, dropped from the cache if it fails.
+	const FString* Sql = nullptr;
+
+	// Applies to each round trip.
+	const long Timeout = GetStatementTimeout(Context.Timeout);
+
+	const double ExecuteStart = FPlatformTime::Seconds();
+
+	// Set once the commit is sent: the server might have applied it even if we lost the connection.
+	bool bCommitSent = false;
+
+	try
+	{
+		SCOPE_CYCLE_COUNTER(STAT_DatabaseExecute);
+
+		// The transaction is rolled back when it goes out of scope without being committed.
+		nanodbc::transaction BatchTransaction(Connection);
+
+		for (const FDatabaseBatch& Batch : Batches)
+		{
+			const TArray<TArray<FDatabaseValue>>& Rows = Batch.Rows;
+
+			if (Rows.Num() <= 0)
+			{
+				continue;
+			}
+
+			Sql = &Batch.Query;
+
+			FPreparedStatement* Prepared = nullptr;
+
+			nanodbc::statement Statement = Prepare(Batch.Query, Prepared);
+
+			if (Context.Cancellation && !Context.Cancellation->SetStatement(Statement))
+			{
+				OutError = EDatabaseError::Cancelled;
+				return FQueryResult();
+			}
+
+			const int32 ParameterCount = Rows[0].Num();
+
+			Columns.SetNum(ParameterCount);
+
+			for (int32 i = 0; i < ParameterCount; ++i)
+			{
+				Columns[i].Type = GetBatchParameterType(Rows, i);
+			}
+
+			for (int32 FirstRow = 0; FirstRow < Rows.Num(); FirstRow += MaxBatchSize)
+			{
+				AffectedRows += ExecuteStatementWithBatch(Statement, Rows, FirstRow, FMath::Min(MaxBatchSize, Rows.Num() - FirstRow), Columns, Timeout, bWideStringParameters);
+			}
+
+			// Don't let the cached statement point to our arrays after they are released.
+			Statement.reset_parameters();
+		}
+
+		Sql = nullptr;
+
+		bCommitSent = true;
+
+		BatchTransaction.commit();
+	}
+	catch (const nanodbc::database_error& Error)
+	{
+		// The statement might be left in an invalid state.
+		if (Sql)
+		{
+			StatementCache.Remove(*Sql);
+		}
+
+		UE_LOG(LogDatabaseConnector, Error, TEXT("Failed to execute batch. State: %s, Reason: %s"), 
+			UTF8_TO_TCHAR(Error.state().c_str()), UTF8_TO_TCHAR(Error.what()));
+
+		OutError = NSqlErrors::ConvertState(Error.state());
+	}
+
+	RecordExecution(ExecuteStart, OutError);
+
+	// Lost before the commit, the transaction was rolled back so the whole batch can safely be sent again.
+	// Lost while committing, the rows might already be written and sending them again would duplicate them.
+	const bool bCanRetry = !bCommitSent || !RetrySettings.bOnlyRetryIdempotent || Context.bIdempotent;
+
+	if (OutError == EDatabaseError::ConnectionClosed && bCanRetry && PrepareRetry(Dsn, RecursiveCount, Context))
+	{
+		UE_LOG(LogDatabaseConnector, Log, TEXT("Restarting batch."));
+
+		return ExecuteBatch(Batches, Dsn, OutError, Context, ++RecursiveCount);
+	}
+
+	if (OutError != EDatabaseError::None)
+	{
+		return FQueryResult();
+	}
+
+	return FQueryResult(AffectedRows);
+}
+
+//////////////////////////////////////////////////////////////////////
+// FConnectionPool
+
+FConnectionPool::~FConnectionPool()
+{
+
+}
+
+EDatabaseError FConnectionPool::Create(const FString& InUrl, const FDatabasePoolSettings& Settings)
+{
+	// We no more need lock here
+	// Implementation prevents concurrency.
+	// i.e. can't use a pool while it is created.
+	Url					= InUrl;
+	MinConnections		= Settings.MinConnections;
+	IdleTimeout			= Settings.IdleTimeout;
+	GrowthWaitSeconds	= Settings.GrowthWaitTime / 1000.;
+	AcquireTimeout		= Settings.AcquireTimeout;
+
+	HealthCheckInterval = Settings.HealthCheckInterval;
+	HealthCheckQuery	= Settings.HealthCheckQuery;
+	MaxLifetime			= Settings.MaxLifetime;
+
+	MaxConnections				= Settings.MaxConnections;
+	ReservedCriticalConnections = Settings.ReservedCriticalConnections;
+	MaxBackgroundConnections	= Settings.GetMaxBackgroundConnections();
+
+	SlowQueryLog.Configure(Settings.SlowQueries);
+	CircuitBreaker.Configure(Settings.CircuitBreaker);
+
+	Connections.Reserve(Settings.MaxConnections);
+	for (int32 i = 0; i < Settings.MaxConnections; ++i)
+	{
+		FConnection& Connection = *Connections.Emplace_GetRef(MakeUnique<FConnection>());
+
+		Connection.SetStringOptions(Settings.bWideStringParameters, Settings.bDeduplicateStrings);
+		Connection.SetMetrics(&Metrics);
+		Connection.SetFailurePolicy(Settings.Retry, &CircuitBreaker);
+	}
+
+	for (int32 i = 0; i < MinConnections; ++i)
+	{
+		if (!Connections[i]->Connect(Url))
+		{
+			UE_LOG(LogDatabaseConnector, Error, TEXT("Failed to create pool."));
+
+			return EDatabaseError::FailedToOpenConnection;
+		}
+
+		Connections[i]->SetLastUsedTime(FPlatformTime::Seconds());
+	}
+
+	// Pushed in reverse so the first connections are used first.
+	for (int32 i = Connections.Num() - 1; i >= 0; --i)
+	{
+		if (i < MinConnections)
+		{
+			IdleConnections.Push(Connections[i].Get());
+		}
+		else
+		{
+			ClosedConnections.Push(Connections[i].Get());
+		}
+	}
+
+	OpenCount = MinConnections;
+
+	return EDatabaseError::None;
+}
+
+int32 FConnectionPool::GetLaneLimit(const EDatabaseQueryPriority Priority) const
+{
+	return Priority == EDatabaseQueryPriority::Critical ? MaxConnections : MaxConnections - ReservedCriticalConnections;
+}
+
+bool FConnectionPool::TryAdmit(const EDatabaseQueryPriority Priority)
+{
+	const bool	 bIsBackground = Priority == EDatabaseQueryPriority::Background;
+	const uint64 Increment	   = bIsBackground ? BackgroundAdmission + 1 : 1;
+	const uint64 Limit		   = GetLaneLimit(Priority);
+
+	uint64 Current = Admissions.Load();
+
+	do
+	{
+		if ((Current & AdmissionMask) >= Limit || (bIsBackground && (Current >> 32) >= (uint64)MaxBackgroundConnections))
+		{
+			return false;
+		}
+	}
+	while (!Admissions.CompareExchange(Current, Current + Increment));
+
+	return true;
+}
+
+void FConnectionPool::ReleaseAdmission(const EDatabaseQueryPriority Priority)
+{
+	Admissions -= Priority == EDatabaseQueryPriority::Background ? BackgroundAdmission + 1 : 1;
+}
+
+FConnection* FConnectionPool::AcquireOne(const EDatabaseQueryPriority Priority)
+{
+	const double WaitStart		= FPlatformTime::Seconds();
+	const double GrowthDeadline = WaitStart + GrowthWaitSeconds;
+	const double Deadline		= AcquireTimeout > 0. ? WaitStart + AcquireTimeout : MAX_dbl;
+
+	// Don't overtake threads already waiting.
+	bool bAdmitted = WaiterCount == 0 && TryAdmit(Priority);
+
+	if (bAdmitted)
+	{
+		if (FConnection* const Connection = IdleConnections.Pop())
+		{
+			Connection->Lock();
+			return Connection;
+		}
+	}
+
+	for (;;)
+	{
+		const double Now = FPlatformTime::Seconds();
+
+		// Only open a new connection once the busy ones had some time to be released,
+		// so short bursts don't open connections that get closed when idle right after.
+		if (bAdmitted && (Now >= GrowthDeadline || OpenCount == 0))
+		{
+			if (FConnection* const Connection = ClosedConnections.Pop())
+			{
+				++OpenCount;
+
+				UE_LOG(LogDatabaseConnector, Verbose, TEXT("Opening a new connection after waiting %.2fms."), (Now - WaitStart) * 1000.);
+
+				Connection->Lock();
+
+				// If it fails, the query reports the error after trying to reconnect.
+				Connection->Connect(Url);
+
+				return Connection;
+			}
+		}
+
+		if (Now >= Deadline)
+		{
+			UE_LOG(LogDatabaseConnector, Warning, TEXT("Timed out after waiting %.2fs for a connection."), Now - WaitStart);
+
+			if (bAdmitted)
+			{
+				ReleaseAdmission(Priority);
+
+				// Someone else might be admitted now.
+				if (WaiterCount > 0)
+				{
+					DispatchToWaiters();
+				}
+			}
+
+			return nullptr;
+		}
+
+		const double NextDeadline = Now < GrowthDeadline ? FMath::Min(GrowthDeadline, Deadline) : Deadline;
+
+		if (FConnection* const Connection = WaitForConnection(Priority, bAdmitted, NextDeadline - Now))
+		{
+			Connection->Lock();
+			return Connection;
+		}
+	}
+}
+
+FConnectionPool::FWaiter::FWaiter(const EDatabaseQueryPriority InPriority)
+	: Event(FPlatformProcess::GetSynchEventFromPool(false))
+	, Priority(InPriority)
+{
+}
+
+FConnectionPool::FWaiter::~FWaiter()
+{
+	FPlatformProcess::ReturnSynchEventToPool(Event);
+}
+
+void FConnectionPool::FWaiterQueue::AddFirst(FWaiter& Waiter)
+{
+	Waiter.Previous = nullptr;
+	Waiter.Next		= First;
+
+	(First ? First->Previous : Last) = &Waiter;
+
+	First = &Waiter;
+}
+
+void FConnectionPool::FWaiterQueue::AddLast(FWaiter& Waiter)
+{
+	Waiter.Previous = Last;
+	Waiter.Next		= nullptr;
+
+	(Last ? Last->Next : First) = &Waiter;
+
+	Last = &Waiter;
+}
+
+void FConnectionPool::FWaiterQueue::Remove(FWaiter& Waiter)
+{
+	(Waiter.Previous ? Waiter.Previous->Next : First) = Waiter.Next;
+	(Waiter.Next	 ? Waiter.Next->Previous : Last)  = Waiter.Previous;
+
+	Waiter.Previous = Waiter.Next = nullptr;
+}
+
+FConnection* FConnectionPool::WaitForConnection(const EDatabaseQueryPriority Priority, bool& bAdmitted, const double Seconds)
+{
+	FWaiter Waiter(Priority);
+
+	{
+		FScopeLock Lock(&Section);
+
+		// Must be visible before checking the free list again: a thread releasing
+		// a connection pushes it before checking if someone waits.
+		++WaiterCount;
+
+		Waiter.bAdmitted = bAdmitted || TryAdmit(Priority);
+
+		if (Waiter.bAdmitted)
+		{
+			if (FConnection* const Connection = IdleConnections.Pop())
+			{
+				--WaiterCount;
+
+				bAdmitted = true;
+				return Connection;
+			}
+		}
+
+		// An admitted waiter was already the oldest of its lane.
+		if (Waiter.bAdmitted)
+		{
+			Waiters[(int32)Priority].AddFirst(Waiter);
+		}
+		else
+		{
+			Waiters[(int32)Priority].AddLast(Waiter);
+		}
+	}
+
+	const uint32 WaitMs = Seconds >= MAX_uint32 / 1000. ? MAX_uint32 : (uint32)FMath::CeilToDouble(Seconds * 1000.);
+
+	Waiter.Event->Wait(WaitMs);
+
+	FScopeLock Lock(&Section);
+
+	// Woken up without a connection: leave the queue. Either we timed out,
+	// or we were admitted and might be able to open a new connection.
+	if (!Waiter.Granted && (Waiter.Previous || Waiter.Next || Waiters[(int32)Priority].First == &Waiter))
+	{
+		Waiters[(int32)Priority].Remove(Waiter);
+
+		--WaiterCount;
+	}
+
+	bAdmitted = Waiter.bAdmitted;
+
+	return Waiter.Granted;
+}
+
+void FConnectionPool::DispatchToWaiters()
+{
+	FScopeLock Lock(&Section);
+
+	// Lanes are served by priority.
+	for (FWaiterQueue& Queue : Waiters)
+	{
+		while (Queue.First)
+		{
+			FWaiter* const Waiter = Queue.First;
+
+			const bool bWasAdmitted = Waiter->bAdmitted;
+
+			if (!bWasAdmitted)
+			{
+				// Waiters of the lane after this one wouldn't be admitted either.
+				if (!TryAdmit(Waiter->Priority))
+				{
+					break;
+				}
+
+				Waiter->bAdmitted = true;
+			}
+
+			FConnection* const Connection = IdleConnections.Pop();
+
+			// Keeps waiting for a connection to be released.
+			if (!Connection && bWasAdmitted)
+			{
+				return;
+			}
+
+			Queue.Remove(*Waiter);
+
+			--WaiterCount;
+
+			// If null, the newly admitted waiter opens a new connection itself once allowed to.
+			Waiter->Granted = Connection;
+
+			// The waiter can't be destroyed before we release the lock.
+			Waiter->Event->Trigger();
+
+			if (!Connection)
+			{
+				return;
+			}
+		}
+	}
+}
+
+void FConnectionPool::Release(FConnection& Connection, const EDatabaseQueryPriority Priority)
+{
+	Connection.SetLastUsedTime(FPlatformTime::Seconds());
+	Connection.Unlock();
+
+	IdleConnections.Push(&Connection);
+
+	ReleaseAdmission(Priority);
+
+	if (WaiterCount > 0)
+	{
+		DispatchToWaiters();
+	}
+}
+
+void FConnectionPool::PushIdleConnections(const TArray<FConnection*>& InConnections)
+{
+	// PopAll() returns the top of the stack first.
+	for (int32 i = InConnections.Num() - 1; i >= 0; --i)
+	{
+		IdleConnections.Push(InConnections[i]);
+	}
+
+	if (WaiterCount > 0)
+	{
+		DispatchToWaiters();
+	}
+}
+
+int32 FConnectionPool::GetPoolSize() const
+{
+	return OpenCount;
+}
+
+int32 FConnectionPool::GetWaiterCount() const
+{
+	return WaiterCount;
+}
+
+FDatabasePoolMetrics& FConnectionPool::GetMetrics()
+{
+	return Metrics;
+}
+
+const FDatabasePoolMetrics& FConnectionPool::GetMetrics() const
+{
+	return Metrics;
+}
+
+FDatabaseSlowQueryLog& FConnectionPool::GetSlowQueryLog()
+{
+	return SlowQueryLog;
+}
+
+int32 FConnectionPool::CloseIdleConnections()
+{
+	if (IdleTimeout <= 0.)
+	{
+		return 0;
+	}
+
+	const double Now = FPlatformTime::Seconds();
+
+	// Connections are briefly unavailable while we look at them.
+	// Threads needing one meanwhile wait until they are put back.
+	TArray<FConnection*> Idle;
+	IdleConnections.PopAll(Idle);
+
+	TArray<FConnection*> Kept;
+	Kept.Reserve(Idle.Num());
+
+	int32 Closed = 0;
+
+	// The least recently used are at the bottom of the stack.
+	for (int32 i = Idle.Num() - 1; i >= 0; --i)
+	{
+		FConnection* const Connection = Idle[i];
+
+		if (OpenCount > MinConnections && Now - Connection->GetLastUsedTime() >= IdleTimeout)
+		{
+			Connection->Disconnect();
+
+			--OpenCount;
+			++Closed;
+
+			ClosedConnections.Push(Connection);
+		}
+		else
+		{
+			Kept.Insert(Connection, 0);
+		}
+	}
 
-	Pool->SleeperCondition.notify_one();
+	PushIdleConnections(Kept);
+
+	if (Closed > 0)
+	{
+		UE_LOG(LogDatabaseConnector, Log, TEXT("Closed %d idle connection(s). %d connection(s) remain open."), Closed, (int32)OpenCount);
+	}
+
+	return Closed;
+}
+
+int32 FConnectionPool::ValidateIdleConnections(FQueuedThreadPool* const Threads)
+{
+	if (HealthCheckInterval <= 0. && MaxLifetime <= 0.)
+	{
+		return 0;
+	}
+
+	const double Now = FPlatformTime::Seconds();
+
+	TArray<FConnection*> Idle;
+	IdleConnections.PopAll(Idle);
+
+	TArray<FConnection*> Available;
+	TArray<FConnection*> Due;
+
+	for (FConnection* const Connection : Idle)
+	{
+		const double LastKnownWorking = FMath::Max(Connection->GetLastUsedTime(), Connection->GetLastCheckTime());
+
+		const bool bIsDue = IsExpired(*Connection, Now) || (HealthCheckInterval > 0. && Now - LastKnownWorking >= HealthCheckInterval);
+
+		(bIsDue ? Due : Available).Add(Connection);
+	}
+
+	// The others stay available while the due ones are checked.
+	PushIdleConnections(Available);
+
+	if (Due.Num() <= 0)
+	{
+		return 0;
+	}
+
+	TArray<bool> Failed;
+	Failed.SetNumZeroed(Due.Num());
+
+	TAtomic<int32> Renewed(0);
+
+	// Checks mostly wait for the server: a lost database would otherwise cost a timeout per connection.
+	NDatabasePoolThread::ParallelFor(Threads, EDatabaseQueryPriority::Background, Due.Num(), [this, &Due, &Failed, &Renewed, Now](const int32 Index) -> void
+	{
+		FConnection& Connection = *Due[Index];
+
+		if (!IsExpired(Connection, Now) && Connection.Ping(HealthCheckQuery, HealthCheckTimeout))
+		{
+			return;
+		}
+
+		if (Connection.Connect(Url))
+		{
+			++Renewed;
+		}
+		else
+		{
+			Failed[Index] = true;
+		}
+	});
+
+	TArray<FConnection*> Kept;
+	Kept.Reserve(Due.Num());
+
+	int32 Closed = 0;
+
+	for (int32 i = 0; i < Due.Num(); ++i)
+	{
+		FConnection* const Connection = Due[i];
+
+		// Opened again when needed, which reports the error to the query if the database is still unreachable.
+		if (Failed[i])
+		{
+			Connection->Disconnect();
+
+			--OpenCount;
+			++Closed;
+
+			ClosedConnections.Push(Connection);
+		}
+		else
+		{
+			Kept.Add(Connection);
+		}
+	}
+
+	PushIdleConnections(Kept);
+
+	Metrics.OnReconnected(Renewed);
+
+	if (Renewed > 0 || Closed > 0)
+	{
+		UE_LOG(LogDatabaseConnector, Log, TEXT("Health check: %d connection(s) opened again, %d closed."), (int32)Renewed, Closed);
+	}
+
+	return Renewed;
+}
+
+bool FConnectionPool::IsExpired(const FConnection& Connection, const double Now) const
+{
+	return MaxLifetime > 0. && Connection.IsOpen() && Now - Connection.GetOpenTime() >= MaxLifetime;
+}
+
+void FConnectionPool::RenewIfExpired(FConnection& Connection)
+{
+	if (!IsExpired(Connection, FPlatformTime::Seconds()))
+	{
+		return;
+	}
+
+	UE_LOG(LogDatabaseConnector, Verbose, TEXT("Connection reached its max lifetime. Opening it again."));
+
+	// If it fails, the query reports the error after trying to reconnect.
+	if (Connection.Connect(Url))
+	{
+		Metrics.OnReconnected();
+	}
+}
+
+#if WITH_DATABASE_ASYNC_EXECUTION
+bool FConnectionPool::SupportsAsyncExecution() const
+{
+	// All the connections use the same driver.
+	for (const TUniquePtr<FConnection>& Connection : Connections)
+	{
+		if (Connection->IsOpen())
+		{
+			return Connection->SupportsAsyncExecution();
+		}
+	}
+
+	return false;
+}
+#endif
+
+void FConnectionPool::SetMaxRowsetSize(const int32 RowsetSize)
+{
+	for (const TUniquePtr<FConnection>& Connection : Connections)
+	{
+		Connection->SetMaxRowsetSize(RowsetSize);
+	}
+}
+
+void FConnectionPool::Reconnect(const FString& Dsn, const int32 Timeout, FQueuedThreadPool* const Threads, int32& Reconnected, int32& Skipped, int32& Failed)
+{
+	Reconnected = Skipped = Failed = 0;
+
+	// Connections in use are skipped, closed ones are opened when needed.
+	TArray<FConnection*> Idle;
+	IdleConnections.PopAll(Idle);
+
+	TAtomic<int32> Succeeded(0);
+
+	// Connecting mostly waits for the server: a lost database would otherwise cost a timeout per connection.
+	NDatabasePoolThread::ParallelFor(Threads, EDatabaseQueryPriority::Background, Idle.Num(), [&Idle, &Dsn, Timeout, &Succeeded](const int32 Index) -> void
+	{
+		if (Idle[Index]->Connect(Dsn, Timeout))
+		{
+			++Succeeded;
+		}
+	});
+
+	Reconnected = Succeeded;
+	Failed		= Idle.Num() - Reconnected;
+
+	Skipped = FMath::Max(OpenCount - Idle.Num(), 0);
+
+	Metrics.OnReconnected(Reconnected);
+
+	PushIdleConnections(Idle);
+}
+
+//////////////////////////////////////////////////////////////////////
+// FConnectionHandle
+
+
+FConnectionHandle::FConnectionHandle(FConnectionPool& InPool, const EDatabaseQueryPriority InPriority)
+	: Pool(&InPool)
+	, Priority(InPriority)
+	, AcquireTime(0.)
+	, Error(EDatabaseError::None)
+{
+	SCOPE_CYCLE_COUNTER(STAT_DatabaseAcquire);
+
+	// Fail fast while the database is down instead of queuing for a connection.
+	if (!Pool->CircuitBreaker.Allow())
+	{
+		Connection = nullptr;
+		Error	   = EDatabaseError::Unavailable;
+		return;
+	}
+
+	const double StartTime = FPlatformTime::Seconds();
+
+	Connection = Pool->AcquireOne(Priority);
+
+	if (Connection)
+	{
+		Pool->RenewIfExpired(*Connection);
+	}
+	else
+	{
+		Error = EDatabaseError::Timeout;
+	}
+
+	AcquireTime = FPlatformTime::Seconds() - StartTime;
+
+	Pool->Metrics.OnAcquired(StartTime, Connection == nullptr);
+}
+
+FConnectionHandle::~FConnectionHandle()
+{
+	if (Connection)
+	{
+		Pool->Release(*Connection, Priority);
+	}
+}
+
+bool FConnectionHandle::IsValid() const
+{
+	return Connection != nullptr;
+}
+
+EDatabaseError FConnectionHandle::GetError() const
+{
+	return Error;
 }
 
 FConnection& FConnectionHandle::Get()
 {
+	check(Connection);
+
 	return *Connection;
 }
 
+double FConnectionHandle::GetAcquireTime() const
+{
+	return AcquireTime;
+}
 
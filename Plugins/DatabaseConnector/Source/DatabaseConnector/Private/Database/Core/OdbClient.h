@@ -3,6 +3,7 @@
 #pragma once
 
 #include "CoreMinimal.h"
+#include "Containers/LockFreeList.h"
 
 #if PLATFORM_WINDOWS
 #	include "Windows/AllowWindowsPlatformTypes.h"
@@ -17,38 +18,398 @@ THIRD_PARTY_INCLUDES_END
 #endif // PLATFORM_WINDOWS
 
 #include <list>
-#include <mutex>
-#include <condition_variable>
 
 #include "Database/Value.h"
 #include "Database/Errors.h"
 #include "Database/QueryResult.h"
+#include "Database/PoolSettings.h"
+#include "Database/QueryOptions.h"
+#include "Database/Batch.h"
+
+#include "StatementCache.h"
+#include "PoolMetrics.h"
+#include "SlowQueryLog.h"
+#include "CircuitBreaker.h"
+
+struct FDatabaseCancellationState;
+class FQueuedThreadPool;
+
+/**
+ * How a statement is executed on a connection.
+*/
+struct FExecutionContext
+{
+	/**
+	 * Seconds before the driver cancels the statement. 0 for no limit.
+	*/
+	float Timeout = 0.f;
+
+	/**
+	 * Used to cancel the statement from another thread. Can be null.
+	*/
+	FDatabaseCancellationState* Cancellation = nullptr;
+
+	/**
+	 * If the statement can be sent again when the connection is lost, even if only idempotent statements are retried.
+	*/
+	bool bIdempotent = false;
+};
+
+/**
+ * The values bound to the parameters of a statement, laid out in a single buffer.
+ * The buffer is sized from the parameters before anything is bound, so the values keep
+ * their address until the next call to Bind(), and is reused by the next executions.
+*/
+class FParameterArena
+{
+private:
+	/**
+	 * Values are aligned for the largest scalar bound.
+	*/
+	static constexpr SIZE_T Alignment = 8;
+
+	/**
+	 * Buffers larger than this are shrunk by the next smaller execution
+	 * so a single large query doesn't keep memory on the connection.
+	*/
+	static constexpr int32 MaxRetainedSize = 64 * 1024;
+
+public:
+	FParameterArena() = default;
+
+	FParameterArena(const FParameterArena&) = delete;
+	FParameterArena& operator=(const FParameterArena&) = delete;
+
+	/**
+	 * Copies the parameters in the buffer and binds them, resetting the previous bindings of the statement.
+	 * @param bWideStrings If strings are bound as wide characters rather than UTF-8.
+	*/
+	void Bind(nanodbc::statement& Statement, const TArray<FDatabaseValue>& Parameters, const bool bWideStrings);
+
+private:
+	/**
+	 * Gets the number of bytes the value uses in the buffer, padding included.
+	*/
+	static int32 GetBoundSize(const FDatabaseValue& Value, const bool bWideStrings);
+
+	/**
+	 * Takes the next bytes of the buffer. Never reallocates the buffer.
+	*/
+	uint8* Allocate(const int32 Size);
+
+	/**
+	 * Copies a value in the next bytes of the buffer.
+	*/
+	template<typename T>
+	T* Emplace(const T& Value)
+	{
+		return new (Allocate(sizeof(T))) T(Value);
+	}
+
+private:
+	TArray<uint8, TAlignedHeapAllocator<Alignment>> Buffer;
+};
 
 class FConnection
 {
+private:
+	/**
+	 * The number of prepared statements kept per connection.
+	*/
+	static constexpr int32 PreparedStatementCacheCapacity = 32;
+
+	/**
+	 * The maximum number of parameter rows sent to the driver per round trip in a batch.
+	*/
+	static constexpr int32 MaxBatchSize = 1024;
+
 public:
-	FConnection(const FString& Url);
+	/**
+	 * The default maximum number of rows fetched per round trip.
+	*/
+	static constexpr int32 DefaultMaxRowsetSize = 256;
+
+public:
+	/**
+	 * Creates a closed connection. It is opened with Connect().
+	*/
+	FConnection();
+	~FConnection();
 
 	FConnection(const FConnection&) = delete;
 	FConnection& operator=(const FConnection&) = delete;
 
-	bool TryAcquire();
 	void Lock();
 	void Unlock();
 
-	FQueryResult Query(const FString& Sql, const FString& Dsn, const TArray<FDatabaseValue> & Parameters, EDatabaseError& OutError, int32 RecursiveCount = 0);
+	FQueryResult Query(const FString& Sql, const FString& Dsn, const TArray<FDatabaseValue> & Parameters, EDatabaseError& OutError, const FExecutionContext& Context = FExecutionContext());
+
+	/**
+	 * Executes a query and reads its result chunk by chunk while keeping the cursor open.
+	 * @param ChunkSize	The maximum number of rows per chunk.
+	 * @param OnChunk	Called for each chunk with the error, the chunk and if it is the last one.
+	 *					Returning false closes the cursor without reading the remaining rows.
+	*/
+	void QueryStream(const FString& Sql, const FString& Dsn, const TArray<FDatabaseValue>& Parameters, const int32 ChunkSize, TFunctionRef<bool(EDatabaseError, const FQueryResult&, bool)> OnChunk, 
+		const FExecutionContext& Context = FExecutionContext());
+
+	/**
+	 * Executes statements once per row of parameters, binding them as arrays so rows
+	 * are sent by batches of MaxBatchSize. All the statements are executed in order in a single transaction.
+	 * @param Batches The statements and the parameters of each of their executions.
+	 * @return A result holding the total number of affected rows.
+	*/
+	FQueryResult ExecuteBatch(const TArray<FDatabaseBatch>& Batches, const FString& Dsn, EDatabaseError& OutError, 
+		const FExecutionContext& Context = FExecutionContext(), int32 RecursiveCount = 0);
+
+	/**
+	 * Starts a transaction: statements executed on this connection
+	 * are no more committed until EndTransaction() is called.
+	 * Lost connections are not re-established while in a transaction.
+	 * @return If the transaction started.
+	*/
+	bool BeginTransaction(EDatabaseError& OutError);
+
+	/**
+	 * Commits or rolls back the current transaction.
+	 * @param bCommit True to commit, false to roll back.
+	*/
+	void EndTransaction(const bool bCommit, EDatabaseError& OutError);
+
+	bool IsInTransaction() const;
 
 	bool Connect(const FString& Dsn, const int32 Timeout = 0);
 
+	void Disconnect();
+
+	/**
+	 * If the connection was successfully opened. Safe to call from any thread.
+	*/
+	bool IsOpen() const;
+
+	/**
+	 * Gets when the connection was last released to its pool, in platform seconds.
+	 * Only valid while the connection is held.
+	*/
+	double GetLastUsedTime() const;
+
+	void SetLastUsedTime(const double Time);
+
+	/**
+	 * Gets when the connection was last opened, in platform seconds.
+	*/
+	double GetOpenTime() const;
+
+	/**
+	 * Gets when the connection was last known to work, because it was opened or checked, in platform seconds.
+	*/
+	double GetLastCheckTime() const;
+
+	/**
+	 * Executes a cheap statement to check that the connection still works.
+	 * @param Timeout Seconds before the check fails. 0 for no limit.
+	*/
+	bool Ping(const FString& Sql, const int32 Timeout);
+
+	void SetMaxRowsetSize(const int32 RowsetSize);
+
+	/**
+	 * Sets how strings are exchanged with the driver. Must be called before the connection is used.
+	 * @param bInWideStringParameters	If string parameters are bound as wide characters rather than UTF-8.
+	 * @param bInDeduplicateStrings		If repeated strings of a column are stored once in results.
+	*/
+	void SetStringOptions(const bool bInWideStringParameters, const bool bInDeduplicateStrings);
+
+	/**
+	 * Sets the metrics the statements of this connection are recorded in. Must outlive the connection.
+	*/
+	void SetMetrics(FDatabasePoolMetrics* InMetrics);
+
+	/**
+	 * Sets how lost connections are handled. Must be called before the connection is used.
+	 * @param InCircuitBreaker Told about failures and successes. Can be null, must outlive the connection otherwise.
+	*/
+	void SetFailurePolicy(const FDatabaseRetrySettings& InRetrySettings, FDatabaseCircuitBreaker* InCircuitBreaker);
+
+	/**
+	 * Gets the execute and fetch times of the last query executed with Query() or EndQuery().
+	*/
+	const FDatabaseQueryTimings& GetLastTimings() const;
+
+#if WITH_DATABASE_ASYNC_EXECUTION
+	/**
+	 * If the driver notifies the completion of statements, so queries can be started with BeginQuery().
+	*/
+	bool SupportsAsyncExecution() const;
+
+	/**
+	 * Starts executing a query without waiting for it.
+	 * The completion event is signaled once EndQuery() can be called without blocking.
+	 * Lost connections are not re-established: use Query() if it fails with ConnectionClosed.
+	 * @return If the query started. EndQuery() must then be called before using the connection again.
+	*/
+	bool BeginQuery(const FString& Sql, const TArray<FDatabaseValue>& Parameters, EDatabaseError& OutError, const FExecutionContext& Context = FExecutionContext());
+
+	/**
+	 * Completes the query started with BeginQuery() and reads its result.
+	*/
+	FQueryResult EndQuery(EDatabaseError& OutError);
+
+	/**
+	 * Gets the Windows event signaled when the query started with BeginQuery() completes.
+	*/
+	void* GetCompletionEvent() const;
+#endif
+
+private:
+	/**
+	 * Gets the statement prepared for this SQL from the cache, or prepares it.
+	 * @param OutPrepared	The cached statement, or nullptr if it couldn't be cached.
+	*/
+	nanodbc::statement Prepare(const FString& Sql, FPreparedStatement*& OutPrepared);
+
+	/**
+	 * Prepares, or reuses, the statement and executes it, reconnecting if the connection was lost.
+	 * @param RowsetLimit	The maximum number of rows fetched per round trip for this execution.
+	 * @param OutPrepared	The cached statement, or nullptr if it couldn't be cached.
+	*/
+	nanodbc::result Execute(const FString& Sql, const FString& Dsn, const TArray<FDatabaseValue>& Parameters, const int32 RowsetLimit, 
+		FPreparedStatement*& OutPrepared, EDatabaseError& OutError, const FExecutionContext& Context = FExecutionContext(), int32 RecursiveCount = 0);
+
+	/**
+	 * Reads the whole result of a statement, recording the time spent.
+	*/
+	FQueryResult ReadResult(nanodbc::result& QueryResult, FPreparedStatement* Prepared, EDatabaseError& OutError);
+
+	/**
+	 * Records the outcome of a statement in the metrics and the circuit breaker.
+	*/
+	void RecordExecution(const double StartTime, const EDatabaseError Error);
+
+	/**
+	 * Waits for the backoff of the attempt then reconnects, unless the statement shouldn't be sent again.
+	 * @param Attempt The number of retries already made.
+	 * @return If the statement can be sent again.
+	*/
+	bool PrepareRetry(const FString& Dsn, const int32 Attempt, const FExecutionContext& Context);
+
 private:
 	nanodbc::connection Connection;
 	TAtomic<bool> bIsAvailable;
+	TAtomic<bool> bIsOpen;
+
+	double LastUsedTime;
+	double OpenTime;
+	double LastCheckTime;
+
+	/**
+	 * The maximum number of rows fetched per round trip.
+	 * Can be changed from another thread while a query runs.
+	*/
+	TAtomic<int32> MaxRowsetSize;
+
+	bool bWideStringParameters;
+	bool bDeduplicateStrings;
+
+	/**
+	 * The parameters of the statement being executed.
+	 * Kept between executions so binding doesn't allocate once it is large enough.
+	*/
+	FParameterArena ParameterArena;
+
+	/**
+	 * The metrics of the pool owning this connection. Can be null.
+	*/
+	FDatabasePoolMetrics* Metrics;
+
+	FDatabaseRetrySettings RetrySettings;
+
+	/**
+	 * The circuit breaker of the pool owning this connection. Can be null.
+	*/
+	FDatabaseCircuitBreaker* CircuitBreaker;
+
+	/**
+	 * The timings of the last query, read by the pool for its slow query log.
+	*/
+	FDatabaseQueryTimings LastTimings;
+
+	/**
+	 * Statements already prepared on this connection.
+	 * Invalidated when the connection is re-established.
+	*/
+	FPreparedStatementCache StatementCache;
+
+	/**
+	 * The transaction started with BeginTransaction(), if any.
+	*/
+	TUniquePtr<nanodbc::transaction> Transaction;
+
+#if WITH_DATABASE_ASYNC_EXECUTION
+	struct FPendingQuery;
+
+	/**
+	 * The query started with BeginQuery(), with the parameters bound to it.
+	*/
+	TUniquePtr<FPendingQuery> PendingQuery;
+
+	void* CompletionEvent;
+
+	TAtomic<bool> bSupportsAsyncExecution;
+#endif
 };
 
 class FConnectionPool
 {
 private:
 	friend class FConnectionHandle;
+
+	/**
+	 * A thread waiting for a connection, queued in arrival order.
+	 * Released connections are handed directly to the oldest waiter.
+	*/
+	struct FWaiter
+	{
+		FWaiter(const EDatabaseQueryPriority InPriority);
+		~FWaiter();
+
+		FEvent* const Event;
+
+		const EDatabaseQueryPriority Priority;
+
+		/**
+		 * If the waiter was admitted in its lane. It then only waits for a connection.
+		*/
+		bool bAdmitted = false;
+
+		/**
+		 * Set by the releasing thread when the waiter is given a connection.
+		*/
+		FConnection* Granted = nullptr;
+
+		FWaiter* Previous = nullptr;
+		FWaiter* Next	  = nullptr;
+	};
+
+	/**
+	 * The waiters of a lane, oldest first.
+	*/
+	struct FWaiterQueue
+	{
+		FWaiter* First = nullptr;
+		FWaiter* Last  = nullptr;
+
+		void AddFirst(FWaiter& Waiter);
+		void AddLast (FWaiter& Waiter);
+		void Remove  (FWaiter& Waiter);
+	};
+
+	/**
+	 * Admissions are packed in a single atomic so both counters are checked and updated at once.
+	*/
+	static constexpr uint64 AdmissionMask		= 0xFFFFFFFFull;
+	static constexpr uint64 BackgroundAdmission = 1ull << 32;
+
 public:
 	 FConnectionPool() = default;
 	~FConnectionPool();
@@ -56,38 +417,201 @@ public:
 	FConnectionPool(const FConnectionPool&) = delete;
 	FConnectionPool operator=(const FConnectionPool&) = delete;
 
-	EDatabaseError Create(const FString& Url, const int32 Count);
+	/**
+	 * Creates the pool and opens its minimum number of connections.
+	 * The other connections are opened when the pool is under load.
+	*/
+	EDatabaseError Create(const FString& Url, const FDatabasePoolSettings& Settings);
 
+	/**
+	 * Gets the number of open connections.
+	*/
 	int32 GetPoolSize() const;
 
-	void Reconnect(const FString& Dsn, const int32 Timeout, int32& Reconnected, int32& Skipped, int32& Failed);
+	void SetMaxRowsetSize(const int32 RowsetSize);
+
+	/**
+	 * Opens the idle connections again. Connections in use are skipped.
+	 * @param Threads The pool's threads the connections are opened on, the calling thread included.
+	*/
+	void Reconnect(const FString& Dsn, const int32 Timeout, FQueuedThreadPool* const Threads, int32& Reconnected, int32& Skipped, int32& Failed);
+
+	/**
+	 * Closes the connections unused for longer than the idle timeout, keeping the minimum open.
+	 * @return The number of closed connections.
+	*/
+	int32 CloseIdleConnections();
+
+	/**
+	 * Checks the connections unused for longer than the health check interval, and renews
+	 * those older than their max lifetime. Failed connections are opened again, or closed if that fails.
+	 * @param Threads The pool's threads the connections are checked on, the calling thread included.
+	 * @return The number of connections opened again.
+	*/
+	int32 ValidateIdleConnections(FQueuedThreadPool* const Threads);
+
+	/**
+	 * Gets the number of threads waiting for a connection.
+	*/
+	int32 GetWaiterCount() const;
+
+	FDatabasePoolMetrics& GetMetrics();
+	const FDatabasePoolMetrics& GetMetrics() const;
+
+	FDatabaseSlowQueryLog& GetSlowQueryLog();
+
+#if WITH_DATABASE_ASYNC_EXECUTION
+	/**
+	 * If the driver of the open connections supports asynchronous execution.
+	*/
+	bool SupportsAsyncExecution() const;
+#endif
 
 private:
-	FConnection& AcquireOne();
+	/**
+	 * Gets an available connection, opening a new one or waiting for one to be released if needed.
+	 * @return The connection or nullptr if none was released before the acquire timeout.
+	*/
+	FConnection* AcquireOne(const EDatabaseQueryPriority Priority);
+
+	/**
+	 * Waits in the queue of the lane for a connection to be released.
+	 * @param bAdmitted If the caller was already admitted in its lane. Updated when the waiter gets admitted.
+	 * @return The connection or nullptr if none was released in time.
+	*/
+	FConnection* WaitForConnection(const EDatabaseQueryPriority Priority, bool& bAdmitted, const double Seconds);
+
+	/**
+	 * Makes the connection available again, giving it to the oldest waiter of the highest lane if any.
+	*/
+	void Release(FConnection& Connection, const EDatabaseQueryPriority Priority);
+
+	/**
+	 * Gives available connections to waiters, by lane then oldest first.
+	*/
+	void DispatchToWaiters();
+
+	/**
+	 * Takes a place in the lane if it didn't reach its number of connections.
+	*/
+	bool TryAdmit(const EDatabaseQueryPriority Priority);
+
+	void ReleaseAdmission(const EDatabaseQueryPriority Priority);
+
+	int32 GetLaneLimit(const EDatabaseQueryPriority Priority) const;
+
+	/**
+	 * Puts back idle connections taken out of the free list, in the same order.
+	*/
+	void PushIdleConnections(const TArray<FConnection*>& InConnections);
+
+	/**
+	 * Opens the connection again if it is older than the max lifetime.
+	*/
+	void RenewIfExpired(FConnection& Connection);
+
+	bool IsExpired(const FConnection& Connection, const double Now) const;
 
 private:
+	/**
+	 * All the connections the pool can open, open or not.
+	 * Created with the pool so the array never changes while the pool is used.
+	*/
 	TArray<TUniquePtr<FConnection>> Connections;
 
+	/**
+	 * Opened connections nobody is using. The most recently used is on top,
+	 * so the least used ones stay idle long enough to be closed.
+	*/
+	TLockFreePointerListLIFO<FConnection> IdleConnections;
+
+	/**
+	 * Connections not opened yet, or closed because they were idle.
+	*/
+	TLockFreePointerListLIFO<FConnection> ClosedConnections;
+
+	/**
+	 * The number of connections out of ClosedConnections.
+	*/
+	TAtomic<int32> OpenCount { 0 };
+
+	/**
+	 * The number of queued waiters. Read without lock by releasing threads
+	 * to only take the lock when someone is waiting.
+	*/
+	TAtomic<int32> WaiterCount { 0 };
+
+	FString Url;
+
+	int32  MinConnections	 = 0;
+	double IdleTimeout		 = 0.;
+	double GrowthWaitSeconds = 0.;
+	double AcquireTimeout	 = 0.;
+
+	double HealthCheckInterval = 0.;
+	double MaxLifetime		   = 0.;
+
+	FString HealthCheckQuery;
+
+	/**
+	 * The number of connections held in each lane.
+	 * Lower bits count all the admissions, upper bits the Background ones.
+	*/
+	TAtomic<uint64> Admissions { 0 };
+
+	int32 MaxConnections				= 0;
+	int32 ReservedCriticalConnections	= 0;
+	int32 MaxBackgroundConnections		= 0;
+
+	/**
+	 * Protects the waiters queues.
+	*/
 	FCriticalSection Section;
 
-	std::mutex Sleeper;
-	std::condition_variable SleeperCondition;
+	FWaiterQueue Waiters[3];
+
+	/**
+	 * Recorded by the connections and the threads of the pool.
+	*/
+	FDatabasePoolMetrics Metrics;
+
+	FDatabaseSlowQueryLog SlowQueryLog;
+
+	FDatabaseCircuitBreaker CircuitBreaker;
 };
 
 class FConnectionHandle
 {
 public:
-	FConnectionHandle(FConnectionPool& InPool);
+	FConnectionHandle(FConnectionPool& InPool, const EDatabaseQueryPriority InPriority = EDatabaseQueryPriority::Normal);
 
 	FConnectionHandle(const FConnectionHandle&) = delete;
 	FConnectionHandle& operator=(const FConnectionHandle&) = delete;
 
+	/**
+	 * If a connection was acquired. False if the pool timed out or its circuit breaker is open.
+	*/
+	bool IsValid() const;
+
+	/**
+	 * Gets why no connection was acquired: Timeout or Unavailable.
+	*/
+	EDatabaseError GetError() const;
+
 	FConnection& Get();
 
+	/**
+	 * Gets the seconds spent waiting for the connection.
+	*/
+	double GetAcquireTime() const;
+
 	~FConnectionHandle();
 
 private:
 	FConnection* Connection;
 	FConnectionPool* const Pool;
+	const EDatabaseQueryPriority Priority;
+	double AcquireTime;
+	EDatabaseError Error;
 };
 
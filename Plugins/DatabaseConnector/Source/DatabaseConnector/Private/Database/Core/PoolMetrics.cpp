@@ -0,0 +1,175 @@
+// Copyright Pandores Marketplace 2021. All Rights Reserved.
+
+#include "PoolMetrics.h"
+
+DEFINE_STAT(STAT_DatabaseAcquire);
+DEFINE_STAT(STAT_DatabaseExecute);
+DEFINE_STAT(STAT_DatabaseFetch);
+
+DEFINE_STAT(STAT_DatabaseQueries);
+DEFINE_STAT(STAT_DatabaseRows);
+DEFINE_STAT(STAT_DatabaseFailures);
+DEFINE_STAT(STAT_DatabaseReconnects);
+
+DEFINE_STAT(STAT_DatabaseQueuedTasks);
+
+//////////////////////////////////////////////////////////////
+// FDatabaseLatencyHistogram
+
+FDatabaseLatencyHistogram::FDatabaseLatencyHistogram()
+	: MaxMicroseconds(0)
+{
+	for (TAtomic<uint64>& Bucket : Buckets)
+	{
+		Bucket = 0;
+	}
+}
+
+void FDatabaseLatencyHistogram::Record(const double Seconds)
+{
+	const uint64 Microseconds = (uint64)FMath::Max(Seconds * 1000000., 0.);
+
+	const int32 Bucket = Microseconds > 0 ? FMath::Min((int32)FMath::FloorLog2_64(Microseconds) + 1, BucketCount - 1) : 0;
+
+	++Buckets[Bucket];
+
+	uint64 Max = MaxMicroseconds.Load(EMemoryOrder::Relaxed);
+
+	while (Microseconds > Max && !MaxMicroseconds.CompareExchange(Max, Microseconds))
+	{
+	}
+}
+
+uint64 FDatabaseLatencyHistogram::GetPercentile(const uint64 (&Counts)[BucketCount], const uint64 Total, const double Percentile) const
+{
+	const uint64 Target = FMath::Max<uint64>((uint64)FMath::CeilToDouble(Total * Percentile), 1);
+
+	uint64 Count = 0;
+
+	for (int32 i = 0; i < BucketCount; ++i)
+	{
+		Count += Counts[i];
+
+		if (Count >= Target)
+		{
+			return 1ull << i;
+		}
+	}
+
+	return 1ull << (BucketCount - 1);
+}
+
+FDatabaseLatencyStats FDatabaseLatencyHistogram::GetStats() const
+{
+	FDatabaseLatencyStats Stats;
+
+	// Buckets keep changing while we read them: percentiles are computed on our copy.
+	uint64 Counts[BucketCount];
+	uint64 Total = 0;
+
+	for (int32 i = 0; i < BucketCount; ++i)
+	{
+		Counts[i] = Buckets[i].Load(EMemoryOrder::Relaxed);
+		Total	 += Counts[i];
+	}
+
+	if (Total == 0)
+	{
+		return Stats;
+	}
+
+	const uint64 Max = MaxMicroseconds.Load(EMemoryOrder::Relaxed);
+
+	Stats.Count = (int64)Total;
+	Stats.P50	= FMath::Min(GetPercentile(Counts, Total, 0.50), Max) / 1000.f;
+	Stats.P99	= FMath::Min(GetPercentile(Counts, Total, 0.99), Max) / 1000.f;
+	Stats.Max	= Max / 1000.f;
+
+	return Stats;
+}
+
+//////////////////////////////////////////////////////////////
+// FDatabasePoolMetrics
+
+FDatabasePoolMetrics::FDatabasePoolMetrics()
+	: QueuedTasks(0)
+	, Queries(0)
+	, Failures(0)
+	, RowsReturned(0)
+	, Reconnects(0)
+	, AcquireTimeouts(0)
+{
+}
+
+void FDatabasePoolMetrics::OnTaskQueued()
+{
+	++QueuedTasks;
+
+	INC_DWORD_STAT(STAT_DatabaseQueuedTasks);
+}
+
+void FDatabasePoolMetrics::OnTaskStarted(const double QueuedTime)
+{
+	--QueuedTasks;
+
+	DEC_DWORD_STAT(STAT_DatabaseQueuedTasks);
+
+	QueueWait.Record(FPlatformTime::Seconds() - QueuedTime);
+}
+
+void FDatabasePoolMetrics::OnAcquired(const double StartTime, const bool bTimedOut)
+{
+	AcquireWait.Record(FPlatformTime::Seconds() - StartTime);
+
+	if (bTimedOut)
+	{
+		++AcquireTimeouts;
+	}
+}
+
+void FDatabasePoolMetrics::OnExecuted(const double StartTime, const bool bFailed)
+{
+	Execute.Record(FPlatformTime::Seconds() - StartTime);
+
+	++Queries;
+
+	INC_DWORD_STAT(STAT_DatabaseQueries);
+
+	if (bFailed)
+	{
+		++Failures;
+
+		INC_DWORD_STAT(STAT_DatabaseFailures);
+	}
+}
+
+void FDatabasePoolMetrics::OnFetched(const double StartTime, const int64 RowCount)
+{
+	Fetch.Record(FPlatformTime::Seconds() - StartTime);
+
+	RowsReturned += RowCount;
+
+	INC_DWORD_STAT_BY(STAT_DatabaseRows, RowCount);
+}
+
+void FDatabasePoolMetrics::OnReconnected(const int32 Count)
+{
+	Reconnects += Count;
+
+	INC_DWORD_STAT_BY(STAT_DatabaseReconnects, Count);
+}
+
+void FDatabasePoolMetrics::GetStats(FDatabasePoolStats& OutStats) const
+{
+	OutStats.QueuedTasks	 = FMath::Max(QueuedTasks.Load(), 0);
+	OutStats.Queries		 = Queries;
+	OutStats.Failures		 = Failures;
+	OutStats.RowsReturned	 = RowsReturned;
+	OutStats.Reconnects		 = Reconnects;
+	OutStats.AcquireTimeouts = AcquireTimeouts;
+
+	OutStats.QueueWait	 = QueueWait  .GetStats();
+	OutStats.AcquireWait = AcquireWait.GetStats();
+	OutStats.Execute	 = Execute	  .GetStats();
+	OutStats.Fetch		 = Fetch	  .GetStats();
+}
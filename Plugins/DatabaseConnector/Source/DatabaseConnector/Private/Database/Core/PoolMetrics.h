@@ -0,0 +1,113 @@
+// Copyright Pandores Marketplace 2021. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Stats/Stats.h"
+#include "Database/PoolStats.h"
+
+DECLARE_STATS_GROUP(TEXT("DatabaseConnector"), STATGROUP_DatabaseConnector, STATCAT_Advanced);
+
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Acquire Connection"),	STAT_DatabaseAcquire,	STATGROUP_DatabaseConnector, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Execute"),				STAT_DatabaseExecute,	STATGROUP_DatabaseConnector, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Fetch"),				STAT_DatabaseFetch,		STATGROUP_DatabaseConnector, );
+
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Queries"),			STAT_DatabaseQueries,	 STATGROUP_DatabaseConnector, );
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Rows Returned"),	STAT_DatabaseRows,		 STATGROUP_DatabaseConnector, );
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Failures"),			STAT_DatabaseFailures,	 STATGROUP_DatabaseConnector, );
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Reconnects"),		STAT_DatabaseReconnects, STATGROUP_DatabaseConnector, );
+
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Queued Tasks"),	STAT_DatabaseQueuedTasks, STATGROUP_DatabaseConnector, );
+
+/**
+ * Durations counted in power of two microsecond buckets.
+ * Recorded from any thread without lock.
+*/
+class FDatabaseLatencyHistogram
+{
+public:
+	/**
+	 * The last bucket starts at about 18 minutes.
+	*/
+	static constexpr int32 BucketCount = 32;
+
+public:
+	FDatabaseLatencyHistogram();
+
+	FDatabaseLatencyHistogram(const FDatabaseLatencyHistogram&) = delete;
+	FDatabaseLatencyHistogram& operator=(const FDatabaseLatencyHistogram&) = delete;
+
+	void Record(const double Seconds);
+
+	FDatabaseLatencyStats GetStats() const;
+
+private:
+	/**
+	 * Gets the upper bound of the bucket holding the percentile, in microseconds.
+	*/
+	uint64 GetPercentile(const uint64 (&Counts)[BucketCount], const uint64 Total, const double Percentile) const;
+
+private:
+	/**
+	 * Bucket 0 holds durations under 1us, bucket N those in [2^(N-1), 2^N[ us.
+	*/
+	TAtomic<uint64> Buckets[BucketCount];
+
+	TAtomic<uint64> MaxMicroseconds;
+};
+
+/**
+ * The counters of a pool, shared by its connections and its threads.
+ * Also feeds the DatabaseConnector stat group, summed over all the pools.
+*/
+struct FDatabasePoolMetrics
+{
+public:
+	FDatabasePoolMetrics();
+
+	FDatabasePoolMetrics(const FDatabasePoolMetrics&) = delete;
+	FDatabasePoolMetrics& operator=(const FDatabasePoolMetrics&) = delete;
+
+	void OnTaskQueued();
+
+	/**
+	 * @param QueuedTime When the task was queued, in platform seconds.
+	*/
+	void OnTaskStarted(const double QueuedTime);
+
+	/**
+	 * @param StartTime When the pool started looking for a connection, in platform seconds.
+	*/
+	void OnAcquired(const double StartTime, const bool bTimedOut);
+
+	/**
+	 * @param StartTime When the statement started, in platform seconds.
+	*/
+	void OnExecuted(const double StartTime, const bool bFailed);
+
+	/**
+	 * @param StartTime When the result started to be read, in platform seconds.
+	*/
+	void OnFetched(const double StartTime, const int64 RowCount);
+
+	void OnReconnected(const int32 Count = 1);
+
+	/**
+	 * Fills the counters. Connections and waiters are filled by the pool.
+	*/
+	void GetStats(FDatabasePoolStats& OutStats) const;
+
+private:
+	TAtomic<int32> QueuedTasks;
+
+	TAtomic<int64> Queries;
+	TAtomic<int64> Failures;
+	TAtomic<int64> RowsReturned;
+	TAtomic<int64> Reconnects;
+	TAtomic<int64> AcquireTimeouts;
+
+	FDatabaseLatencyHistogram QueueWait;
+	FDatabaseLatencyHistogram AcquireWait;
+	FDatabaseLatencyHistogram Execute;
+	FDatabaseLatencyHistogram Fetch;
+};
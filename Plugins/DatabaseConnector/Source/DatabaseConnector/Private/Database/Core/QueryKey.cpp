@@ -0,0 +1,91 @@
+// Copyright Pandores Marketplace 2021. All Rights Reserved.
+
+#include "QueryKey.h"
+
+FQueryKey::FQueryKey(FString InSql, TArray<FDatabaseValue> InParameters)
+	: Sql(MoveTemp(InSql))
+	, Parameters(MoveTemp(InParameters))
+	, Hash(GetTypeHash(Sql))
+{
+	for (const FDatabaseValue& Parameter : Parameters)
+	{
+		Hash = HashCombine(Hash, GetTypeHash(Parameter));
+	}
+}
+
+bool FQueryKey::operator==(const FQueryKey& Other) const
+{
+	// SQL text must not be folded: string literals in two queries may only differ by case.
+	return Hash == Other.Hash && Parameters == Other.Parameters && Sql.Equals(Other.Sql, ESearchCase::CaseSensitive);
+}
+
+SIZE_T FQueryKey::GetAllocatedSize() const
+{
+	return Sql.GetAllocatedSize() + Parameters.GetAllocatedSize();
+}
+
+bool FQueryKey::IsReadStatement(const FString& Sql)
+{
+	const TCHAR* Start = *Sql;
+
+	while (FChar::IsWhitespace(*Start) || *Start == TEXT('('))
+	{
+		++Start;
+	}
+
+	if (FCString::Strnicmp(Start, TEXT("SELECT"), 6) != 0 || FChar::IsIdentifier(Start[6]))
+	{
+		return false;
+	}
+
+	// SELECT ... INTO creates or fills a table and SELECT ... FOR UPDATE locks rows,
+	// so both behave as writes. Keywords inside quoted literals or identifiers are ignored.
+	bool bPreviousWasFor = false;
+
+	for (const TCHAR* Current = Start + 6; *Current;)
+	{
+		if (*Current == TEXT('\'') || *Current == TEXT('"') || *Current == TEXT('`') || *Current == TEXT('['))
+		{
+			const TCHAR Closing = *Current == TEXT('[') ? TEXT(']') : *Current;
+
+			for (++Current; *Current && *Current != Closing; ++Current);
+
+			if (*Current)
+			{
+				++Current;
+			}
+
+			bPreviousWasFor = false;
+			continue;
+		}
+
+		if (!FChar::IsIdentifier(*Current))
+		{
+			++Current;
+			continue;
+		}
+
+		const TCHAR* const Word = Current;
+
+		while (FChar::IsIdentifier(*Current))
+		{
+			++Current;
+		}
+
+		const int32 Length = Current - Word;
+
+		if (Length == 4 && FCString::Strnicmp(Word, TEXT("INTO"), 4) == 0)
+		{
+			return false;
+		}
+
+		if (Length == 6 && bPreviousWasFor && FCString::Strnicmp(Word, TEXT("UPDATE"), 6) == 0)
+		{
+			return false;
+		}
+
+		bPreviousWasFor = Length == 3 && FCString::Strnicmp(Word, TEXT("FOR"), 3) == 0;
+	}
+
+	return true;
+}
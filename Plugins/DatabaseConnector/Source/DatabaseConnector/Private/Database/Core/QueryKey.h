@@ -0,0 +1,35 @@
+// Copyright Pandores Marketplace 2021. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Database/Value.h"
+
+/**
+ * Identifies a query by its SQL text and its parameters.
+ * Hashed once so it is cheap to look up in maps.
+*/
+struct FQueryKey
+{
+public:
+	FQueryKey(FString InSql, TArray<FDatabaseValue> InParameters);
+
+	bool operator==(const FQueryKey& Other) const;
+
+	friend FORCEINLINE uint32 GetTypeHash(const FQueryKey& Key) { return Key.Hash; }
+
+	SIZE_T GetAllocatedSize() const;
+
+	/**
+	 * If the statement only reads, so executing it again or once for identical queries doesn't change the outcome.
+	 * The SELECT keyword is matched regardless of case. SELECT ... INTO and SELECT ... FOR UPDATE are writes.
+	*/
+	static bool IsReadStatement(const FString& Sql);
+
+public:
+	FString Sql;
+	TArray<FDatabaseValue> Parameters;
+
+private:
+	uint32 Hash;
+};
@@ -0,0 +1,167 @@
+// Copyright Pandores Marketplace 2021. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/CriticalSection.h"
+#include "Database/Value.h"
+#include "Database/QueryResult.h"
+
+/**
+ * How the cells of a column are laid out in memory.
+*/
+enum class EQueryColumnStorage : uint8
+{
+	/* Every cell is NULL, nothing is stored. */
+	None,
+	/* Uint8, Int32 and Int64 values. */
+	Integer,
+	Double,
+	Boolean,
+	Timestamp,
+	Date,
+	/* Views in the column's character arena. */
+	String,
+	/* Boxed values, only used for columns mixing several types. */
+	Variant
+};
+
+/**
+ * A string cell, as a range in its column's character arena.
+*/
+struct FQueryStringSpan
+{
+	int64 Offset;
+	int32 Length;
+};
+
+/**
+ * A column of a query result, stored contiguously.
+ * Only the array matching the column's storage is used. Null cells still
+ * take a slot in it so a row index is always a valid array index.
+*/
+struct FQueryResultColumn
+{
+public:
+	FQueryResultColumn() = default;
+	FQueryResultColumn(const EDatabaseValueType InType);
+
+	void Reserve(const int64 RowCount);
+
+	void AddNull();
+	void AddInteger(const int64 Value);
+	void AddDouble(const double Value);
+	void AddBoolean(const bool bValue);
+	void AddTimestamp(const FDatabaseTimestamp& Value);
+	void AddDate(const FDatabaseDate& Value);
+	void AddString(const TCHAR* const Data, const int32 Length);
+
+	/**
+	 * Adds a string cell whose characters are written afterward.
+	 * @return Where to write the Length characters of the cell.
+	*/
+	TCHAR* AddStringUninitialized(const int32 Length);
+
+	/**
+	 * Adds a string cell sharing the characters of a previous cell.
+	*/
+	void AddStringSpan(const FQueryStringSpan& Span);
+	void AddValue(const FDatabaseValue& Value);
+
+	bool IsNull(const int64 RowIndex) const;
+
+	/**
+	 * Boxes a cell.
+	 * @param RowIndex The row of the cell. Must be valid.
+	 * @return The cell's value.
+	*/
+	FDatabaseValue GetValue(const int64 RowIndex) const;
+
+	SIZE_T GetAllocatedSize() const;
+
+	FORCEINLINE int64 Num() const { return RowCount; }
+
+public:
+	/* The type of the values of this column as exposed to users. */
+	EDatabaseValueType	Type	= EDatabaseValueType::Null;
+	EQueryColumnStorage	Storage = EQueryColumnStorage::None;
+
+	TArray64<int64>					Integers;
+	TArray64<double>				Doubles;
+	TArray64<bool>					Booleans;
+	TArray64<FDatabaseTimestamp>	Timestamps;
+	TArray64<FDatabaseDate>			Dates;
+	TArray64<FQueryStringSpan>		Strings;
+	TArray64<TCHAR>					Characters;
+	TArray64<FDatabaseValue>		Variants;
+
+	/* One bit per row, set when the cell is NULL. */
+	TArray64<uint64> NullMask;
+
+private:
+	void MarkNull();
+
+private:
+	int64 RowCount = 0;
+};
+
+/**
+ * Finds columns by name with a hash lookup instead of comparing the names one by one.
+ * Case-insensitive. Built once per set of columns and shared by the results having them.
+*/
+struct FQueryColumnIndex
+{
+public:
+	explicit FQueryColumnIndex(const TArray<FString>& Headers);
+
+	/**
+	 * @return The index of the first column with this name, or INDEX_NONE.
+	*/
+	int32 Find(const FString& ColumnName) const;
+
+	SIZE_T GetAllocatedSize() const;
+
+public:
+	/**
+	 * Identifies the names and order of the columns, so column handles can be checked without comparing names.
+	*/
+	uint32 LayoutHash;
+
+private:
+	TMap<FString, int32> Indices;
+};
+
+struct FQueryResultInternal
+{
+public:
+	FQueryResultInternal() = default;
+	FQueryResultInternal(uint64 InAffectedRows)
+		: AffectedRows(InAffectedRows)
+	{}
+
+	SIZE_T GetAllocatedSize() const;
+
+	uint64 AffectedRows = 0;
+	int64  RowCount		= 0;
+	TArray<FString> Headers;
+	TArray<FColumnMetadata> Metadata;
+
+	/**
+	 * Indexes the headers. Null if there is no column.
+	*/
+	TSharedPtr<const FQueryColumnIndex, ESPMode::ThreadSafe> ColumnIndex;
+	TArray<FQueryResultColumn> Columns;
+
+	/**
+	 * The rows returned by address by FQueryResult::GetRow(), built on the first call.
+	*/
+	mutable TArray64<TArray<FDatabaseValue>> Rows;
+	mutable TAtomic<bool> bRowsBuilt { false };
+	mutable FCriticalSection RowsSection;
+
+	/**
+	 * Called with the memory taken by the rows once built, so the cache holding the result accounts for it.
+	 * Only set before the result is shared.
+	*/
+	mutable TFunction<void(SIZE_T)> OnRowsBuilt;
+};
@@ -0,0 +1,208 @@
+// Copyright Pandores Marketplace 2021. All Rights Reserved.
+
+#include "ResultCache.h"
+#include "QueryResultInternal.h"
+
+FQueryResultCache::FQueryResultCache(const SIZE_T InMaxMemory)
+	: MaxMemory(InMaxMemory)
+{
+}
+
+FQueryResultCache::~FQueryResultCache()
+{
+	Empty();
+}
+
+bool FQueryResultCache::Find(const FQueryKey& Key, FQueryResult& OutResult)
+{
+	FScopeLock Lock(&Section);
+
+	FEntry** const Found = Entries.Find(Key);
+
+	if (!Found)
+	{
+		return false;
+	}
+
+	FEntry* const Entry = *Found;
+
+	if (Entry->ExpirationTime <= FPlatformTime::Seconds())
+	{
+		Remove(Entry);
+		return false;
+	}
+
+	Unlink(Entry);
+	LinkFirst(Entry);
+
+	OutResult = Entry->Result;
+
+	return true;
+}
+
+uint64 FQueryResultCache::GetGeneration() const
+{
+	FScopeLock Lock(&Section);
+
+	return Generation;
+}
+
+void FQueryResultCache::Add(FQueryKey Key, const FQueryResult& Result, const double TimeToLive, const TArray<FName>& Tags, const uint64 StartGeneration)
+{
+	// The key is held twice, by the entry and by the hook of the result.
+	const SIZE_T Size = sizeof(FEntry) + Key.GetAllocatedSize() * 2 + Result.GetAllocatedSize();
+
+	FScopeLock Lock(&Section);
+
+	if (Size > MaxMemory)
+	{
+		return;
+	}
+
+	// A write invalidated the tables while we were reading them: the result might be stale.
+	for (const FName& Tag : Tags)
+	{
+		const uint64* const Invalidated = TagGenerations.Find(Tag);
+
+		if (Invalidated && *Invalidated > StartGeneration)
+		{
+			return;
+		}
+	}
+
+	if (FEntry** const Previous = Entries.Find(Key))
+	{
+		Remove(*Previous);
+	}
+
+	Trim(Size);
+
+	// The rows returned by address are built on demand: the hook keeps a copy of the key to find the entry.
+	Result.Internal->OnRowsBuilt = [WeakThis = TWeakPtr<FQueryResultCache, ESPMode::ThreadSafe>(AsShared()), HookKey = Key, Internal = Result.Internal.Get()](const SIZE_T RowsSize) -> void
+	{
+		if (const TSharedPtr<FQueryResultCache, ESPMode::ThreadSafe> This = WeakThis.Pin())
+		{
+			This->OnRowsBuilt(HookKey, Internal, RowsSize);
+		}
+	};
+
+	FEntry* const Entry = new FEntry(MoveTemp(Key));
+
+	Entry->Result			= Result;
+	Entry->Tags				= Tags;
+	Entry->ExpirationTime	= FPlatformTime::Seconds() + TimeToLive;
+	Entry->Size				= Size;
+
+	Entries.Add(Entry);
+	LinkFirst(Entry);
+
+	Memory += Size;
+}
+
+void FQueryResultCache::Invalidate(const TArray<FName>& Tags)
+{
+	if (Tags.Num() <= 0)
+	{
+		return;
+	}
+
+	FScopeLock Lock(&Section);
+
+	++Generation;
+
+	for (const FName& Tag : Tags)
+	{
+		TagGenerations.Add(Tag, Generation);
+	}
+
+	// Writes are rare compared to cached reads, a scan keeps lookups free of any tag index.
+	for (FEntry* Entry = MostRecent; Entry;)
+	{
+		FEntry* const Next = Entry->Next;
+
+		for (const FName& Tag : Entry->Tags)
+		{
+			if (Tags.Contains(Tag))
+			{
+				Remove(Entry);
+				break;
+			}
+		}
+
+		Entry = Next;
+	}
+}
+
+void FQueryResultCache::Empty()
+{
+	FScopeLock Lock(&Section);
+
+	while (MostRecent)
+	{
+		Remove(MostRecent);
+	}
+}
+
+void FQueryResultCache::OnRowsBuilt(const FQueryKey& Key, const FQueryResultInternal* Internal, const SIZE_T RowsSize)
+{
+	FScopeLock Lock(&Section);
+
+	FEntry** const Found = Entries.Find(Key);
+
+	if (!Found || (*Found)->Result.Internal.Get() != Internal)
+	{
+		return;
+	}
+
+	FEntry* const Entry = *Found;
+
+	Entry->Size += RowsSize;
+	Memory		+= RowsSize;
+
+	Trim(0);
+}
+
+void FQueryResultCache::Trim(const SIZE_T Reserved)
+{
+	while (LeastRecent && Memory + Reserved > MaxMemory)
+	{
+		Remove(LeastRecent);
+	}
+}
+
+void FQueryResultCache::Remove(FEntry* Entry)
+{
+	Unlink(Entry);
+
+	Entries.Remove(Entry->Key);
+
+	Memory -= Entry->Size;
+
+	delete Entry;
+}
+
+void FQueryResultCache::LinkFirst(FEntry* Entry)
+{
+	Entry->Previous = nullptr;
+	Entry->Next		= MostRecent;
+
+	if (MostRecent)
+	{
+		MostRecent->Previous = Entry;
+	}
+	else
+	{
+		LeastRecent = Entry;
+	}
+
+	MostRecent = Entry;
+}
+
+void FQueryResultCache::Unlink(FEntry* Entry)
+{
+	(Entry->Previous ? Entry->Previous->Next : MostRecent ) = Entry->Next;
+	(Entry->Next	 ? Entry->Next->Previous : LeastRecent) = Entry->Previous;
+
+	Entry->Previous = nullptr;
+	Entry->Next		= nullptr;
+}
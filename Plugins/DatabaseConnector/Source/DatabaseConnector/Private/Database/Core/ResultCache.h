@@ -0,0 +1,120 @@
+// Copyright Pandores Marketplace 2021. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Database/QueryResult.h"
+
+#include "QueryKey.h"
+
+/**
+ * Results of read queries kept by a pool, shared with the callers.
+ * Entries expire after their time to live, are evicted least recently used first
+ * past the memory limit, and are dropped when one of their tags is invalidated.
+ * Thread-safe.
+*/
+class FQueryResultCache : public TSharedFromThis<FQueryResultCache, ESPMode::ThreadSafe>
+{
+private:
+	struct FEntry
+	{
+		FEntry(FQueryKey&& InKey)
+			: Key(MoveTemp(InKey))
+		{}
+
+		FQueryKey Key;
+		FQueryResult Result;
+		TArray<FName> Tags;
+
+		/* Platform seconds after which the entry is no more returned. */
+		double ExpirationTime = 0.;
+
+		SIZE_T Size = 0;
+
+		/* Links in the recency list. */
+		FEntry* Previous = nullptr;
+		FEntry* Next	 = nullptr;
+	};
+
+	struct FEntryKeyFuncs : public BaseKeyFuncs<FEntry*, FQueryKey>
+	{
+		static FORCEINLINE const FQueryKey& GetSetKey(const FEntry* Entry)			{ return Entry->Key; }
+		static FORCEINLINE bool Matches(const FQueryKey& A, const FQueryKey& B)	{ return A == B; }
+		static FORCEINLINE uint32 GetKeyHash(const FQueryKey& Key)				{ return GetTypeHash(Key); }
+	};
+
+public:
+	/**
+	 * @param InMaxMemory The number of bytes results can use before the least recently used are evicted.
+	*/
+	explicit FQueryResultCache(const SIZE_T InMaxMemory);
+	~FQueryResultCache();
+
+	FQueryResultCache(const FQueryResultCache&) = delete;
+	FQueryResultCache& operator=(const FQueryResultCache&) = delete;
+
+	/**
+	 * Gets a result that didn't expire.
+	 * @return If a result was found.
+	*/
+	bool Find(const FQueryKey& Key, FQueryResult& OutResult);
+
+	/**
+	 * Gets the number of invalidations so far. Taken before executing
+	 * a query so its result isn't cached if its tags changed meanwhile.
+	*/
+	uint64 GetGeneration() const;
+
+	/**
+	 * Caches a result, replacing the previous one of this query.
+	 * @param TimeToLive	Seconds the result is returned.
+	 * @param Tags			The tables the result was read from.
+	 * @param Generation	The generation before the query was executed.
+	*/
+	void Add(FQueryKey Key, const FQueryResult& Result, const double TimeToLive, const TArray<FName>& Tags, const uint64 Generation);
+
+	/**
+	 * Drops the results read from these tables.
+	*/
+	void Invalidate(const TArray<FName>& Tags);
+
+	void Empty();
+
+private:
+	/**
+	 * Unlinks, unindexes and deletes an entry.
+	*/
+	void Remove(FEntry* Entry);
+
+	/**
+	 * Adds the rows built since a result was cached to its size.
+	 * @param Internal The dataset the rows were built for, to ignore results since replaced.
+	*/
+	void OnRowsBuilt(const FQueryKey& Key, const FQueryResultInternal* Internal, const SIZE_T RowsSize);
+
+	/**
+	 * Evicts the least recently used entries until the results fit in memory.
+	*/
+	void Trim(const SIZE_T Reserved);
+
+	void LinkFirst(FEntry* Entry);
+	void Unlink(FEntry* Entry);
+
+private:
+	mutable FCriticalSection Section;
+
+	TSet<FEntry*, FEntryKeyFuncs> Entries;
+
+	FEntry* MostRecent	= nullptr;
+	FEntry* LeastRecent = nullptr;
+
+	SIZE_T Memory = 0;
+	const SIZE_T MaxMemory;
+
+	uint64 Generation = 0;
+
+	/**
+	 * The generation at which each tag was last invalidated.
+	*/
+	TMap<FName, uint64> TagGenerations;
+};
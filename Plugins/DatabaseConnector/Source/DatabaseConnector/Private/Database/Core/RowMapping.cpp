@@ -0,0 +1,474 @@
+// Copyright Pandores Marketplace 2021. All Rights Reserved.
+
+#include "RowMapping.h"
+
+#include "QueryResultInternal.h"
+
+#include "UObject/Class.h"
+#include "UObject/UnrealType.h"
+#include "UObject/TextProperty.h"
+#include "UObject/EnumProperty.h"
+#include "Misc/ScopeLock.h"
+
+#include "DatabaseConnectorModule.h"
+
+/**
+ * Hashes the properties of a structure, where they are and what they are.
+*/
+static uint32 GetLayoutHash(const UScriptStruct* Struct)
+{
+	uint32 Hash = GetTypeHash(Struct->GetStructureSize());
+
+	for (TFieldIterator<FProperty> It(Struct); It; ++It)
+	{
+		const FProperty* const Property = *It;
+
+		Hash = HashCombine(Hash, PointerHash(Property));
+		Hash = HashCombine(Hash, GetTypeHash(Property->GetFName()));
+		Hash = HashCombine(Hash, GetTypeHash(Property->GetClass()->GetFName()));
+		Hash = HashCombine(Hash, GetTypeHash(Property->GetOffset_ForInternal()));
+		Hash = HashCombine(Hash, GetTypeHash(Property->GetSize()));
+	}
+
+	return Hash;
+}
+
+/**
+ * The plans built so far, by structure.
+*/
+class FRowBindingPlanCache
+{
+public:
+	/**
+	 * Plans are small but keyed by structures that can be unloaded: the cache is reset past this number.
+	*/
+	static constexpr int32 MaxPlans = 1024;
+
+	static FRowBindingPlanCache& Get()
+	{
+		static FRowBindingPlanCache Cache;
+		return Cache;
+	}
+
+	TSharedRef<const FRowBindingPlan, ESPMode::ThreadSafe> Find(const UScriptStruct* Struct, const TArray<FString>& Columns)
+	{
+		const uint32 LayoutHash = GetLayoutHash(Struct);
+
+		FScopeLock Lock(&Section);
+
+		TArray<TSharedRef<const FRowBindingPlan, ESPMode::ThreadSafe>>& StructPlans = Plans.FindOrAdd(Struct);
+
+		for (int32 i = StructPlans.Num() - 1; i >= 0; --i)
+		{
+			const FRowBindingPlan& Plan = *StructPlans[i];
+
+			// The structure was unloaded and another one took its address, or it was recompiled.
+			if (Plan.Struct.Get() != Struct || Plan.LayoutHash != LayoutHash)
+			{
+				StructPlans.RemoveAtSwap(i);
+				--PlanCount;
+				continue;
+			}
+
+			if (Plan.Columns == Columns)
+			{
+				return StructPlans[i];
+			}
+		}
+
+		if (PlanCount >= MaxPlans)
+		{
+			UE_LOG(LogDatabaseConnector, Verbose, TEXT("Row binding plans cache full, resetting it."));
+
+			Plans.Reset();
+			PlanCount = 0;
+		}
+
+		TSharedRef<const FRowBindingPlan, ESPMode::ThreadSafe> Plan = MakeShareable(new FRowBindingPlan(Struct, Columns, LayoutHash));
+
+		Plans.FindOrAdd(Struct).Add(Plan);
+		++PlanCount;
+
+		return Plan;
+	}
+
+private:
+	FCriticalSection Section;
+
+	TMap<const UScriptStruct*, TArray<TSharedRef<const FRowBindingPlan, ESPMode::ThreadSafe>>> Plans;
+
+	int32 PlanCount = 0;
+};
+
+/**
+ * Gets how a property is written.
+ * @return If cells can be written to this property.
+*/
+static bool GetPropertyKind(const FProperty* Property, ERowPropertyKind& OutKind, const FNumericProperty*& OutNumeric)
+{
+	OutNumeric = nullptr;
+
+	if (CastField<FBoolProperty>(Property))
+	{
+		OutKind = ERowPropertyKind::Boolean;
+		return true;
+	}
+
+	if (const FEnumProperty* const EnumProperty = CastField<FEnumProperty>(Property))
+	{
+		OutKind	   = ERowPropertyKind::Integer;
+		OutNumeric = EnumProperty->GetUnderlyingProperty();
+		return OutNumeric != nullptr;
+	}
+
+	if (const FNumericProperty* const NumericProperty = CastField<FNumericProperty>(Property))
+	{
+		OutKind	   = NumericProperty->IsFloatingPoint() ? ERowPropertyKind::Float : ERowPropertyKind::Integer;
+		OutNumeric = NumericProperty;
+		return true;
+	}
+
+	if (CastField<FStrProperty>(Property))
+	{
+		OutKind = ERowPropertyKind::String;
+		return true;
+	}
+
+	if (CastField<FNameProperty>(Property))
+	{
+		OutKind = ERowPropertyKind::Name;
+		return true;
+	}
+
+	if (CastField<FTextProperty>(Property))
+	{
+		OutKind = ERowPropertyKind::Text;
+		return true;
+	}
+
+	if (const FStructProperty* const StructProperty = CastField<FStructProperty>(Property))
+	{
+		const UScriptStruct* const Struct = StructProperty->Struct;
+
+		if (Struct == FDatabaseTimestamp::StaticStruct())
+		{
+			OutKind = ERowPropertyKind::Timestamp;
+			return true;
+		}
+
+		if (Struct == FDatabaseDate::StaticStruct())
+		{
+			OutKind = ERowPropertyKind::Date;
+			return true;
+		}
+
+		if (Struct == TBaseStructure<FDateTime>::Get())
+		{
+			OutKind = ERowPropertyKind::DateTime;
+			return true;
+		}
+
+		if (Struct == FDatabaseValue::StaticStruct())
+		{
+			OutKind = ERowPropertyKind::Value;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+/**
+ * @return If the cells of a column can be written to a property of this kind.
+*/
+static bool CanWrite(const EQueryColumnStorage Storage, const ERowPropertyKind Kind)
+{
+	if (Kind == ERowPropertyKind::Value)
+	{
+		return true;
+	}
+
+	switch (Storage)
+	{
+	case EQueryColumnStorage::Integer:
+	case EQueryColumnStorage::Boolean:
+		return Kind == ERowPropertyKind::Boolean || Kind == ERowPropertyKind::Integer || Kind == ERowPropertyKind::Float
+			|| Kind == ERowPropertyKind::String	 || Kind == ERowPropertyKind::Name	  || Kind == ERowPropertyKind::Text;
+	case EQueryColumnStorage::Double:
+		return Kind == ERowPropertyKind::Integer || Kind == ERowPropertyKind::Float
+			|| Kind == ERowPropertyKind::String	 || Kind == ERowPropertyKind::Text;
+	case EQueryColumnStorage::Timestamp:
+	case EQueryColumnStorage::Date:
+		return Kind == ERowPropertyKind::Timestamp || Kind == ERowPropertyKind::Date || Kind == ERowPropertyKind::DateTime
+			|| Kind == ERowPropertyKind::String	   || Kind == ERowPropertyKind::Text;
+	case EQueryColumnStorage::String:
+		return Kind != ERowPropertyKind::Timestamp && Kind != ERowPropertyKind::Date && Kind != ERowPropertyKind::DateTime;
+	case EQueryColumnStorage::Variant:
+		// Checked per cell.
+		return true;
+	}
+
+	return false;
+}
+
+static void WriteString(const FRowPropertyBinding& Binding, void* Dest, FString&& Value)
+{
+	switch (Binding.Kind)
+	{
+	case ERowPropertyKind::String:	*(FString*)Dest = MoveTemp(Value);				break;
+	case ERowPropertyKind::Name:	*(FName*)  Dest = FName(*Value);				break;
+	case ERowPropertyKind::Text:	*(FText*)  Dest = FText::FromString(MoveTemp(Value)); break;
+	case ERowPropertyKind::Boolean: static_cast<const FBoolProperty*>(Binding.Property)->SetPropertyValue(Dest, Value.ToBool()); break;
+	case ERowPropertyKind::Integer:
+	case ERowPropertyKind::Float:
+		Binding.Numeric->SetNumericPropertyValueFromString(Dest, *Value);
+		break;
+	}
+}
+
+static void WriteInteger(const FRowPropertyBinding& Binding, void* Dest, const int64 Value)
+{
+	switch (Binding.Kind)
+	{
+	case ERowPropertyKind::Boolean: static_cast<const FBoolProperty*>(Binding.Property)->SetPropertyValue(Dest, Value != 0); break;
+	case ERowPropertyKind::Integer: Binding.Numeric->SetIntPropertyValue(Dest, Value);						break;
+	case ERowPropertyKind::Float:	Binding.Numeric->SetFloatingPointPropertyValue(Dest, (double)Value);	break;
+	case ERowPropertyKind::String:
+	case ERowPropertyKind::Name:
+	case ERowPropertyKind::Text:
+		WriteString(Binding, Dest, LexToString(Value));
+		break;
+	}
+}
+
+static void WriteBoolean(const FRowPropertyBinding& Binding, void* Dest, const bool bValue)
+{
+	switch (Binding.Kind)
+	{
+	case ERowPropertyKind::String:
+	case ERowPropertyKind::Name:
+	case ERowPropertyKind::Text:
+		WriteString(Binding, Dest, bValue ? TEXT("true") : TEXT("false"));
+		break;
+	default:
+		WriteInteger(Binding, Dest, bValue ? 1 : 0);
+	}
+}
+
+static void WriteDouble(const FRowPropertyBinding& Binding, void* Dest, const double Value)
+{
+	switch (Binding.Kind)
+	{
+	case ERowPropertyKind::Integer: Binding.Numeric->SetIntPropertyValue(Dest, (int64)Value);		break;
+	case ERowPropertyKind::Float:	Binding.Numeric->SetFloatingPointPropertyValue(Dest, Value);	break;
+	case ERowPropertyKind::String:
+	case ERowPropertyKind::Text:
+		WriteString(Binding, Dest, LexToString(Value));
+		break;
+	}
+}
+
+static void WriteTimestamp(const FRowPropertyBinding& Binding, void* Dest, const FDatabaseTimestamp& Value)
+{
+	switch (Binding.Kind)
+	{
+	case ERowPropertyKind::Timestamp: 
+		*(FDatabaseTimestamp*)Dest = Value;
+		break;
+	case ERowPropertyKind::Date:
+	{
+		FDatabaseDate& Date = *(FDatabaseDate*)Dest;
+
+		Date.Year	= Value.Year;
+		Date.Month	= Value.Month;
+		Date.Day	= Value.Day;
+		break;
+	}
+	case ERowPropertyKind::DateTime:
+		// Sub-second precision depends on the driver, it is dropped.
+		if (FDateTime::Validate(Value.Year, Value.Month, Value.Day, Value.Hour, Value.Minute, Value.Second, 0))
+		{
+			*(FDateTime*)Dest = FDateTime(Value.Year, Value.Month, Value.Day, Value.Hour, Value.Minute, Value.Second);
+		}
+		break;
+	case ERowPropertyKind::String:
+	case ERowPropertyKind::Text:
+		WriteString(Binding, Dest, FDatabaseValue(Value).ToString(false));
+		break;
+	}
+}
+
+static void WriteDate(const FRowPropertyBinding& Binding, void* Dest, const FDatabaseDate& Value)
+{
+	switch (Binding.Kind)
+	{
+	case ERowPropertyKind::Date:
+		*(FDatabaseDate*)Dest = Value;
+		break;
+	case ERowPropertyKind::Timestamp:
+	{
+		FDatabaseTimestamp Timestamp;
+
+		FMemory::Memzero(Timestamp);
+
+		Timestamp.Year	= Value.Year;
+		Timestamp.Month = Value.Month;
+		Timestamp.Day	= Value.Day;
+
+		*(FDatabaseTimestamp*)Dest = Timestamp;
+		break;
+	}
+	case ERowPropertyKind::DateTime:
+		if (FDateTime::Validate(Value.Year, Value.Month, Value.Day, 0, 0, 0, 0))
+		{
+			*(FDateTime*)Dest = FDateTime(Value.Year, Value.Month, Value.Day);
+		}
+		break;
+	case ERowPropertyKind::String:
+	case ERowPropertyKind::Text:
+		WriteString(Binding, Dest, FDatabaseValue(Value).ToString(false));
+		break;
+	}
+}
+
+/**
+ * Writes a cell of a column mixing several types. These cells are already boxed.
+*/
+static void WriteValue(const FRowPropertyBinding& Binding, void* Dest, const FDatabaseValue& Value)
+{
+	switch (Value.GetType())
+	{
+	case EDatabaseValueType::Boolean:	WriteBoolean  (Binding, Dest, Value.ToInt32() != 0);	break;
+	case EDatabaseValueType::Uint8:
+	case EDatabaseValueType::Int32:
+	case EDatabaseValueType::Int64:		WriteInteger  (Binding, Dest, Value.ToInt64());			break;
+	case EDatabaseValueType::Double:	WriteDouble	  (Binding, Dest, Value.ToDouble());		break;
+	case EDatabaseValueType::Timestamp: WriteTimestamp(Binding, Dest, Value.ToTimestamp());		break;
+	case EDatabaseValueType::Date:		WriteDate	  (Binding, Dest, Value.ToDate());			break;
+	case EDatabaseValueType::String:
+		if (Binding.Kind != ERowPropertyKind::Timestamp && Binding.Kind != ERowPropertyKind::Date && Binding.Kind != ERowPropertyKind::DateTime)
+		{
+			WriteString(Binding, Dest, Value.ToString(false));
+		}
+		break;
+	}
+}
+
+TSharedRef<const FRowBindingPlan, ESPMode::ThreadSafe> FRowBindingPlan::Get(const UScriptStruct* Struct, const TArray<FString>& Columns)
+{
+	return FRowBindingPlanCache::Get().Find(Struct, Columns);
+}
+
+FRowBindingPlan::FRowBindingPlan(const UScriptStruct* InStruct, const TArray<FString>& InColumns, const uint32 InLayoutHash)
+	: Struct(InStruct)
+	, Columns(InColumns)
+	, LayoutHash(InLayoutHash)
+	, Stride(InStruct->GetStructureSize())
+{
+	for (TFieldIterator<FProperty> It(InStruct); It; ++It)
+	{
+		const FProperty* const Property = *It;
+
+		// Blueprint structures decorate the names of their properties.
+		const int32 ColumnIndex = Columns.IndexOfByKey(Property->GetAuthoredName());
+
+		if (ColumnIndex == INDEX_NONE)
+		{
+			continue;
+		}
+
+		FRowPropertyBinding Binding;
+
+		Binding.ColumnIndex = ColumnIndex;
+		Binding.Property	= Property;
+		Binding.Offset		= Property->GetOffset_ForInternal();
+
+		if (!GetPropertyKind(Property, Binding.Kind, Binding.Numeric))
+		{
+			UE_LOG(LogDatabaseConnector, Warning, TEXT("Column `%s` can't be read into property `%s` of `%s`: unsupported type `%s`."),
+				*Columns[ColumnIndex], *Property->GetAuthoredName(), *InStruct->GetName(), *Property->GetCPPType());
+			continue;
+		}
+
+		Bindings.Add(Binding);
+	}
+
+	if (Bindings.Num() <= 0 && Columns.Num() > 0)
+	{
+		UE_LOG(LogDatabaseConnector, Warning, TEXT("No column of the result matches a property of `%s`."), *InStruct->GetName());
+	}
+}
+
+void FRowBindingPlan::Read(const FQueryResultInternal& Result, void* Rows, const int64 FirstRow, const int64 RowCount) const
+{
+	uint8* const FirstStruct = (uint8*)Rows;
+
+	// Column by column so each typed array is read sequentially.
+	for (const FRowPropertyBinding& Binding : Bindings)
+	{
+		if (!Result.Columns.IsValidIndex(Binding.ColumnIndex))
+		{
+			continue;
+		}
+
+		const FQueryResultColumn& Column = Result.Columns[Binding.ColumnIndex];
+
+		if (Column.Storage == EQueryColumnStorage::None && Binding.Kind != ERowPropertyKind::Value)
+		{
+			continue;
+		}
+
+		if (!CanWrite(Column.Storage, Binding.Kind))
+		{
+			UE_LOG(LogDatabaseConnector, Warning, TEXT("Column `%s` of type %s can't be read into property `%s`."),
+				*Columns[Binding.ColumnIndex], *UEnum::GetValueAsString(Column.Type), *Binding.Property->GetAuthoredName());
+			continue;
+		}
+
+		for (int64 i = 0; i < RowCount; ++i)
+		{
+			const int64 Row	 = FirstRow + i;
+			void* const Dest = FirstStruct + i * Stride + Binding.Offset;
+
+			if (Binding.Kind == ERowPropertyKind::Value)
+			{
+				*(FDatabaseValue*)Dest = Column.GetValue(Row);
+				continue;
+			}
+
+			if (Column.IsNull(Row))
+			{
+				continue;
+			}
+
+			switch (Column.Storage)
+			{
+			case EQueryColumnStorage::Integer:		WriteInteger  (Binding, Dest, Column.Integers  [Row]); break;
+			case EQueryColumnStorage::Double:		WriteDouble	  (Binding, Dest, Column.Doubles   [Row]); break;
+			case EQueryColumnStorage::Boolean:		WriteBoolean  (Binding, Dest, Column.Booleans  [Row]); break;
+			case EQueryColumnStorage::Timestamp:	WriteTimestamp(Binding, Dest, Column.Timestamps[Row]); break;
+			case EQueryColumnStorage::Date:			WriteDate	  (Binding, Dest, Column.Dates	   [Row]); break;
+			case EQueryColumnStorage::Variant:		WriteValue	  (Binding, Dest, Column.Variants  [Row]); break;
+			case EQueryColumnStorage::String:
+			{
+				const FQueryStringSpan& Span = Column.Strings[Row];
+				const TCHAR* const Data = Column.Characters.GetData() + Span.Offset;
+
+				if (Binding.Kind == ERowPropertyKind::String)
+				{
+					// Reuses the allocation of the previous value if any.
+					FString& String = *(FString*)Dest;
+
+					String.Reset(Span.Length);
+					String.AppendChars(Data, Span.Length);
+				}
+				else
+				{
+					WriteString(Binding, Dest, FString(Span.Length, Data));
+				}
+				break;
+			}
+			}
+		}
+	}
+}
@@ -0,0 +1,91 @@
+// Copyright Pandores Marketplace 2021. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/WeakObjectPtr.h"
+
+struct FQueryResultInternal;
+class UScriptStruct;
+class FProperty;
+class FNumericProperty;
+
+/**
+ * How a cell is written to a property.
+*/
+enum class ERowPropertyKind : uint8
+{
+	Boolean,
+	/* Integers and enums, through their underlying numeric property. */
+	Integer,
+	Float,
+	String,
+	Name,
+	Text,
+	Timestamp,
+	Date,
+	DateTime,
+	/* FDatabaseValue properties receive the boxed cell. */
+	Value
+};
+
+/**
+ * Where a column is written in a structure.
+*/
+struct FRowPropertyBinding
+{
+	int32 ColumnIndex;
+
+	ERowPropertyKind Kind;
+
+	const FProperty* Property;
+
+	/* Set for integer and float kinds. */
+	const FNumericProperty* Numeric;
+
+	int32 Offset;
+};
+
+/**
+ * The bindings of the columns of a result to the properties of a structure.
+ * Built once per structure and set of columns, then shared by all the results with these columns.
+*/
+class FRowBindingPlan
+{
+public:
+	/**
+	 * Gets the plan binding these columns to this structure, built on first use.
+	 * Thread-safe.
+	*/
+	static TSharedRef<const FRowBindingPlan, ESPMode::ThreadSafe> Get(const UScriptStruct* Struct, const TArray<FString>& Columns);
+
+	/**
+	 * Writes rows of a result to contiguous structures.
+	 * NULL cells and columns without property leave the structures untouched.
+	 * @param Rows		The first structure, followed by the others.
+	 * @param FirstRow	The first row to read.
+	 * @param RowCount	The number of rows to read. They must exist.
+	*/
+	void Read(const FQueryResultInternal& Result, void* Rows, const int64 FirstRow, const int64 RowCount) const;
+
+private:
+	FRowBindingPlan(const UScriptStruct* Struct, const TArray<FString>& Columns, const uint32 LayoutHash);
+
+private:
+	TWeakObjectPtr<const UScriptStruct> Struct;
+
+	TArray<FString> Columns;
+
+	/**
+	 * The properties of the structure when the plan was built.
+	 * Recompiled structures keep their address but replace their properties.
+	*/
+	uint32 LayoutHash;
+
+	int32 Stride;
+
+	TArray<FRowPropertyBinding> Bindings;
+
+private:
+	friend class FRowBindingPlanCache;
+};
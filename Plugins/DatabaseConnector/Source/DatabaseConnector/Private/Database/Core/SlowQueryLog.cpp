@@ -0,0 +1,129 @@
+// Copyright Pandores Marketplace 2021. All Rights Reserved.
+
+#include "SlowQueryLog.h"
+#include "Misc/ScopeLock.h"
+
+#include "DatabaseConnectorModule.h"
+
+FDatabaseSlowQueryLog::FDatabaseSlowQueryLog()
+	: Threshold(0.)
+	, WindowStart(0.)
+	, WindowEntries(0)
+	, SuppressedEntries(0)
+{
+}
+
+void FDatabaseSlowQueryLog::Configure(const FDatabaseSlowQuerySettings& InSettings)
+{
+	Settings  = InSettings;
+	Threshold = Settings.Threshold / 1000.;
+}
+
+bool FDatabaseSlowQueryLog::IsEnabled() const
+{
+	return Threshold > 0.;
+}
+
+void FDatabaseSlowQueryLog::Report(const FString& Sql, const TArray<FDatabaseValue>& Parameters, const FName Label, const FDatabaseQueryTimings& Timings, const EDatabaseError Error)
+{
+	const double Total = Timings.GetTotal();
+
+	if (!IsEnabled() || Total < Threshold)
+	{
+		return;
+	}
+
+	int32 Suppressed;
+
+	if (!TryAcquireEntry(Suppressed))
+	{
+		return;
+	}
+
+	FString Entry = FString::Printf(TEXT("%s took %.1f ms (queue %.1f ms, acquire %.1f ms, execute %.1f ms, fetch %.1f ms), %lld rows, %s."),
+		Label.IsNone() ? TEXT("Query") : *Label.ToString(), Total * 1000., Timings.QueueWait * 1000., Timings.AcquireWait * 1000.,
+		Timings.Execute * 1000., Timings.Fetch * 1000., Timings.RowCount, *UEnum::GetValueAsString(Error));
+
+	Entry += FString::Printf(TEXT("\n\tSQL: %s"), *Sql);
+
+	if (Settings.bLogParameters && Parameters.Num() > 0)
+	{
+		Entry += FString::Printf(TEXT("\n\tParameters: %s"), *FormatParameters(Sql, Parameters));
+	}
+
+	if (Suppressed > 0)
+	{
+		Entry += FString::Printf(TEXT("\n\t%d slow queries were not logged over the last minute."), Suppressed);
+	}
+
+	UE_LOG(LogDatabaseSlowQuery, Warning, TEXT("%s"), *Entry);
+}
+
+bool FDatabaseSlowQueryLog::TryAcquireEntry(int32& OutSuppressed)
+{
+	const double Now = FPlatformTime::Seconds();
+
+	FScopeLock Lock(&Section);
+
+	if (Now - WindowStart >= WindowSeconds)
+	{
+		WindowStart	  = Now;
+		WindowEntries = 0;
+	}
+
+	if (WindowEntries >= Settings.MaxEntriesPerMinute)
+	{
+		++SuppressedEntries;
+		return false;
+	}
+
+	++WindowEntries;
+
+	OutSuppressed	  = SuppressedEntries;
+	SuppressedEntries = 0;
+
+	return true;
+}
+
+FString FDatabaseSlowQueryLog::FormatParameters(const FString& Sql, const TArray<FDatabaseValue>& Parameters) const
+{
+	const bool bRedactAll = Settings.RedactedKeywords.ContainsByPredicate([&Sql](const FString& Keyword) -> bool
+	{
+		return !Keyword.IsEmpty() && Sql.Contains(Keyword, ESearchCase::IgnoreCase);
+	});
+
+	FString Formatted = TEXT("[");
+
+	for (int32 i = 0; i < Parameters.Num(); ++i)
+	{
+		const FDatabaseValue& Parameter = Parameters[i];
+
+		if (i > 0)
+		{
+			Formatted += TEXT(", ");
+		}
+
+		if (Parameter.IsNull())
+		{
+			Formatted += TEXT("NULL");
+		}
+		else if (bRedactAll || (Settings.bRedactStrings && Parameter.GetType() == EDatabaseValueType::String))
+		{
+			Formatted += TEXT("<redacted>");
+		}
+		else if (Parameter.GetType() == EDatabaseValueType::String)
+		{
+			const FString String = Parameter.ToString(false);
+
+			Formatted += FString::Printf(TEXT("'%s%s'"), *String.Left(MaxParameterLength), String.Len() > MaxParameterLength ? TEXT("...") : TEXT(""));
+		}
+		else
+		{
+			Formatted += Parameter.ToString(false);
+		}
+	}
+
+	Formatted += TEXT("]");
+
+	return Formatted;
+}
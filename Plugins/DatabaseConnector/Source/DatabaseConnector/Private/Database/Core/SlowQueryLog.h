@@ -0,0 +1,88 @@
+// Copyright Pandores Marketplace 2021. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Database/Value.h"
+#include "Database/Errors.h"
+#include "Database/PoolSettings.h"
+
+/**
+ * Where the time of a query was spent, in seconds.
+*/
+struct FDatabaseQueryTimings
+{
+	double QueueWait	= 0.;
+	double AcquireWait	= 0.;
+	double Execute		= 0.;
+	double Fetch		= 0.;
+
+	int64 RowCount = 0;
+
+	double GetTotal() const
+	{
+		return QueueWait + AcquireWait + Execute + Fetch;
+	}
+};
+
+/**
+ * Writes the queries of a pool slower than its threshold to LogDatabaseSlowQuery.
+ * Entries are rate-limited so a struggling database doesn't flood the log.
+*/
+class FDatabaseSlowQueryLog
+{
+private:
+	static constexpr double WindowSeconds = 60.;
+
+	/**
+	 * The maximum number of characters written for a string parameter.
+	*/
+	static constexpr int32 MaxParameterLength = 64;
+
+public:
+	FDatabaseSlowQueryLog();
+
+	FDatabaseSlowQueryLog(const FDatabaseSlowQueryLog&) = delete;
+	FDatabaseSlowQueryLog& operator=(const FDatabaseSlowQueryLog&) = delete;
+
+	/**
+	 * Must be called before queries are reported.
+	*/
+	void Configure(const FDatabaseSlowQuerySettings& InSettings);
+
+	bool IsEnabled() const;
+
+	/**
+	 * Logs the query if it was slower than the threshold.
+	 * @param Label Identifies the call site, can be none.
+	*/
+	void Report(const FString& Sql, const TArray<FDatabaseValue>& Parameters, const FName Label, const FDatabaseQueryTimings& Timings, const EDatabaseError Error);
+
+private:
+	/**
+	 * Takes a place in the current window.
+	 * @param OutSuppressed The number of entries dropped since the last one logged.
+	*/
+	bool TryAcquireEntry(int32& OutSuppressed);
+
+	FString FormatParameters(const FString& Sql, const TArray<FDatabaseValue>& Parameters) const;
+
+private:
+	FDatabaseSlowQuerySettings Settings;
+
+	/**
+	 * The threshold, in seconds.
+	*/
+	double Threshold;
+
+	/**
+	 * Protects the rate limiting.
+	*/
+	FCriticalSection Section;
+
+	double WindowStart;
+
+	int32 WindowEntries;
+
+	int32 SuppressedEntries;
+};
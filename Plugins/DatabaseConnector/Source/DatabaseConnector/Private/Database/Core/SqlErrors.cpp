@@ -11,6 +11,16 @@ EDatabaseError NSqlErrors::ConvertState(const std::string State)
 		return EDatabaseError::ConnectionClosed;
 	}
 
+	if (State == SQL_ERROR_TIMEOUT_EXPIRED)
+	{
+		return EDatabaseError::Timeout;
+	}
+
+	if (State == SQL_ERROR_OPERATION_CANCELED)
+	{
+		return EDatabaseError::Cancelled;
+	}
+
 	UE_LOG(LogDatabaseConnector, Warning, TEXT("Unknown type: %s"), UTF8_TO_TCHAR(State.c_str()));
 
 	return EDatabaseError::QueryFailed;
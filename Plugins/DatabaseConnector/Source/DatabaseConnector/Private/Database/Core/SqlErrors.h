@@ -8,6 +8,8 @@
 
 /* SQL error codes */
 #define SQL_ERROR_CONNECTION_NOT_OPEN		"0800"
+#define SQL_ERROR_TIMEOUT_EXPIRED			"HYT00"
+#define SQL_ERROR_OPERATION_CANCELED		"HY008"
 
 namespace NSqlErrors
 {
@@ -0,0 +1,82 @@
+// Copyright Pandores Marketplace 2021. All Rights Reserved.
+
+#include "StatementCache.h"
+
+FPreparedStatementCache::FPreparedStatementCache(const int32 InCapacity)
+	: UseCounter(0)
+	, Capacity(FMath::Max(InCapacity, 0))
+{
+	Entries.Reserve(Capacity);
+}
+
+FPreparedStatement* FPreparedStatementCache::Find(const FString& Sql)
+{
+	FEntry* const Entry = Entries.Find(Sql);
+
+	if (!Entry)
+	{
+		return nullptr;
+	}
+
+	Entry->LastUsed = ++UseCounter;
+
+	return &Entry->Prepared;
+}
+
+FPreparedStatement* FPreparedStatementCache::Add(const FString& Sql, const nanodbc::statement& Statement)
+{
+	if (Capacity <= 0)
+	{
+		return nullptr;
+	}
+
+	if (!Entries.Contains(Sql) && Entries.Num() >= Capacity)
+	{
+		EvictLeastRecentlyUsed();
+	}
+
+	FEntry& Entry = Entries.Add(Sql);
+
+	Entry.Prepared = FPreparedStatement{ Statement };
+	Entry.LastUsed = ++UseCounter;
+
+	return &Entry.Prepared;
+}
+
+void FPreparedStatementCache::Remove(const FString& Sql)
+{
+	Entries.Remove(Sql);
+}
+
+void FPreparedStatementCache::Empty()
+{
+	Entries.Empty(Capacity);
+}
+
+int32 FPreparedStatementCache::Num() const
+{
+	return Entries.Num();
+}
+
+void FPreparedStatementCache::EvictLeastRecentlyUsed()
+{
+	// The cache is small, a linear scan on eviction
+	// is cheaper than maintaining a linked list on each hit.
+	const FString* Oldest		 = nullptr;
+	uint64		   OldestLastUse = MAX_uint64;
+
+	for (const TPair<FString, FEntry>& Pair : Entries)
+	{
+		if (Pair.Value.LastUsed < OldestLastUse)
+		{
+			OldestLastUse	= Pair.Value.LastUsed;
+			Oldest			= &Pair.Key;
+		}
+	}
+
+	if (Oldest)
+	{
+		// Copy the key as removing invalidates the pointer.
+		Entries.Remove(FString(*Oldest));
+	}
+}
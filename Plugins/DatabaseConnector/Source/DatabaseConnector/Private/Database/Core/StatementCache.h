@@ -0,0 +1,130 @@
+// Copyright Pandores Marketplace 2021. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+#if PLATFORM_WINDOWS
+#	include "Windows/AllowWindowsPlatformTypes.h"
+#endif
+
+THIRD_PARTY_INCLUDES_START
+#	include <nanodbc/nanodbc.h>
+THIRD_PARTY_INCLUDES_END
+
+#if PLATFORM_WINDOWS
+#	include "Windows/HideWindowsPlatformTypes.h"
+#endif // PLATFORM_WINDOWS
+
+struct FResultColumns;
+
+/**
+ * Map key functions comparing FString keys with case sensitivity.
+ * SQL text must not be folded: string literals in two queries may only differ by case.
+*/
+template<typename ValueType>
+struct TCaseSensitiveStringMapKeyFuncs : public TDefaultMapKeyFuncs<FString, ValueType, false>
+{
+	static FORCEINLINE bool Matches(const FString& A, const FString& B)
+	{
+		return A.Equals(B, ESearchCase::CaseSensitive);
+	}
+
+	static FORCEINLINE uint32 GetKeyHash(const FString& Key)
+	{
+		return FCrc::StrCrc32(*Key);
+	}
+};
+
+/**
+ * A statement prepared on a connection, with what we learnt from its previous executions.
+*/
+struct FPreparedStatement
+{
+	nanodbc::statement Statement;
+
+	/**
+	 * The number of rows the last execution returned.
+	*/
+	int64 LastRowCount = 0;
+
+	/**
+	 * If the result set can be fetched by rowsets of several rows.
+	 * Unknown before the first execution, and false if a column
+	 * can't be bound (e.g. long data fetched with SQLGetData).
+	*/
+	bool bSupportsRowsets = false;
+
+	/**
+	 * The columns of the result, described by the first execution so
+	 * their names and types aren't read and converted again at each execution.
+	*/
+	TSharedPtr<const FResultColumns> Columns;
+};
+
+/**
+ * A least recently used cache of prepared statements, keyed by their SQL text.
+ * Owned by a single connection and only used by the thread holding it.
+*/
+class FPreparedStatementCache
+{
+public:
+	explicit FPreparedStatementCache(const int32 InCapacity);
+
+	FPreparedStatementCache(const FPreparedStatementCache&) = delete;
+	FPreparedStatementCache& operator=(const FPreparedStatementCache&) = delete;
+
+	/**
+	 * Finds the statement prepared for this SQL and marks it as the most recently used.
+	 * The returned pointer is valid until the cache is modified.
+	 * @param Sql The SQL text the statement was prepared with.
+	 * @return The cached statement or nullptr if not found.
+	*/
+	FPreparedStatement* Find(const FString& Sql);
+
+	/**
+	 * Adds a prepared statement, evicting the least recently used one if the cache is full.
+	 * The returned pointer is valid until the cache is modified.
+	 * @param Sql		The SQL text the statement was prepared with.
+	 * @param Statement	The prepared statement.
+	 * @return The cached statement or nullptr if the cache is disabled.
+	*/
+	FPreparedStatement* Add(const FString& Sql, const nanodbc::statement& Statement);
+
+	/**
+	 * Removes a statement, typically because it failed and might be in an invalid state.
+	 * @param Sql The SQL text the statement was prepared with.
+	*/
+	void Remove(const FString& Sql);
+
+	/**
+	 * Releases all cached statements.
+	 * Must be called before the underlying connection is closed or re-established.
+	*/
+	void Empty();
+
+	/**
+	 * Gets the number of cached statements.
+	 * @return The number of cached statements.
+	*/
+	int32 Num() const;
+
+private:
+	struct FEntry
+	{
+		FPreparedStatement Prepared;
+		uint64 LastUsed;
+	};
+
+	void EvictLeastRecentlyUsed();
+
+private:
+	TMap<FString, FEntry, FDefaultSetAllocator, TCaseSensitiveStringMapKeyFuncs<FEntry>> Entries;
+
+	/**
+	 * Incremented at each access to order entries by recency.
+	*/
+	uint64 UseCounter;
+
+	const int32 Capacity;
+};
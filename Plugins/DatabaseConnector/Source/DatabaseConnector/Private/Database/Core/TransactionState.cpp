@@ -0,0 +1,109 @@
+// Copyright Pandores Marketplace 2021. All Rights Reserved.
+
+#include "TransactionState.h"
+#include "OdbClient.h"
+#include "Misc/ScopeLock.h"
+
+#include "DatabaseConnectorModule.h"
+
+/**
+ * How long an idle transaction thread sleeps before checking again for work.
+*/
+static constexpr uint32 TransactionWaitIntervalMs = 100;
+
+FDatabaseTransactionState::FDatabaseTransactionState(const double InIdleTimeout)
+	: bFinished(false)
+	, IdleTimeout(InIdleTimeout)
+	, bClosed(false)
+	, WorkQueued(FPlatformProcess::GetSynchEventFromPool(false))
+{
+}
+
+FDatabaseTransactionState::~FDatabaseTransactionState()
+{
+	FPlatformProcess::ReturnSynchEventToPool(WorkQueued);
+}
+
+void FDatabaseTransactionState::Enqueue(FWork&& InWork)
+{
+	{
+		FScopeLock Lock(&Section);
+
+		if (!bClosed)
+		{
+			Work.Enqueue(MoveTemp(InWork));
+			WorkQueued->Trigger();
+			return;
+		}
+	}
+
+	InWork(nullptr);
+}
+
+void FDatabaseTransactionState::Finish()
+{
+	bFinished = true;
+
+	WorkQueued->Trigger();
+}
+
+void FDatabaseTransactionState::Run(FConnection& Connection, const TAtomic<bool>& bPoolDestroyed)
+{
+	FWork Next;
+
+	double LastWorkTime = FPlatformTime::Seconds();
+
+	for (;;)
+	{
+		if (Work.Dequeue(Next))
+		{
+			Next(&Connection);
+			Next.Reset();
+
+			LastWorkTime = FPlatformTime::Seconds();
+		}
+		else if (bFinished || bPoolDestroyed || IsEngineExitRequested())
+		{
+			break;
+		}
+		else if (IdleTimeout > 0. && FPlatformTime::Seconds() - LastWorkTime >= IdleTimeout)
+		{
+			// The owner likely dropped the transaction, it would keep its locks until garbage collected.
+			FScopeLock Lock(&Section);
+
+			if (Work.IsEmpty())
+			{
+				UE_LOG(LogDatabaseConnector, Warning, TEXT("Transaction idle for %.0f seconds."), IdleTimeout);
+
+				bClosed = true;
+				break;
+			}
+		}
+		else
+		{
+			WorkQueued->Wait(TransactionWaitIntervalMs);
+		}
+	}
+
+	{
+		FScopeLock Lock(&Section);
+
+		bClosed = true;
+	}
+
+	// Work left when the pool is destroyed or the engine exits.
+	while (Work.Dequeue(Next))
+	{
+		Next(nullptr);
+		Next.Reset();
+	}
+
+	if (Connection.IsInTransaction())
+	{
+		UE_LOG(LogDatabaseConnector, Warning, TEXT("Transaction ended without being committed. Rolling back."));
+
+		EDatabaseError Error;
+
+		Connection.EndTransaction(false, Error);
+	}
+}
@@ -0,0 +1,69 @@
+// Copyright Pandores Marketplace 2021. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Containers/Queue.h"
+#include "HAL/Event.h"
+
+class FConnection;
+
+/**
+ * Shared between a transaction object on the Game Thread and the pool thread holding its connection.
+*/
+struct FDatabaseTransactionState
+{
+public:
+	/**
+	 * Called with the transaction's connection, or null if the transaction was rolled back before the work could run.
+	*/
+	using FWork = TUniqueFunction<void(FConnection*)>;
+
+public:
+	/**
+	 * @param IdleTimeout Seconds the transaction waits for work before it is rolled back. 0 to wait indefinitely.
+	*/
+	FDatabaseTransactionState(const double IdleTimeout);
+	~FDatabaseTransactionState();
+
+	/**
+	 * Queues work to run on the transaction's connection, after the work already queued.
+	 * If the transaction was already rolled back, the work is called right away without connection.
+	*/
+	void Enqueue(FWork&& Work);
+
+	/**
+	 * Stops the transaction's thread once the queued work has run.
+	*/
+	void Finish();
+
+	/**
+	 * Runs the queued work on the connection until the transaction is finished, idle for too long or its pool destroyed.
+	 * The transaction is rolled back if it wasn't committed.
+	 * Blocks the calling pool thread for the lifetime of the transaction.
+	 * @param bPoolDestroyed Set when the pool waits for its threads to exit.
+	*/
+	void Run(FConnection& Connection, const TAtomic<bool>& bPoolDestroyed);
+
+private:
+	TQueue<FWork, EQueueMode::Mpsc> Work;
+
+	TAtomic<bool> bFinished;
+
+	const double IdleTimeout;
+
+	/**
+	 * Set once Run() stopped running work. Protected by Section.
+	*/
+	bool bClosed;
+
+	/**
+	 * Closes the transaction only while no work is being queued.
+	*/
+	FCriticalSection Section;
+
+	/**
+	 * Triggered when work is queued or the transaction is finished.
+	*/
+	FEvent* const WorkQueued;
+};
@@ -2,6 +2,8 @@
 
 #include "DatabaseNodes.h"
 
+#include "DatabaseConnectorModule.h"
+
 FDatabaseValue UDatabaseConnectorBlueprintLibrary::GetByColumnName(const FQueryResult& QueryResult, const FString& Column, int64 RowIndex)
 {
 	return QueryResult.Get(Column, RowIndex);
@@ -12,6 +14,16 @@ FDatabaseValue UDatabaseConnectorBlueprintLibrary::GetByColumnIndex(UPARAM(ref)
 	return QueryResult.Get(ColumnIndex, RowIndex);
 }
 
+FQueryColumnHandle UDatabaseConnectorBlueprintLibrary::GetColumnHandle(const FQueryResult& QueryResult, const FString& ColumnName)
+{
+	return QueryResult.GetColumnHandle(ColumnName);
+}
+
+FDatabaseValue UDatabaseConnectorBlueprintLibrary::GetByColumnHandle(const FQueryResult& QueryResult, const FQueryColumnHandle& Column, int64 RowIndex)
+{
+	return QueryResult.Get(Column, RowIndex);
+}
+
 TArray<FString> UDatabaseConnectorBlueprintLibrary::GetColumns(UPARAM(ref) const FQueryResult& QueryResult)
 {
 	return QueryResult.GetColumns();
@@ -29,11 +41,99 @@ int64 UDatabaseConnectorBlueprintLibrary::GetRowCount(UPARAM(ref) const FQueryRe
 
 TArray<FDatabaseValue> UDatabaseConnectorBlueprintLibrary::GetRow(UPARAM(ref) const FQueryResult& QueryResult, const int64 RowIndex)
 {
-	using FValueArray = TArray<FDatabaseValue>;
+	TArray<FDatabaseValue> Row;
+
+	QueryResult.GetRow(RowIndex, Row);
+
+	return Row;
+}
+
+bool UDatabaseConnectorBlueprintLibrary::ReadRows(const FQueryResult& QueryResult, TArray<int32>& OutRows)
+{
+	// Custom thunk.
+	check(0);
+	return false;
+}
+
+DEFINE_FUNCTION(UDatabaseConnectorBlueprintLibrary::execReadRows)
+{
+	P_GET_STRUCT_REF(FQueryResult, QueryResult);
+
+	Stack.MostRecentProperty = nullptr;
+	Stack.StepCompiledIn<FArrayProperty>(nullptr);
+
+	void* const ArrayAddress = Stack.MostRecentPropertyAddress;
+	const FArrayProperty* const ArrayProperty = CastField<FArrayProperty>(Stack.MostRecentProperty);
+
+	P_FINISH;
+
+	P_NATIVE_BEGIN;
+
+	const FStructProperty* const StructProperty = ArrayProperty ? CastField<FStructProperty>(ArrayProperty->Inner) : nullptr;
+
+	if (!StructProperty || !ArrayAddress)
+	{
+		UE_LOG(LogDatabaseConnector, Error, TEXT("Read Rows expects an array of structures."));
+
+		*(bool*)RESULT_PARAM = false;
+	}
+	else
+	{
+		const int64 RowCount = QueryResult.GetRowCount();
+
+		FScriptArrayHelper Rows(ArrayProperty, ArrayAddress);
+
+		if (RowCount > MAX_int32)
+		{
+			Rows.EmptyValues();
+
+			*(bool*)RESULT_PARAM = false;
+		}
+		else
+		{
+			Rows.EmptyAndAddValues((int32)RowCount);
+
+			*(bool*)RESULT_PARAM = QueryResult.ReadRows(StructProperty->Struct, RowCount > 0 ? Rows.GetRawPtr(0) : nullptr, 0, RowCount);
+		}
+	}
+
+	P_NATIVE_END;
+}
+
+bool UDatabaseConnectorBlueprintLibrary::ReadRow(const FQueryResult& QueryResult, const int64 RowIndex, int32& OutRow)
+{
+	// Custom thunk.
+	check(0);
+	return false;
+}
+
+DEFINE_FUNCTION(UDatabaseConnectorBlueprintLibrary::execReadRow)
+{
+	P_GET_STRUCT_REF(FQueryResult, QueryResult);
+	P_GET_PROPERTY(FInt64Property, RowIndex);
+
+	Stack.MostRecentProperty = nullptr;
+	Stack.StepCompiledIn<FStructProperty>(nullptr);
+
+	void* const RowAddress = Stack.MostRecentPropertyAddress;
+	const FStructProperty* const StructProperty = CastField<FStructProperty>(Stack.MostRecentProperty);
+
+	P_FINISH;
+
+	P_NATIVE_BEGIN;
+
+	if (!StructProperty || !RowAddress)
+	{
+		UE_LOG(LogDatabaseConnector, Error, TEXT("Read Row expects a structure."));
 
-	const FValueArray* const Row = QueryResult.GetRow(RowIndex);
+		*(bool*)RESULT_PARAM = false;
+	}
+	else
+	{
+		*(bool*)RESULT_PARAM = QueryResult.ReadRows(StructProperty->Struct, RowAddress, RowIndex, 1);
+	}
 
-	return Row ? *Row : FValueArray();
+	P_NATIVE_END;
 }
 
 TArray<FColumnMetadata> UDatabaseConnectorBlueprintLibrary::GetColumnsMetadata(const FQueryResult& QueryResult)
@@ -100,13 +200,14 @@ void UCreatePoolProxy::OnTaskFinished(EDatabaseError Error, UDatabasePool* Pool)
 }
 
 
-UQueryPoolProxy* UQueryPoolProxy::Query(UDatabasePool* Pool, const FString& Query, TArray<FDatabaseValue> Parameters)
+UQueryPoolProxy* UQueryPoolProxy::Query(UDatabasePool* Pool, const FString& Query, TArray<FDatabaseValue> Parameters, const FDatabaseQueryOptions& Options)
 {
 	ThisClass* const Proxy = NewObject<ThisClass>();
 
 	Proxy->Pool			= Pool;
 	Proxy->QueryStr		= Query;
 	Proxy->Parameters	= MoveTemp(Parameters);
+	Proxy->Options		= Options;
 
 	return Proxy;
 }
@@ -119,7 +220,20 @@ void UQueryPoolProxy::Activate()
 		return;
 	}
 
-	Pool->Query(MoveTemp(QueryStr), MoveTemp(Parameters), FDatabaseQueryCallback::CreateUObject(this, &UQueryPoolProxy::OnTaskOver));
+	Token = Pool->Query(MoveTemp(QueryStr), MoveTemp(Parameters), FDatabaseQueryCallback::CreateUObject(this, &UQueryPoolProxy::OnTaskOver), Options);
+}
+
+void UQueryPoolProxy::Cancel()
+{
+	Token.Cancel();
+}
+
+void UQueryPoolProxy::BeginDestroy()
+{
+	// Nobody is left to receive the result.
+	Token.Abandon();
+
+	Super::BeginDestroy();
 }
 
 void UQueryPoolProxy::OnTaskOver(EDatabaseError Error, const FQueryResult& Result)
@@ -128,6 +242,63 @@ void UQueryPoolProxy::OnTaskOver(EDatabaseError Error, const FQueryResult& Resul
 	SetReadyToDestroy();
 }
 
+UQueryStreamPoolProxy* UQueryStreamPoolProxy::QueryStream(UDatabasePool* Pool, const FString& Query, TArray<FDatabaseValue> Parameters, const FDatabaseQueryOptions& Options, const int32 ChunkSize)
+{
+	ThisClass* const Proxy = NewObject<ThisClass>();
+
+	Proxy->Pool			= Pool;
+	Proxy->QueryStr		= Query;
+	Proxy->Parameters	= MoveTemp(Parameters);
+	Proxy->ChunkSize	= ChunkSize;
+	Proxy->Options		= Options;
+	Proxy->bStopped		= false;
+
+	return Proxy;
+}
+
+void UQueryStreamPoolProxy::Activate()
+{
+	if (!Pool)
+	{
+		OnChunkReceived(EDatabaseError::FailedToOpenConnection, {}, true);
+		return;
+	}
+
+	Token = Pool->QueryStream(MoveTemp(QueryStr), MoveTemp(Parameters), ChunkSize, 
+		FDatabaseQueryChunkCallback::CreateUObject(this, &UQueryStreamPoolProxy::OnChunkReceived), Options);
+}
+
+void UQueryStreamPoolProxy::Stop()
+{
+	if (!bStopped)
+	{
+		bStopped = true;
+
+		// Interrupts the fetch of the next chunk.
+		Token.Cancel();
+
+		SetReadyToDestroy();
+	}
+}
+
+bool UQueryStreamPoolProxy::OnChunkReceived(EDatabaseError Error, const FQueryResult& Chunk, bool bIsLastChunk)
+{
+	if (bStopped)
+	{
+		return false;
+	}
+
+	(Error == EDatabaseError::None ? OnChunk : Failed).Broadcast(Chunk, bIsLastChunk, Error);
+
+	// Stop() might have been called from the chunk's handler.
+	if (bIsLastChunk || Error != EDatabaseError::None)
+	{
+		Stop();
+	}
+
+	return !bStopped;
+}
+
 UReconnectPoolProxy* UReconnectPoolProxy::Reconnect(UDatabasePool* Pool, const int32 Timeout)
 {
 	ThisClass* const Proxy = NewObject<ThisClass>();
@@ -169,12 +340,14 @@ void UForEachQueryRowProxy::Activate()
 {
 	if (LoopBody.IsBound())
 	{
+		TArray<FDatabaseValue> Row;
+
 		const int64 RowCount = Result.GetRowCount();
 		for (int64 i = 0; i < RowCount; ++i)
 		{
-			const TArray<FDatabaseValue>* const Row = Result.GetRow(i);
+			Result.GetRow(i, Row);
 
-			LoopBody.Broadcast(*Row);
+			LoopBody.Broadcast(Row);
 		}
 	}
 
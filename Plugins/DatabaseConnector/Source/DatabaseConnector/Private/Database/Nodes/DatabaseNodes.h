@@ -56,7 +56,7 @@ public:
 	
 	/**
 	 * Gets a value by column name.
-	 * Access cost is O(ColumnCount) so it is O(1) on a fixed table.
+	 * Columns are found with a case-insensitive hash lookup.
 	 * @param ColumnName The column to get the value from.
 	 * @param RowIndex The row index to get the value from.
 	 * @return The value at the specified location.
@@ -74,6 +74,30 @@ public:
 	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Database|Query")
 	static UPARAM(DisplayName = "Value") FDatabaseValue GetByColumnIndex(UPARAM(ref) const FQueryResult& QueryResult, int32 ColumnIndex, int64 RowIndex);
 
+	/**
+	 * Finds a column once to access it by index in loops, and in other results with the same columns.
+	 * @param ColumnName The name of the column, case-insensitive.
+	 * @return The handle of the column. Invalid if not found.
+	*/
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Database|Query")
+	static UPARAM(DisplayName = "Column") FQueryColumnHandle GetColumnHandle(UPARAM(ref) const FQueryResult& QueryResult, const FString& ColumnName);
+
+	/**
+	 * Gets a value by column handle.
+	 * Access cost is O(1) if the handle was made from a result with the same columns.
+	 * @param Column The column to get the value from.
+	 * @param RowIndex The row index to get the value from.
+	 * @return The value at the specified location.
+	*/
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Database|Query")
+	static UPARAM(DisplayName = "Value") FDatabaseValue GetByColumnHandle(UPARAM(ref) const FQueryResult& QueryResult, const FQueryColumnHandle& Column, int64 RowIndex);
+
+	/**
+	 * @return If the column was found when the handle was made.
+	*/
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Database|Query", Meta = (DisplayName = "Is Valid"))
+	static bool IsColumnHandleValid(const FQueryColumnHandle& Column) { return Column.IsValid(); }
+
 	/**
 	 * Gets the columns.
 	 * @return The columns.
@@ -83,12 +107,33 @@ public:
 
 	/**
 	 * Gets a row.
-	 * Access cost is O(1).
-	 * @return The row or nullptr if invalid index.
+	 * Access cost is O(ColumnCount).
+	 * @return The row or an empty array if invalid index.
 	*/
 	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Database|Query")
 	static UPARAM(DisplayName = "Row") TArray<FDatabaseValue> GetRow(UPARAM(ref) const FQueryResult& QueryResult, const int64 RowIndex);
 
+	/**
+	 * Reads the rows into structures whose properties are named after the columns.
+	 * Cells are written straight to the properties, faster than reading them one by one.
+	 * @param OutRows An array of structures, filled with one structure per row.
+	 * @return If the rows could be read.
+	*/
+	UFUNCTION(BlueprintCallable, CustomThunk, Category = "Database|Query", Meta = (ArrayParm = "OutRows"))
+	static UPARAM(DisplayName = "Success") bool ReadRows(UPARAM(ref) const FQueryResult& QueryResult, TArray<int32>& OutRows);
+	DECLARE_FUNCTION(execReadRows);
+
+	/**
+	 * Reads a row into a structure whose properties are named after the columns.
+	 * NULL cells and columns without property leave the structure untouched.
+	 * @param RowIndex The row to read.
+	 * @param OutRow The structure to write to.
+	 * @return If the row exists.
+	*/
+	UFUNCTION(BlueprintCallable, CustomThunk, Category = "Database|Query", Meta = (CustomStructureParam = "OutRow"))
+	static UPARAM(DisplayName = "Success") bool ReadRow(UPARAM(ref) const FQueryResult& QueryResult, const int64 RowIndex, int32& OutRow);
+	DECLARE_FUNCTION(execReadRow);
+
 	/**
 	 * Dumps the data nicely in the output log.
 	*/
@@ -228,12 +273,21 @@ public:
 	 * Query the database.
 	 * @param Query The query string.
 	 * @param Parameters The query parameters inserted into the query.
+	 * @param Options How the query is executed.
 	*/
-	UFUNCTION(BlueprintCallable, meta = (BlueprintInternalUseOnly = "true", AutoCreateRefTerm = "Parameters"), Category = "Database|Pool")
-	static UQueryPoolProxy* Query(UDatabasePool* Pool, const FString& Query, TArray<FDatabaseValue> Parameters);
+	UFUNCTION(BlueprintCallable, meta = (BlueprintInternalUseOnly = "true", AutoCreateRefTerm = "Parameters,Options"), Category = "Database|Pool")
+	static UQueryPoolProxy* Query(UDatabasePool* Pool, const FString& Query, TArray<FDatabaseValue> Parameters, const FDatabaseQueryOptions& Options);
 
 	virtual void Activate();
 
+	/**
+	 * Cancels the query. Failed is fired with the Cancelled error.
+	*/
+	UFUNCTION(BlueprintCallable, Category = "Database|Pool")
+	void Cancel();
+
+	virtual void BeginDestroy() override;
+
 private:
 	UFUNCTION()
 	void OnTaskOver(EDatabaseError Error, const FQueryResult& Result);
@@ -244,6 +298,61 @@ private:
 
 	FString QueryStr;
 	TArray<FDatabaseValue> Parameters;
+	FDatabaseQueryOptions Options;
+
+	FDatabaseCancellationToken Token;
+};
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_ThreeParams(FPoolQueryChunkDynMultCallback, const FQueryResult&, Chunk, bool, bIsLastChunk, EDatabaseError, Error);
+
+UCLASS()
+class UQueryStreamPoolProxy final : public UBlueprintAsyncActionBase
+{
+	GENERATED_BODY()
+public:
+	/**
+	 * Fired for each chunk of rows, on the Game Thread.
+	*/
+	UPROPERTY(BlueprintAssignable)
+	FPoolQueryChunkDynMultCallback OnChunk;
+
+	UPROPERTY(BlueprintAssignable)
+	FPoolQueryChunkDynMultCallback Failed;
+
+public:
+	/**
+	 * Query the database and receive the result in chunks while the cursor stays open.
+	 * Memory is bounded by the chunk size instead of the result size.
+	 * @param Query The query string.
+	 * @param Parameters The query parameters inserted into the query.
+	 * @param ChunkSize The maximum number of rows per chunk.
+	 * @param Options How the query is executed.
+	*/
+	UFUNCTION(BlueprintCallable, meta = (BlueprintInternalUseOnly = "true", AutoCreateRefTerm = "Parameters,Options"), Category = "Database|Pool")
+	static UQueryStreamPoolProxy* QueryStream(UDatabasePool* Pool, const FString& Query, TArray<FDatabaseValue> Parameters, const FDatabaseQueryOptions& Options, const int32 ChunkSize = 1000);
+
+	/**
+	 * Stops the stream. No more chunks will be received.
+	*/
+	UFUNCTION(BlueprintCallable, Category = "Database|Pool")
+	void Stop();
+
+	virtual void Activate();
+
+private:
+	bool OnChunkReceived(EDatabaseError Error, const FQueryResult& Chunk, bool bIsLastChunk);
+
+private:
+	UPROPERTY()
+	UDatabasePool* Pool;
+
+	FString QueryStr;
+	TArray<FDatabaseValue> Parameters;
+	int32 ChunkSize;
+	FDatabaseQueryOptions Options;
+	bool bStopped;
+
+	FDatabaseCancellationToken Token;
 };
 
 UCLASS()
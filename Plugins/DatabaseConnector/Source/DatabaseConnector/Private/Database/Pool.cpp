@@ -1,6 +1,8 @@
 // Copyright Pandores Marketplace 2021. All Rights Reserved.
 
 #include "Database/Pool.h"
+#include "Database/Transaction.h"
+#include "Database/WriteBuffer.h"
 
 #if PLATFORM_WINDOWS
 #	include "Windows/AllowWindowsPlatformTypes.h"
@@ -16,11 +18,19 @@ THIRD_PARTY_INCLUDES_END
 
 #include "Core/OdbClient.h"
 #include "Core/DatabasePoolTasks.h"
-#include "Core/DatabaseValueInternal.h"
+#include "Core/TransactionState.h"
+#include "Core/CancellationState.h"
+#include "Core/ResultCache.h"
+#include "Core/QueryKey.h"
+#include "Core/AsyncExecutor.h"
+#include "Core/CompletionQueue.h"
+#include "Core/CompletionMacros.h"
 #include "Core/SqlTypes.h"
 #include "Database/Core/SqlErrors.h"
 
 #include "UObject/StrongObjectPtr.h"
+#include "UObject/UObjectIterator.h"
+#include "HAL/IConsoleManager.h"
 #include "Misc/QueuedThreadPool.h"
 #include "Async/Async.h"
 
@@ -28,16 +38,22 @@ THIRD_PARTY_INCLUDES_END
 
 #include "Runtime/Launch/Resources/Version.h"
 
-#define LAMBDA_MOVE_TEMP(Var) Var = MoveTemp(Var)
-
-#define START_THREAD_POOL_EXECUTION(...)						\
-	NDatabasePoolThread::AsyncTask(ThreadPool.Get(),			\
+#define START_THREAD_POOL_EXECUTION_ON(Threads, Priority, ...)	\
+	this->ConnectionPool->GetMetrics().OnTaskQueued();			\
+	NDatabasePoolThread::AsyncTask(Threads, Priority,			\
 	[															\
 		ConnectionPool		 = (this->ConnectionPool),			\
-		ConnectionDsn		 = (this->ConnectionDsn)			\
+		ConnectionDsn		 = (this->ConnectionDsn),			\
+		Completions			 = (this->Completions),				\
+		QueuedTime			 = FPlatformTime::Seconds()			\
 		, ## __VA_ARGS__										\
 	]() mutable -> void											\
-	{
+	{															\
+		ConnectionPool->GetMetrics().OnTaskStarted(QueuedTime);
+
+#define START_THREAD_POOL_EXECUTION_WITH_PRIORITY(Priority, ...) START_THREAD_POOL_EXECUTION_ON(GetThreadPool(Priority), Priority, ## __VA_ARGS__)
+
+#define START_THREAD_POOL_EXECUTION(...) START_THREAD_POOL_EXECUTION_WITH_PRIORITY(EDatabaseQueryPriority::Normal, ## __VA_ARGS__)
 
 #define END_THREAD_POOL_EXECUTION(...) })
 
@@ -50,41 +66,232 @@ THIRD_PARTY_INCLUDES_END
 
 #define END_THREAD_EXECUTION() })
 
+/**
+ * Completes the timings of the connection with the time spent in the pool and reports them to the slow query log.
+ * @param QueueWait The seconds the task waited for a thread.
+*/
+static void ReportQueryTimings(FConnectionPool& Pool, FConnectionHandle& Handle, const double QueueWait, 
+	const FString& Sql, const TArray<FDatabaseValue>& Parameters, const FName Label, const EDatabaseError Error)
+{
+	FDatabaseSlowQueryLog& SlowQueryLog = Pool.GetSlowQueryLog();
+
+	if (!SlowQueryLog.IsEnabled())
+	{
+		return;
+	}
+
+	FDatabaseQueryTimings Timings = Handle.Get().GetLastTimings();
+
+	Timings.QueueWait	= QueueWait;
+	Timings.AcquireWait = Handle.GetAcquireTime();
+
+	SlowQueryLog.Report(Sql, Parameters, Label, Timings, Error);
+}
+
+FString UDatabasePool::ThreadName		  = TEXT("DatabaseConnector_Pool");
+FString UDatabasePool::CriticalThreadName = TEXT("DatabaseConnector_Critical");
+FString UDatabasePool::TransactionThreadName = TEXT("DatabaseConnector_Transaction");
+
+/**
+ * How long a streaming pool thread sleeps before checking again if it can fetch the next chunk.
+*/
+static constexpr uint32 StreamWaitIntervalMs = 100;
+
+/**
+ * Shared between the pool thread reading a stream and the Game Thread consuming its chunks.
+*/
+struct FQueryStreamState
+{
+	FQueryStreamState(FDatabaseQueryChunkCallback&& InCallback)
+		: Callback(MoveTemp(InCallback))
+		, Token(FDatabaseCancellationToken::Create())
+		, ChunksInFlight(0)
+		, bStopped(false)
+		, ChunkConsumed(FPlatformProcess::GetSynchEventFromPool(false))
+	{
+	}
 
-FString UDatabasePool::ThreadName = TEXT("DatabaseConnector_Pool");
+	~FQueryStreamState()
+	{
+		FPlatformProcess::ReturnSynchEventToPool(ChunkConsumed);
+	}
+
+	/**
+	 * Only accessed on Game Thread.
+	*/
+	FDatabaseQueryChunkCallback Callback;
+
+	/**
+	 * Cancels the statement, including the fetch of the current chunk.
+	*/
+	const FDatabaseCancellationToken Token;
+
+	TAtomic<int32>	ChunksInFlight;
+	TAtomic<bool>	bStopped;
+
+	/**
+	 * Triggered when the Game Thread consumed a chunk.
+	*/
+	FEvent* const ChunkConsumed;
+};
+
+/**
+ * A query attached to an identical one already running.
+*/
+struct FAttachedQuery
+{
+	FDatabaseQueryCallback Callback;
+
+	/**
+	 * The token returned to the caller. Cancelling it only detaches the caller.
+	*/
+	FDatabaseCancellationToken Token;
+};
+
+/**
+ * Coalesced queries being executed, with the callbacks of the identical queries attached to them.
+*/
+struct FInFlightQueries
+{
+public:
+	enum class EAttachResult : uint8
+	{
+		/* The callback was attached to the running query and has been moved. */
+		Attached,
+		/* No identical query is running. This one is registered and must be executed with OutExecution. */
+		Registered,
+		/* The identical query is being cancelled. This one must be executed on its own. */
+		Unavailable
+	};
+
+	/**
+	 * Attaches the callback to the identical query if it is running.
+	 * Otherwise, registers the query so the next identical ones are attached to it.
+	 * @param Token			The token of the caller, attached to the execution.
+	 * @param OutExecution	The token the registered query is executed with. Cancelled once all its callers are.
+	*/
+	EAttachResult Attach(const FQueryKey& Key, FDatabaseQueryCallback& Callback, const FDatabaseCancellationToken& Token, FDatabaseCancellationToken& OutExecution)
+	{
+		FScopeLock Lock(&Section);
+
+		if (FCoalescedQuery* const Running = Queries.Find(Key))
+		{
+			if (!Token.GetState()->Attach(*Running->Execution.GetState()))
+			{
+				return EAttachResult::Unavailable;
+			}
+
+			Running->Attached.Add({ MoveTemp(Callback), Token });
+
+			return EAttachResult::Attached;
+		}
+
+		OutExecution = FDatabaseCancellationToken::Create();
+
+		Token.GetState()->Attach(*OutExecution.GetState());
+
+		Queries.Add(Key, FCoalescedQuery{ OutExecution });
+
+		return EAttachResult::Registered;
+	}
+
+	/**
+	 * Unregisters the query once its result is known.
+	 * @return The queries attached to it.
+	*/
+	TArray<FAttachedQuery> Complete(const FQueryKey& Key)
+	{
+		FScopeLock Lock(&Section);
+
+		FCoalescedQuery Completed;
+
+		Queries.RemoveAndCopyValue(Key, Completed);
+
+		return MoveTemp(Completed.Attached);
+	}
+
+private:
+	struct FCoalescedQuery
+	{
+		FDatabaseCancellationToken Execution;
+
+		TArray<FAttachedQuery> Attached;
+	};
+
+	FCriticalSection Section;
+
+	TMap<FQueryKey, FCoalescedQuery> Queries;
+};
 
 UDatabasePool::UDatabasePool()
 	: ThreadPool    (FQueuedThreadPool::Allocate())
 	, ConnectionPool(nullptr)
+	, InFlightQueries(MakeShared<FInFlightQueries, ESPMode::ThreadSafe>())
+	, bCoalesceQueries(false)
+	, Completions(MakeShared<FDatabaseCompletionQueue, ESPMode::ThreadSafe>())
+	, CompletionBudget(0.)
+	, TransactionIdleTimeout(0.)
+	, PoolDestroyed(MakeShared<TAtomic<bool>, ESPMode::ThreadSafe>(false))
 {
 }
 
-UDatabasePool::~UDatabasePool() = default;
-
-void UDatabasePool::Blueprint_CreatePool(const FString& DriverName, const FString& Username, const FString& Password, const FString& Server, const int32 Port, const FString& Database, const int32 PoolSize, FDatabasePoolDelegate Callback)
+UDatabasePool::~UDatabasePool()
 {
-	CreatePool(DriverName, Username, Password, Server, Port, Database, PoolSize, FDatabasePoolCallback::CreateLambda([Callback = MoveTemp(Callback)](EDatabaseError Error, UDatabasePool* Pool) -> void
+	if (MaintenanceHandle.IsValid())
 	{
-		Callback.ExecuteIfBound(Error, Pool);
-	}));
-}
+#if ENGINE_MAJOR_VERSION > 4
+		FTSTicker::GetCoreTicker().RemoveTicker(MaintenanceHandle);
+#else
+		FTicker::GetCoreTicker().RemoveTicker(MaintenanceHandle);
+#endif
+	}
 
-UDatabasePool* UDatabasePool::CreatePoolSync(const FString& DriverName, const FString& Username, const FString& Password, const FString& Server, const int32 Port, const FString& Database, const int32 PoolSize, EDatabaseError& OutError)
-{
-	// TODO: Factorize with CreatePool to avoid duplicate code.
+	if (CompletionHandle.IsValid())
+	{
+#if ENGINE_MAJOR_VERSION > 4
+		FTSTicker::GetCoreTicker().RemoveTicker(CompletionHandle);
+#else
+		FTicker::GetCoreTicker().RemoveTicker(CompletionHandle);
+#endif
+	}
+
+	// Queries still running complete with regular Game Thread tasks.
+	Completions->Detach();
 
-	if (PoolSize <= 0)
+	// Streams waiting for their consumer would hold their thread while the thread pool waits for it.
 	{
-		ensureMsgf(PoolSize > 0, TEXT("Pool size must be strictly greater than 0. Provided %d."), PoolSize);
+		FScopeLock Lock(&StreamsSection);
+
+		for (const TWeakPtr<FQueryStreamState, ESPMode::ThreadSafe>& Stream : Streams)
+		{
+			if (const TSharedPtr<FQueryStreamState, ESPMode::ThreadSafe> State = Stream.Pin())
+			{
+				State->bStopped = true;
+				State->ChunkConsumed->Trigger();
+			}
+		}
+	}
 
-		return nullptr;
+#if WITH_DATABASE_ASYNC_EXECUTION
+	// The results of asynchronous queries are read on the thread pools destroyed with us.
+	if (AsyncExecutor)
+	{
+		AsyncExecutor->Stop();
 	}
+#endif
 
+	// The thread pool waits for its threads when destroyed, open transactions
+	// would hold theirs until their owner finishes them. They are rolled back instead.
+	*PoolDestroyed = true;
+}
+
+FString UDatabasePool::MakeConnectionUrl(const FString& DriverName, const FString& Username, const FString& Password, const FString& Server, const int32 Port, const FString& Database, const FDatabasePoolSettings& Settings)
+{
 	FString Url = FString::Printf(TEXT("DRIVER=%s;UID=%s;PORT=%d;DATABASE=%s;SERVER=%s;TCPIP=1;"),
 		*DriverName, *Username, Port, *Database, *Server);
 
-	UE_LOG(LogDatabaseConnector, Log, TEXT("Creating pool of size %d with parameters {%s}, with%s password."),
-		PoolSize, *Url, Password.IsEmpty() ? TEXT("out") : TEXT(""));
+	UE_LOG(LogDatabaseConnector, Log, TEXT("Creating pool of %d to %d connections with parameters {%s}, with%s password."),
+		Settings.MinConnections, Settings.MaxConnections, *Url, Password.IsEmpty() ? TEXT("out") : TEXT(""));
 
 	// We don't want to print the password to logs so we add it afterward.
 	if (!Password.IsEmpty())
@@ -92,28 +299,238 @@ UDatabasePool* UDatabasePool::CreatePoolSync(const FString& DriverName, const FS
 		Url += TEXT("PWD=") + Password;
 	}
 
-	FConnectionPoolPtr ConPool = MakeShared<FConnectionPool, ESPMode::ThreadSafe>();
+	return Url;
+}
+
+UDatabasePool* UDatabasePool::MakePool(FConnectionPoolPtr ConnectionPool, FString Url, const FDatabasePoolSettings& Settings)
+{
+	UDatabasePool* const Pool = NewObject<UDatabasePool>();
 
-	OutError = ConPool->Create(Url, PoolSize);
+	Pool->ConnectionPool = MoveTemp(ConnectionPool);
+	Pool->ConnectionDsn  = MakeShared<FString, ESPMode::ThreadSafe>(MoveTemp(Url));
 
-	if (OutError == EDatabaseError::None)
+	bool bAsyncExecution = false;
+
+#if WITH_DATABASE_ASYNC_EXECUTION
+	bAsyncExecution = Settings.bAsyncExecution && Pool->ConnectionPool->SupportsAsyncExecution();
+
+	if (bAsyncExecution)
+	{
+		Pool->AsyncExecutor = MakeShared<FAsyncQueryExecutor, ESPMode::ThreadSafe>(Settings.MaxConnections);
+	}
+#endif
+
+	if (Settings.bAsyncExecution && !bAsyncExecution)
 	{
-		UDatabasePool* const Pool = NewObject<UDatabasePool>();
+		UE_LOG(LogDatabaseConnector, Warning, TEXT("Asynchronous execution isn't supported by this driver or platform. Using a thread per connection."));
+	}
 
-		Pool->ConnectionPool = ConPool;
-		Pool->ConnectionDsn = MakeShared<FString, ESPMode::ThreadSafe>(MoveTemp(Url));
+	const int32 ThreadCount = Settings.GetThreadCount(bAsyncExecution);
 
-		const bool bCreatedPool = Pool->ThreadPool->Create(PoolSize, ThreadStackSize, ThreadPriority
+	UE_LOG(LogDatabaseConnector, Log, TEXT("Executing queries on %d threads%s."), ThreadCount, bAsyncExecution ? TEXT(" asynchronously") : TEXT(""));
+
+	// Threads only wait on the database, they don't need to match the number of connections.
+	const bool bCreatedPool = Pool->ThreadPool->Create(ThreadCount, ThreadStackSize, ThreadPriority
 #if ENGINE_MAJOR_VERSION > 4 || (ENGINE_MAJOR_VERSION == 4 && ENGINE_MINOR_VERSION >= 26)
-			, *ThreadName
+		, *ThreadName
+#endif
+	);
+
+	ensureMsgf(bCreatedPool, TEXT("Failed to create Thread Pool."));
+
+	if (Settings.ResultCacheSize > 0)
+	{
+		Pool->ResultCache = MakeShared<FQueryResultCache, ESPMode::ThreadSafe>((SIZE_T)Settings.ResultCacheSize * 1024 * 1024);
+	}
+
+	Pool->bCoalesceQueries = Settings.bCoalesceQueries;
+	Pool->CompletionBudget = Settings.CompletionBudget / 1000.;
+
+#if ENGINE_MAJOR_VERSION > 4
+	Pool->CompletionHandle = FTSTicker::GetCoreTicker().AddTicker(
+#else
+	Pool->CompletionHandle = FTicker::GetCoreTicker().AddTicker(
+#endif
+		FTickerDelegate::CreateUObject(Pool, &UDatabasePool::TickCompletions));
+
+	if (Settings.ReservedCriticalConnections > 0)
+	{
+		Pool->CriticalThreadPool = FThreadPoolPtr(FQueuedThreadPool::Allocate());
+
+		const bool bCreatedCriticalPool = Pool->CriticalThreadPool->Create(Settings.ReservedCriticalConnections, ThreadStackSize, EThreadPriority::TPri_AboveNormal
+#if ENGINE_MAJOR_VERSION > 4 || (ENGINE_MAJOR_VERSION == 4 && ENGINE_MINOR_VERSION >= 26)
+			, *CriticalThreadName
 #endif
 		);
 
-		UE_LOG(LogDatabaseConnector, Log, TEXT("Database Pool created."));
+		ensureMsgf(bCreatedCriticalPool, TEXT("Failed to create Critical Thread Pool."));
+	}
+
+	// Open transactions hold their thread until they end, they would otherwise starve the queries.
+	Pool->TransactionThreadPool = FThreadPoolPtr(FQueuedThreadPool::Allocate());
 
-		ensureMsgf(bCreatedPool, TEXT("Failed to create Thread Pool."));
+	const bool bCreatedTransactionPool = Pool->TransactionThreadPool->Create(FMath::Max(Settings.MaxTransactions, 1), ThreadStackSize, ThreadPriority
+#if ENGINE_MAJOR_VERSION > 4 || (ENGINE_MAJOR_VERSION == 4 && ENGINE_MINOR_VERSION >= 26)
+		, *TransactionThreadName
+#endif
+	);
 
-		return Pool;
+	ensureMsgf(bCreatedTransactionPool, TEXT("Failed to create Transaction Thread Pool."));
+
+	Pool->TransactionIdleTimeout = Settings.TransactionIdleTimeout;
+
+	const bool bClosesIdleConnections = Settings.IdleTimeout > 0.f && Settings.MinConnections < Settings.MaxConnections;
+
+	if (bClosesIdleConnections || Settings.HealthCheckInterval > 0.f || Settings.MaxLifetime > 0.f)
+	{
+#if ENGINE_MAJOR_VERSION > 4
+		Pool->MaintenanceHandle = FTSTicker::GetCoreTicker().AddTicker(
+#else
+		Pool->MaintenanceHandle = FTicker::GetCoreTicker().AddTicker(
+#endif
+			FTickerDelegate::CreateUObject(Pool, &UDatabasePool::TickMaintenance), MaintenanceInterval);
+	}
+
+	UE_LOG(LogDatabaseConnector, Log, TEXT("Database Pool created."));
+
+	return Pool;
+}
+
+FQueuedThreadPool* UDatabasePool::GetThreadPool(const EDatabaseQueryPriority Priority) const
+{
+	if (Priority == EDatabaseQueryPriority::Critical && CriticalThreadPool)
+	{
+		return CriticalThreadPool.Get();
+	}
+
+	return ThreadPool.Get();
+}
+
+bool UDatabasePool::TickMaintenance(float DeltaTime)
+{
+	START_THREAD_POOL_EXECUTION_WITH_PRIORITY(EDatabaseQueryPriority::Background, Threads = GetThreadPool(EDatabaseQueryPriority::Background));
+
+	ConnectionPool->CloseIdleConnections();
+
+	// Lost connections are found here rather than by the next query using them.
+	ConnectionPool->ValidateIdleConnections(Threads);
+
+	END_THREAD_POOL_EXECUTION();
+
+	return true;
+}
+
+bool UDatabasePool::TickCompletions(float DeltaTime)
+{
+	Completions->Drain(CompletionBudget);
+
+	return true;
+}
+
+FDatabaseCompletionStats UDatabasePool::GetCompletionStats() const
+{
+	return Completions->GetStats();
+}
+
+FDatabasePoolStats UDatabasePool::GetStats() const
+{
+	FDatabasePoolStats Stats;
+
+	// Not created with MakePool(), e.g. the class default object.
+	if (!ConnectionPool)
+	{
+		return Stats;
+	}
+
+	ConnectionPool->GetMetrics().GetStats(Stats);
+
+	Stats.OpenConnections	   = ConnectionPool->GetPoolSize();
+	Stats.WaitingForConnection = ConnectionPool->GetWaiterCount();
+
+	return Stats;
+}
+
+static void LogLatencyStats(FOutputDevice& Ar, const TCHAR* const Name, const FDatabaseLatencyStats& Stats)
+{
+	Ar.Logf(TEXT("  %-12s count: %lld, p50: %.3fms, p99: %.3fms, max: %.3fms"), Name, Stats.Count, Stats.P50, Stats.P99, Stats.Max);
+}
+
+static void DumpPoolStats(FOutputDevice& Ar)
+{
+	int32 PoolCount = 0;
+
+	for (TObjectIterator<UDatabasePool> It; It; ++It)
+	{
+		if (It->HasAnyFlags(RF_ClassDefaultObject))
+		{
+			continue;
+		}
+
+		const FDatabasePoolStats		Stats		= It->GetStats();
+		const FDatabaseCompletionStats	Completions = It->GetCompletionStats();
+
+		Ar.Logf(TEXT("Database pool %s:"), *It->GetName());
+		Ar.Logf(TEXT("  Connections: %d open, %d threads waiting. Tasks queued: %d. Callbacks pending: %d."), 
+			Stats.OpenConnections, Stats.WaitingForConnection, Stats.QueuedTasks, Completions.Pending);
+		Ar.Logf(TEXT("  Queries: %lld, failures: %lld, rows returned: %lld, reconnects: %lld, acquire timeouts: %lld."), 
+			Stats.Queries, Stats.Failures, Stats.RowsReturned, Stats.Reconnects, Stats.AcquireTimeouts);
+
+		LogLatencyStats(Ar, TEXT("Queue wait"),	  Stats.QueueWait);
+		LogLatencyStats(Ar, TEXT("Acquire wait"), Stats.AcquireWait);
+		LogLatencyStats(Ar, TEXT("Execute"),	  Stats.Execute);
+		LogLatencyStats(Ar, TEXT("Fetch"),		  Stats.Fetch);
+
+		++PoolCount;
+	}
+
+	if (PoolCount == 0)
+	{
+		Ar.Log(TEXT("No database pool."));
+	}
+}
+
+static FAutoConsoleCommandWithOutputDevice DumpPoolStatsCommand(
+	TEXT("Database.DumpPoolStats"),
+	TEXT("Prints the counters and latencies of every database pool."),
+	FConsoleCommandWithOutputDeviceDelegate::CreateStatic(&DumpPoolStats));
+
+void UDatabasePool::Blueprint_CreatePool(const FString& DriverName, const FString& Username, const FString& Password, const FString& Server, const int32 Port, const FString& Database, const int32 PoolSize, FDatabasePoolDelegate Callback)
+{
+	Blueprint_CreatePoolWithSettings(DriverName, Username, Password, Server, Port, Database, FDatabasePoolSettings::Fixed(PoolSize), MoveTemp(Callback));
+}
+
+void UDatabasePool::Blueprint_CreatePoolWithSettings(const FString& DriverName, const FString& Username, const FString& Password, const FString& Server, const int32 Port, const FString& Database, const FDatabasePoolSettings& Settings, FDatabasePoolDelegate Callback)
+{
+	CreatePool(DriverName, Username, Password, Server, Port, Database, Settings, FDatabasePoolCallback::CreateLambda([Callback = MoveTemp(Callback)](EDatabaseError Error, UDatabasePool* Pool) -> void
+	{
+		Callback.ExecuteIfBound(Error, Pool);
+	}));
+}
+
+UDatabasePool* UDatabasePool::CreatePoolSync(const FString& DriverName, const FString& Username, const FString& Password, const FString& Server, const int32 Port, const FString& Database, const int32 PoolSize, EDatabaseError& OutError)
+{
+	return CreatePoolWithSettingsSync(DriverName, Username, Password, Server, Port, Database, FDatabasePoolSettings::Fixed(PoolSize), OutError);
+}
+
+UDatabasePool* UDatabasePool::CreatePoolWithSettingsSync(const FString& DriverName, const FString& Username, const FString& Password, const FString& Server, const int32 Port, const FString& Database, const FDatabasePoolSettings& Settings, EDatabaseError& OutError)
+{
+	if (!Settings.IsValid())
+	{
+		ensureMsgf(Settings.IsValid(), TEXT("Invalid pool sizes. Connections: %d to %d, threads: %d."), Settings.MinConnections, Settings.MaxConnections, Settings.ThreadCount);
+
+		OutError = EDatabaseError::InvalidPoolSize;
+		return nullptr;
+	}
+
+	FString Url = MakeConnectionUrl(DriverName, Username, Password, Server, Port, Database, Settings);
+
+	FConnectionPoolPtr ConPool = MakeShared<FConnectionPool, ESPMode::ThreadSafe>();
+
+	OutError = ConPool->Create(Url, Settings);
+
+	if (OutError == EDatabaseError::None)
+	{
+		return MakePool(MoveTemp(ConPool), MoveTemp(Url), Settings);
 	}
 
 	return nullptr;
@@ -124,62 +541,46 @@ void UDatabasePool::CreatePool
 	const FString& DriverName, const FString& Username, const FString& Password, const FString& Server,
 	const int32 Port, const FString& Database, const int32 PoolSize, FDatabasePoolCallback Callback
 )
+{
+	CreatePool(DriverName, Username, Password, Server, Port, Database, FDatabasePoolSettings::Fixed(PoolSize), MoveTemp(Callback));
+}
+
+void UDatabasePool::CreatePool
+(
+	const FString& DriverName, const FString& Username, const FString& Password, const FString& Server,
+	const int32 Port, const FString& Database, const FDatabasePoolSettings& Settings, FDatabasePoolCallback Callback
+)
 {
 	if (!Callback.IsBound())
 	{
 		return;
 	}
 
-	if (PoolSize <= 0)
+	if (!Settings.IsValid())
 	{
-		ensureMsgf(PoolSize > 0, TEXT("Pool size must be strictly greater than 0. Provided %d."), PoolSize);
+		ensureMsgf(Settings.IsValid(), TEXT("Invalid pool sizes. Connections: %d to %d, threads: %d."), Settings.MinConnections, Settings.MaxConnections, Settings.ThreadCount);
 
 		Callback.ExecuteIfBound(EDatabaseError::InvalidPoolSize, nullptr);
 		return;
 	}
 
-	FString Url = FString::Printf(TEXT("DRIVER=%s;UID=%s;PORT=%d;DATABASE=%s;SERVER=%s;TCPIP=1;"),
-		*DriverName, *Username, Port, *Database, *Server);
-
-	UE_LOG(LogDatabaseConnector, Log, TEXT("Creating pool of size %d with parameters {%s}, with%s password."), 
-		PoolSize, *Url, Password.IsEmpty() ? TEXT("out") : TEXT(""));
-
-	// We don't want to print the password to logs so we add it afterward.
-	if (!Password.IsEmpty())
-	{
-		Url += TEXT("PWD=") + Password;
-	}
+	FString Url = MakeConnectionUrl(DriverName, Username, Password, Server, Port, Database, Settings);
 
 	// We can't use our thread pool yet as it gets created later on game thread.
 	START_THREAD_EXECUTION(ENamedThreads::AnyBackgroundThreadNormalTask,
-		LAMBDA_MOVE_TEMP(Url), LAMBDA_MOVE_TEMP(Callback), PoolSize);
+		LAMBDA_MOVE_TEMP(Url), LAMBDA_MOVE_TEMP(Callback), Settings);
 
 	FConnectionPoolPtr ConPool = MakeShared<FConnectionPool, ESPMode::ThreadSafe>();
 
-	const EDatabaseError Error = ConPool->Create(Url, PoolSize);
+	const EDatabaseError Error = ConPool->Create(Url, Settings);
 
 	// Go back to game thread to create the UObject pool.
 	START_THREAD_EXECUTION(ENamedThreads::GameThread,
-		LAMBDA_MOVE_TEMP(ConPool), PoolSize, Error, LAMBDA_MOVE_TEMP(Callback), LAMBDA_MOVE_TEMP(Url));
+		LAMBDA_MOVE_TEMP(ConPool), Settings, Error, LAMBDA_MOVE_TEMP(Callback), LAMBDA_MOVE_TEMP(Url));
 
 	if (Error == EDatabaseError::None)
 	{
-		UDatabasePool* const Pool = NewObject<UDatabasePool>();
-
-		Pool->ConnectionPool = ConPool;
-		Pool->ConnectionDsn  = MakeShared<FString, ESPMode::ThreadSafe>(MoveTemp(Url));
-
-		const bool bCreatedPool = Pool->ThreadPool->Create(PoolSize, ThreadStackSize, ThreadPriority
-#if ENGINE_MAJOR_VERSION > 4 || (ENGINE_MAJOR_VERSION == 4 && ENGINE_MINOR_VERSION >= 26)
-			, *ThreadName
-#endif
-		);
-
-		UE_LOG(LogDatabaseConnector, Log, TEXT("Database Pool created."));
-		
-		ensureMsgf(bCreatedPool, TEXT("Failed to create Thread Pool."));
-
-		Callback.ExecuteIfBound(Error, Pool);
+		Callback.ExecuteIfBound(Error, MakePool(MoveTemp(ConPool), MoveTemp(Url), Settings));
 	}
 	else
 	{
@@ -191,12 +592,12 @@ void UDatabasePool::CreatePool
 	END_THREAD_EXECUTION(); // Background Normal Pri Thread
 }
 
-void UDatabasePool::Blueprint_Query(FString Query, TArray<FDatabaseValue> Parameters, FDatabaseQueryDelegate Callback)
+void UDatabasePool::Blueprint_Query(FString Query, TArray<FDatabaseValue> Parameters, FDatabaseQueryDelegate Callback, const FDatabaseQueryOptions& Options)
 {
 	UDatabasePool::Query(MoveTemp(Query), MoveTemp(Parameters), FDatabaseQueryCallback::CreateLambda([Callback = MoveTemp(Callback)](EDatabaseError Error, const FQueryResult& Results) -> void
 	{
 		Callback.ExecuteIfBound(Error, Results);
-	}));
+	}), Options);
 }
 
 FQueryResult UDatabasePool::QuerySync(FString Query, TArray<FDatabaseValue> Parameters, EDatabaseError& OutError)
@@ -206,42 +607,465 @@ FQueryResult UDatabasePool::QuerySync(FString Query, TArray<FDatabaseValue> Para
 	{
 		FConnectionHandle Handle(*ConnectionPool);
 
-		FConnection& Connection = Handle.Get();
+		if (Handle.IsValid())
+		{
+			Result = Handle.Get().Query(Query, *ConnectionDsn, Parameters, OutError);
 
-		Result = Connection.Query(Query, *ConnectionDsn, Parameters, OutError);
+			ReportQueryTimings(*ConnectionPool, Handle, 0., Query, Parameters, NAME_None, OutError);
+		}
+		else
+		{
+			OutError = Handle.GetError();
+		}
 	}
 
 	return Result;
 }
 
-void UDatabasePool::Query(FString Query, TArray<FDatabaseValue> Parameters, FDatabaseQueryCallback Callback)
+FDatabaseCancellationToken UDatabasePool::Query(FString Query, TArray<FDatabaseValue> Parameters, FDatabaseQueryCallback Callback, const FDatabaseQueryOptions& Options)
 {
-	START_THREAD_POOL_EXECUTION(LAMBDA_MOVE_TEMP(Query), LAMBDA_MOVE_TEMP(Parameters), LAMBDA_MOVE_TEMP(Callback));
+	// Identical writes must all be executed.
+	const bool bIsRead	 = FQueryKey::IsReadStatement(Query);
+	const bool bCache	 = ResultCache && Options.CacheTTL > 0.f && bIsRead;
+	bool bCoalesce = (bCoalesceQueries || Options.bCoalesce) && bIsRead;
+
+	TOptional<FQueryKey> Key;
+	uint64 CacheGeneration = 0;
+
+	if (bCache || bCoalesce)
+	{
+		Key.Emplace(Query, Parameters);
+	}
+
+	if (bCache)
+	{
+		FQueryResult Cached;
+
+		// Hits share the cached dataset and complete right away.
+		if (ResultCache->Find(Key.GetValue(), Cached))
+		{
+			Callback.ExecuteIfBound(EDatabaseError::None, Cached);
+			return FDatabaseCancellationToken();
+		}
+
+		CacheGeneration = ResultCache->GetGeneration();
+	}
+
+	FDatabaseCancellationToken Token = FDatabaseCancellationToken::Create();
+
+	// What the execution checks. Coalesced callers share one, cancelled once they all are.
+	FDatabaseCancellationToken Execution = Token;
+
+	if (bCoalesce)
+	{
+		switch (InFlightQueries->Attach(Key.GetValue(), Callback, Token, Execution))
+		{
+		// The result will be shared with the running query.
+		case FInFlightQueries::EAttachResult::Attached:		return Token;
+		case FInFlightQueries::EAttachResult::Registered:	break;
+		case FInFlightQueries::EAttachResult::Unavailable:	bCoalesce = false; break;
+		}
+	}
+
+	START_THREAD_POOL_EXECUTION_WITH_PRIORITY(Options.Priority, LAMBDA_MOVE_TEMP(Query), LAMBDA_MOVE_TEMP(Parameters), LAMBDA_MOVE_TEMP(Callback), Options, Token, Execution, 
+		ResultCache = this->ResultCache, InFlightQueries = this->InFlightQueries, AsyncExecutor = this->AsyncExecutor, QueryThreadPool = GetThreadPool(Options.Priority), LAMBDA_MOVE_TEMP(Key), CacheGeneration, bCache, bCoalesce);
+
+	// Called once the connection is released, on this thread or on the one reading the asynchronous result.
+	auto Complete = [Completions, ResultCache, InFlightQueries, LAMBDA_MOVE_TEMP(Key), CacheGeneration, bCache, bCoalesce, Options, Token, LAMBDA_MOVE_TEMP(Callback)]
+		(EDatabaseError Error, FQueryResult Result) mutable -> void
+	{
+		if (ResultCache)
+		{
+			ResultCache->Invalidate(Options.InvalidateTags);
+
+			// Cached before the query stops being in flight so identical queries never miss both.
+			if (bCache && Error == EDatabaseError::None)
+			{
+				ResultCache->Add(bCoalesce ? Key.GetValue() : MoveTemp(Key.GetValue()), Result, Options.CacheTTL, Options.CacheTags, CacheGeneration);
+			}
+		}
+
+		TArray<FAttachedQuery> Attached;
+
+		if (bCoalesce)
+		{
+			Attached = InFlightQueries->Complete(Key.GetValue());
+		}
+
+		// Go back to Game Thread for our callback.
+		START_GAME_THREAD_COMPLETION(Completions, Error, LAMBDA_MOVE_TEMP(Result), LAMBDA_MOVE_TEMP(Callback), LAMBDA_MOVE_TEMP(Attached), Token, bCoalesce);
+
+		// Coalesced callers cancelled while the execution went on for the others.
+		const auto Deliver = [&Error, &Result](const FDatabaseQueryCallback& Target, const FDatabaseCancellationToken& TargetToken) -> void
+		{
+			if (TargetToken.IsCancelled())
+			{
+				Target.ExecuteIfBound(EDatabaseError::Cancelled, FQueryResult());
+			}
+			else
+			{
+				Target.ExecuteIfBound(Error, Result);
+			}
+		};
+
+		if (bCoalesce)
+		{
+			Deliver(Callback, Token);
+		}
+		else
+		{
+			Callback.ExecuteIfBound(Error, Result);
+		}
+
+		for (const FAttachedQuery& AttachedQuery : Attached)
+		{
+			Deliver(AttachedQuery.Callback, AttachedQuery.Token);
+		}
+	
+		END_GAME_THREAD_COMPLETION(); // Game Thread.
+	};
+
+	if (Execution.GetState()->ShouldDrop())
+	{
+		Complete(EDatabaseError::Cancelled, FQueryResult());
+		return;
+	}
+
+	const double QueueWait = FPlatformTime::Seconds() - QueuedTime;
+
+	// Allocated so it can be handed to an I/O thread.
+	TUniquePtr<FConnectionHandle> Handle = MakeUnique<FConnectionHandle>(*ConnectionPool, Options.Priority);
+
+	if (!Handle->IsValid())
+	{
+		Complete(Handle->GetError(), FQueryResult());
+		return;
+	}
+
+	// It might have been cancelled while waiting for a connection.
+	if (Execution.GetState()->ShouldDrop())
+	{
+		Handle.Reset();
+		Complete(EDatabaseError::Cancelled, FQueryResult());
+		return;
+	}
+
+	FConnection& Connection = Handle->Get();
+
+	const FExecutionContext Context { Options.Timeout, Execution.GetState(), Options.bIdempotent };
 
 	EDatabaseError Error;
-	FQueryResult   Result;
+
+#if WITH_DATABASE_ASYNC_EXECUTION
+	if (AsyncExecutor && Connection.SupportsAsyncExecution())
+	{
+		if (Connection.BeginQuery(Query, Parameters, Error, Context))
+		{
+			// This thread is free for other queries while the database works.
+			// The token is kept alive as the connection refers to its state until the query ends.
+			AsyncExecutor->Wait(Connection.GetCompletionEvent(), QueryThreadPool, Options.Priority, [LAMBDA_MOVE_TEMP(Handle), LAMBDA_MOVE_TEMP(Complete), Execution, ConnectionPool, 
+				LAMBDA_MOVE_TEMP(Query), LAMBDA_MOVE_TEMP(Parameters), QueueWait, Label = Options.Label]() mutable -> void
+			{
+				EDatabaseError Error;
+
+				FQueryResult Result = Handle->Get().EndQuery(Error);
+
+				ReportQueryTimings(*ConnectionPool, *Handle, QueueWait, Query, Parameters, Label, Error);
+
+				Handle.Reset();
+
+				Complete(Error, MoveTemp(Result));
+			});
+
+			return;
+		}
+
+		// Lost connections are re-established by the blocking path.
+		if (Error != EDatabaseError::ConnectionClosed)
+		{
+			Handle.Reset();
+			Complete(Error, FQueryResult());
+			return;
+		}
+	}
+#endif
+
+	FQueryResult Result = Connection.Query(Query, *ConnectionDsn, Parameters, Error, Context);
+
+	ReportQueryTimings(*ConnectionPool, *Handle, QueueWait, Query, Parameters, Options.Label, Error);
+
+	Handle.Reset();
+
+	Complete(Error, MoveTemp(Result));
+
+	END_THREAD_POOL_EXECUTION();
+
+	return Token;
+}
+
+FDatabaseCancellationToken UDatabasePool::QueryStream(FString Query, TArray<FDatabaseValue> Parameters, const int32 ChunkSize, FDatabaseQueryChunkCallback Callback, const FDatabaseQueryOptions& Options)
+{
+	if (ChunkSize <= 0)
+	{
+		ensureMsgf(ChunkSize > 0, TEXT("Chunk size must be strictly greater than 0. Provided %d."), ChunkSize);
+
+		Callback.ExecuteIfBound(EDatabaseError::QueryFailed, FQueryResult(), true);
+		return FDatabaseCancellationToken();
+	}
+
+	TSharedRef<FQueryStreamState, ESPMode::ThreadSafe> State = MakeShared<FQueryStreamState, ESPMode::ThreadSafe>(MoveTemp(Callback));
+
+	{
+		FScopeLock Lock(&StreamsSection);
+
+		Streams.RemoveAllSwap([](const TWeakPtr<FQueryStreamState, ESPMode::ThreadSafe>& Stream) -> bool
+		{
+			return !Stream.IsValid();
+		});
+
+		Streams.Add(State);
+	}
+
+	FDatabaseCancellationToken Token = State->Token;
+
+	START_THREAD_POOL_EXECUTION_WITH_PRIORITY(Options.Priority, LAMBDA_MOVE_TEMP(Query), LAMBDA_MOVE_TEMP(Parameters), ChunkSize, LAMBDA_MOVE_TEMP(State), Options, 
+		PoolDestroyed = (this->PoolDestroyed));
+
+	FConnectionHandle Handle(*ConnectionPool, Options.Priority);
+
+	if (!Handle.IsValid() || State->Token.GetState()->ShouldDrop())
+	{
+		START_GAME_THREAD_COMPLETION(Completions, State, Error = Handle.IsValid() ? EDatabaseError::Cancelled : Handle.GetError());
+
+		State->Callback.ExecuteIfBound(Error, FQueryResult(), true);
+
+		END_GAME_THREAD_COMPLETION(); // Game Thread.
+
+		return;
+	}
+
+	FConnection& Connection = Handle.Get();
+
+	Connection.QueryStream(Query, *ConnectionDsn, Parameters, ChunkSize, [&State, &Completions, &PoolDestroyed](EDatabaseError Error, const FQueryResult& Chunk, bool bIsLastChunk) -> bool
+	{
+		const FDatabaseCancellationToken& Token = State->Token;
+
+		// Don't fetch further than what the Game Thread consumed
+		// so memory stays bounded by the chunk size.
+		while (State->ChunksInFlight >= MaxStreamChunksInFlight && !State->bStopped && !Token.IsCancelled() && !*PoolDestroyed && !IsEngineExitRequested())
+		{
+			State->ChunkConsumed->Wait(StreamWaitIntervalMs);
+		}
+
+		if (State->bStopped || *PoolDestroyed || IsEngineExitRequested())
+		{
+			return false;
+		}
+
+		const bool bCancelled = Token.IsCancelled();
+
+		++State->ChunksInFlight;
+
+		START_GAME_THREAD_COMPLETION(Completions, State, 
+			Error		 = bCancelled ? EDatabaseError::Cancelled : Error, 
+			Chunk		 = bCancelled ? FQueryResult() : Chunk, 
+			bIsLastChunk = bIsLastChunk || bCancelled);
+
+		if (!State->bStopped)
+		{
+			const bool bContinue = State->Callback.IsBound() && State->Callback.Execute(Error, Chunk, bIsLastChunk);
+
+			State->bStopped = !bContinue || bIsLastChunk;
+		}
+
+		--State->ChunksInFlight;
+
+		State->ChunkConsumed->Trigger();
+
+		END_GAME_THREAD_COMPLETION(); // Game Thread.
+
+		return !bCancelled;
+	}, FExecutionContext{ Options.Timeout, State->Token.GetState(), Options.bIdempotent });
+
+	END_THREAD_POOL_EXECUTION();
+
+	return Token;
+}
+
+FDatabaseCancellationToken UDatabasePool::ExecuteBatch(FString Query, TArray<TArray<FDatabaseValue>> Rows, FDatabaseQueryCallback Callback, const FDatabaseQueryOptions& Options)
+{
+	TArray<FDatabaseBatch> Batches;
+
+	Batches.Emplace(MoveTemp(Query), MoveTemp(Rows));
+
+	return ExecuteBatches(MoveTemp(Batches), MoveTemp(Callback), Options);
+}
+
+FQueryResult UDatabasePool::ExecuteBatchesSync(const TArray<FDatabaseBatch>& Batches, EDatabaseError& OutError)
+{
+	FQueryResult Result;
 
 	{
 		FConnectionHandle Handle(*ConnectionPool);
 
-		FConnection& Connection = Handle.Get();
+		if (Handle.IsValid())
+		{
+			Result = Handle.Get().ExecuteBatch(Batches, *ConnectionDsn, OutError);
+		}
+		else
+		{
+			OutError = Handle.GetError();
+		}
+	}
+
+	return Result;
+}
+
+FDatabaseCancellationToken UDatabasePool::ExecuteBatches(TArray<FDatabaseBatch> Batches, FDatabaseQueryCallback Callback, const FDatabaseQueryOptions& Options)
+{
+	return ExecuteBatches(MoveTemp(Batches), MoveTemp(Callback), Options, TUniqueFunction<void()>(), TUniqueFunction<void()>());
+}
+
+FDatabaseCancellationToken UDatabasePool::ExecuteBatches(TArray<FDatabaseBatch> Batches, FDatabaseQueryCallback Callback, const FDatabaseQueryOptions& Options, 
+	TUniqueFunction<void()> OnStarted, TUniqueFunction<void()> OnExecuted)
+{
+	FDatabaseCancellationToken Token = FDatabaseCancellationToken::Create();
+
+	START_THREAD_POOL_EXECUTION_WITH_PRIORITY(Options.Priority, LAMBDA_MOVE_TEMP(Batches), LAMBDA_MOVE_TEMP(Callback), Options, Token, 
+		ResultCache = this->ResultCache, LAMBDA_MOVE_TEMP(OnStarted), LAMBDA_MOVE_TEMP(OnExecuted));
 
-		Result = Connection.Query(Query, *ConnectionDsn, Parameters, Error);
+	if (OnStarted)
+	{
+		OnStarted();
+	}
+
+	EDatabaseError Error = EDatabaseError::Cancelled;
+	FQueryResult   Result;
+
+	if (!Token.GetState()->ShouldDrop())
+	{
+		FConnectionHandle Handle(*ConnectionPool, Options.Priority);
+
+		if (!Handle.IsValid())
+		{
+			Error = Handle.GetError();
+		}
+		else if (!Token.GetState()->ShouldDrop())
+		{
+			Result = Handle.Get().ExecuteBatch(Batches, *ConnectionDsn, Error, FExecutionContext{ Options.Timeout, Token.GetState() });
+		}
+	}
+
+	if (ResultCache)
+	{
+		ResultCache->Invalidate(Options.InvalidateTags);
+	}
+
+	if (OnExecuted)
+	{
+		OnExecuted();
 	}
 
 	// Go back to Game Thread for our callback.
-	START_THREAD_EXECUTION(ENamedThreads::GameThread, Error, LAMBDA_MOVE_TEMP(Result), LAMBDA_MOVE_TEMP(Callback));
+	START_GAME_THREAD_COMPLETION(Completions, Error, LAMBDA_MOVE_TEMP(Result), LAMBDA_MOVE_TEMP(Callback));
 
 	Callback.ExecuteIfBound(Error, Result);
 	
-	END_THREAD_EXECUTION(); // Game Thread.
+	END_GAME_THREAD_COMPLETION(); // Game Thread.
+
+	END_THREAD_POOL_EXECUTION();
+
+	return Token;
+}
+
+UDatabaseWriteBuffer* UDatabasePool::CreateWriteBuffer(const FDatabaseWriteBufferSettings& Settings)
+{
+	if (!Settings.IsValid())
+	{
+		UE_LOG(LogDatabaseConnector, Error, TEXT("Invalid write buffer settings. The threshold and the maximum of pending writes must be positive, the maximum at least the threshold."));
+		return nullptr;
+	}
+
+	UDatabaseWriteBuffer* const WriteBuffer = NewObject<UDatabaseWriteBuffer>();
+
+	WriteBuffer->Initialize(this, Settings);
+
+	return WriteBuffer;
+}
+
+void UDatabasePool::Blueprint_BeginTransaction(FDatabaseTransactionDelegate Callback, const FDatabaseQueryOptions& Options)
+{
+	if (!Callback.IsBound())
+	{
+		BeginTransaction(FDatabaseTransactionCallback(), Options);
+		return;
+	}
+
+	BeginTransaction(FDatabaseTransactionCallback::CreateLambda([Callback = MoveTemp(Callback)](EDatabaseError Error, UDatabaseTransaction* Transaction) -> void
+	{
+		Callback.ExecuteIfBound(Error, Transaction);
+	}), Options);
+}
+
+void UDatabasePool::BeginTransaction(FDatabaseTransactionCallback Callback, const FDatabaseQueryOptions& Options)
+{
+	// Nobody could commit the transaction, it would only hold locks.
+	if (!Callback.IsBound())
+	{
+		UE_LOG(LogDatabaseConnector, Warning, TEXT("Transaction not started as its callback isn't bound."));
+		return;
+	}
+
+	START_THREAD_POOL_EXECUTION_ON(TransactionThreadPool.Get(), Options.Priority, LAMBDA_MOVE_TEMP(Callback), Options, 
+		PoolDestroyed = (this->PoolDestroyed), TransactionIdleTimeout = (this->TransactionIdleTimeout));
+
+	// The transaction holds this thread so the queries queued on it
+	// never wait for a thread held by a query waiting for a connection.
+	FConnectionHandle Handle(*ConnectionPool, Options.Priority);
+
+	EDatabaseError Error = Handle.GetError();
+
+	if (!Handle.IsValid() || !Handle.Get().BeginTransaction(Error))
+	{
+		START_GAME_THREAD_COMPLETION(Completions, Error, LAMBDA_MOVE_TEMP(Callback));
+
+		Callback.ExecuteIfBound(Error, nullptr);
+
+		END_GAME_THREAD_COMPLETION(); // Game Thread.
+
+		return;
+	}
+
+	TSharedRef<FDatabaseTransactionState, ESPMode::ThreadSafe> State = MakeShared<FDatabaseTransactionState, ESPMode::ThreadSafe>(TransactionIdleTimeout);
+
+	START_GAME_THREAD_COMPLETION(Completions, State, ConnectionDsn, Completions, LAMBDA_MOVE_TEMP(Callback));
+
+	// The callback's object was destroyed in the meantime.
+	if (!Callback.IsBound())
+	{
+		State->Finish();
+		return;
+	}
+
+	UDatabaseTransaction* const Transaction = NewObject<UDatabaseTransaction>();
+
+	Transaction->State			= State;
+	Transaction->ConnectionDsn	= ConnectionDsn;
+	Transaction->Completions	= Completions;
+	Transaction->bEnded			= false;
+
+	Callback.ExecuteIfBound(EDatabaseError::None, Transaction);
+
+	END_GAME_THREAD_COMPLETION(); // Game Thread.
+
+	State->Run(Handle.Get(), *PoolDestroyed);
 
 	END_THREAD_POOL_EXECUTION();
 }
 
 void UDatabasePool::Reconnect(const int32 Timeout, FPoolReconnectCallback Callback)
 {
-	START_THREAD_POOL_EXECUTION(LAMBDA_MOVE_TEMP(Callback), Timeout);
+	START_THREAD_POOL_EXECUTION(LAMBDA_MOVE_TEMP(Callback), Timeout, Threads = GetThreadPool(EDatabaseQueryPriority::Background));
 
 	int32 ReconnectedCount	= 0;
 	int32 SkippedCount		= 0;
@@ -249,14 +1073,14 @@ void UDatabasePool::Reconnect(const int32 Timeout, FPoolReconnectCallback Callba
 
 	UE_LOG(LogDatabaseConnector, Log, TEXT("Reconnecting pool to database."));
 
-	ConnectionPool->Reconnect(*ConnectionDsn, Timeout, ReconnectedCount, SkippedCount, FailedCount);
+	ConnectionPool->Reconnect(*ConnectionDsn, Timeout, Threads, ReconnectedCount, SkippedCount, FailedCount);
 
 	UE_LOG(LogDatabaseConnector, Log, TEXT("Reconnection to database result: %d reconnected, %d skipped, %d failed.")
 		, ReconnectedCount, SkippedCount, FailedCount);
 
 	if (Callback.IsBound())
 	{
-		START_THREAD_EXECUTION(ENamedThreads::GameThread, FailedCount, ReconnectedCount, SkippedCount, LAMBDA_MOVE_TEMP(Callback));
+		START_GAME_THREAD_COMPLETION(Completions, FailedCount, ReconnectedCount, SkippedCount, LAMBDA_MOVE_TEMP(Callback));
 
 		Callback.ExecuteIfBound
 		(
@@ -264,8 +1088,24 @@ void UDatabasePool::Reconnect(const int32 Timeout, FPoolReconnectCallback Callba
 			ReconnectedCount, SkippedCount, FailedCount
 		);
 
-		END_THREAD_EXECUTION(); // Game Thread.
+		END_GAME_THREAD_COMPLETION(); // Game Thread.
 	}
 
 	END_THREAD_POOL_EXECUTION();
 }
+
+void UDatabasePool::SetMaxRowsetSize(const int32 RowsetSize)
+{
+	if (ConnectionPool)
+	{
+		ConnectionPool->SetMaxRowsetSize(RowsetSize);
+	}
+}
+
+void UDatabasePool::InvalidateCache(const TArray<FName>& Tags)
+{
+	if (ResultCache)
+	{
+		ResultCache->Invalidate(Tags);
+	}
+}
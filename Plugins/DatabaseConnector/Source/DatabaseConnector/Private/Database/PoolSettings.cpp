@@ -0,0 +1,62 @@
+// Copyright Pandores Marketplace 2021. All Rights Reserved.
+
+#include "Database/PoolSettings.h"
+
+FDatabasePoolSettings FDatabasePoolSettings::Fixed(const int32 PoolSize)
+{
+	FDatabasePoolSettings Settings;
+
+	Settings.MinConnections = PoolSize;
+	Settings.MaxConnections = PoolSize;
+	Settings.ThreadCount	= PoolSize;
+	Settings.IdleTimeout	= 0.f;
+
+	// Keep all connections usable by any query.
+	Settings.ReservedCriticalConnections = 0;
+	Settings.MaxBackgroundConnections	 = PoolSize;
+
+	return Settings;
+}
+
+bool FDatabasePoolSettings::IsValid() const
+{
+	return MaxConnections > 0 && MinConnections >= 0 && MinConnections <= MaxConnections && ThreadCount >= 0 && AcquireTimeout >= 0.f
+		&& HealthCheckInterval >= 0.f && (HealthCheckInterval <= 0.f || !HealthCheckQuery.IsEmpty()) && MaxLifetime >= 0.f
+		&& ReservedCriticalConnections >= 0 && ReservedCriticalConnections < MaxConnections && MaxBackgroundConnections >= 0 && ResultCacheSize >= 0
+		&& CompletionBudget >= 0.f && SlowQueries.Threshold >= 0.f && SlowQueries.MaxEntriesPerMinute > 0
+		&& Retry.MaxRetries >= 0 && Retry.InitialBackoff >= 0.f && Retry.MaxBackoff >= 0.f && Retry.Jitter >= 0.f && Retry.Jitter <= 1.f
+		&& CircuitBreaker.FailureThreshold >= 0 && CircuitBreaker.ProbeInterval >= 0.f;
+}
+
+int32 FDatabasePoolSettings::GetThreadCount(const bool bWithAsyncExecution) const
+{
+	if (ThreadCount > 0)
+	{
+		return ThreadCount;
+	}
+
+	// Critical queries have their own threads.
+	const int32 SharedConnections = MaxConnections - ReservedCriticalConnections;
+
+	// Threads only start queries and read results, they don't wait for the database.
+	return bWithAsyncExecution ? FMath::Min(SharedConnections, DefaultAsyncThreadCount) : SharedConnections;
+}
+
+int32 FDatabasePoolSettings::GetMaxBackgroundConnections() const
+{
+	const int32 SharedConnections = MaxConnections - ReservedCriticalConnections;
+
+	return FMath::Min(MaxBackgroundConnections > 0 ? MaxBackgroundConnections : FMath::Max(MaxConnections / 2, 1), SharedConnections);
+}
+
+double FDatabaseRetrySettings::GetBackoff(const int32 Attempt) const
+{
+	const double Backoff = FMath::Min((double)InitialBackoff * (1 << FMath::Clamp(Attempt, 0, 16)), (double)MaxBackoff) / 1000.;
+
+	return Backoff * (1. - Jitter * FMath::FRand());
+}
+
+bool FDatabaseWriteBufferSettings::IsValid() const
+{
+	return FlushThreshold > 0 && FlushInterval >= 0.f && MaxPendingWrites >= FlushThreshold;
+}
@@ -0,0 +1,44 @@
+// Copyright Pandores Marketplace 2021. All Rights Reserved.
+
+#include "Database/QueryCancellation.h"
+#include "Core/CancellationState.h"
+
+FDatabaseCancellationToken FDatabaseCancellationToken::Create()
+{
+	FDatabaseCancellationToken Token;
+
+	Token.State = MakeShared<FDatabaseCancellationState, ESPMode::ThreadSafe>();
+
+	return Token;
+}
+
+void FDatabaseCancellationToken::Cancel() const
+{
+	if (State)
+	{
+		State->Cancel();
+	}
+}
+
+void FDatabaseCancellationToken::Abandon() const
+{
+	if (State)
+	{
+		State->Abandon();
+	}
+}
+
+bool FDatabaseCancellationToken::IsCancelled() const
+{
+	return State && State->IsCancelled();
+}
+
+bool FDatabaseCancellationToken::IsValid() const
+{
+	return State.IsValid();
+}
+
+FDatabaseCancellationState* FDatabaseCancellationToken::GetState() const
+{
+	return State.Get();
+}
@@ -2,33 +2,369 @@
 
 #include "Database/QueryResult.h"
 
+#include "Database/Core/QueryResultInternal.h"
+#include "Database/Core/RowMapping.h"
+
+#include "UObject/Class.h"
+#include "Misc/ScopeLock.h"
+
 #include "DatabaseConnectorModule.h"
 
 #include <sstream>
 
-struct FQueryResultInternal
-{
-public:
-	FQueryResultInternal() = default;
-	FQueryResultInternal(uint64 InAffectedRows)
-		: AffectedRows(InAffectedRows) 
-	{}
-	FQueryResultInternal(TArray<FString>&& InHeaders, TArray64<TArray<FDatabaseValue>>&& InValues, TArray<FColumnMetadata>&& InMetadata, uint64 InAffectedRows)
-		: AffectedRows(InAffectedRows)
-		, Headers(MoveTemp(InHeaders))
-		, Metadata(MoveTemp(InMetadata))
-		, Values(MoveTemp(InValues))
-	{}
-
-	uint64 AffectedRows;
-	TArray<FString> Headers;
-	TArray<FColumnMetadata> Metadata;
-	TArray64<TArray<FDatabaseValue>> Values;
-};
+//////////////////////////////////////////////////////////////////////
+// FQueryResultColumn
+
+static EQueryColumnStorage GetColumnStorage(const EDatabaseValueType Type)
+{
+	switch (Type)
+	{
+	case EDatabaseValueType::Uint8:
+	case EDatabaseValueType::Int32:
+	case EDatabaseValueType::Int64:		return EQueryColumnStorage::Integer;
+	case EDatabaseValueType::Double:	return EQueryColumnStorage::Double;
+	case EDatabaseValueType::Boolean:	return EQueryColumnStorage::Boolean;
+	case EDatabaseValueType::Timestamp: return EQueryColumnStorage::Timestamp;
+	case EDatabaseValueType::Date:		return EQueryColumnStorage::Date;
+	case EDatabaseValueType::String:	return EQueryColumnStorage::String;
+	}
+
+	return EQueryColumnStorage::None;
+}
+
+FQueryResultColumn::FQueryResultColumn(const EDatabaseValueType InType)
+	: Type(InType)
+	, Storage(GetColumnStorage(InType))
+{
+}
+
+void FQueryResultColumn::Reserve(const int64 InRowCount)
+{
+	NullMask.Reserve((InRowCount + 63) / 64);
+
+	switch (Storage)
+	{
+	case EQueryColumnStorage::Integer:		Integers  .Reserve(InRowCount); break;
+	case EQueryColumnStorage::Double:		Doubles	  .Reserve(InRowCount); break;
+	case EQueryColumnStorage::Boolean:		Booleans  .Reserve(InRowCount); break;
+	case EQueryColumnStorage::Timestamp:	Timestamps.Reserve(InRowCount); break;
+	case EQueryColumnStorage::Date:			Dates	  .Reserve(InRowCount); break;
+	case EQueryColumnStorage::String:		Strings	  .Reserve(InRowCount); break;
+	case EQueryColumnStorage::Variant:		Variants  .Reserve(InRowCount); break;
+	}
+}
+
+void FQueryResultColumn::MarkNull()
+{
+	const int64 Word = RowCount / 64;
+
+	if (NullMask.Num() <= Word)
+	{
+		NullMask.AddZeroed(Word + 1 - NullMask.Num());
+	}
+
+	NullMask[Word] |= uint64(1) << (RowCount % 64);
+}
+
+void FQueryResultColumn::AddNull()
+{
+	MarkNull();
+
+	// Keep a slot in the typed array so row indices stay aligned.
+	switch (Storage)
+	{
+	case EQueryColumnStorage::Integer:		Integers  .Add(0);							break;
+	case EQueryColumnStorage::Double:		Doubles	  .Add(0.);							break;
+	case EQueryColumnStorage::Boolean:		Booleans  .Add(false);						break;
+	case EQueryColumnStorage::Timestamp:	Timestamps.AddZeroed();						break;
+	case EQueryColumnStorage::Date:			Dates	  .AddZeroed();						break;
+	case EQueryColumnStorage::String:		Strings	  .Add({ Characters.Num(), 0 });	break;
+	case EQueryColumnStorage::Variant:		Variants  .Add(FDatabaseValue::Null());		break;
+	}
+
+	++RowCount;
+}
+
+void FQueryResultColumn::AddInteger(const int64 Value)
+{
+	check(Storage == EQueryColumnStorage::Integer);
+	Integers.Add(Value);
+	++RowCount;
+}
+
+void FQueryResultColumn::AddDouble(const double Value)
+{
+	check(Storage == EQueryColumnStorage::Double);
+	Doubles.Add(Value);
+	++RowCount;
+}
+
+void FQueryResultColumn::AddBoolean(const bool bValue)
+{
+	check(Storage == EQueryColumnStorage::Boolean);
+	Booleans.Add(bValue);
+	++RowCount;
+}
+
+void FQueryResultColumn::AddTimestamp(const FDatabaseTimestamp& Value)
+{
+	check(Storage == EQueryColumnStorage::Timestamp);
+	Timestamps.Add(Value);
+	++RowCount;
+}
+
+void FQueryResultColumn::AddDate(const FDatabaseDate& Value)
+{
+	check(Storage == EQueryColumnStorage::Date);
+	Dates.Add(Value);
+	++RowCount;
+}
+
+void FQueryResultColumn::AddString(const TCHAR* const Data, const int32 Length)
+{
+	check(Storage == EQueryColumnStorage::String);
+	Strings.Add({ Characters.Num(), Length });
+	Characters.Append(Data, Length);
+	++RowCount;
+}
+
+TCHAR* FQueryResultColumn::AddStringUninitialized(const int32 Length)
+{
+	check(Storage == EQueryColumnStorage::String);
+	Strings.Add({ Characters.Num(), Length });
+	++RowCount;
+	return Characters.GetData() + Characters.AddUninitialized(Length);
+}
+
+void FQueryResultColumn::AddStringSpan(const FQueryStringSpan& Span)
+{
+	check(Storage == EQueryColumnStorage::String);
+	Strings.Add(Span);
+	++RowCount;
+}
+
+void FQueryResultColumn::AddValue(const FDatabaseValue& Value)
+{
+	if (Value.IsNull())
+	{
+		AddNull();
+		return;
+	}
+
+	switch (Storage)
+	{
+	case EQueryColumnStorage::Integer:		AddInteger	(Value.ToInt64());		break;
+	case EQueryColumnStorage::Double:		AddDouble	(Value.ToDouble());		break;
+	case EQueryColumnStorage::Boolean:		AddBoolean	(Value.ToInt32() != 0); break;
+	case EQueryColumnStorage::Timestamp:	AddTimestamp(Value.ToTimestamp());	break;
+	case EQueryColumnStorage::Date:			AddDate		(Value.ToDate());		break;
+	case EQueryColumnStorage::String:
+	{
+		const FString String = Value.ToString(false);
+		AddString(*String, String.Len());
+		break;
+	}
+	case EQueryColumnStorage::Variant:
+		Variants.Add(Value);
+		++RowCount;
+		break;
+	default:
+		AddNull();
+	}
+}
+
+bool FQueryResultColumn::IsNull(const int64 RowIndex) const
+{
+	const int64 Word = RowIndex / 64;
+
+	return NullMask.IsValidIndex(Word) && (NullMask[Word] & (uint64(1) << (RowIndex % 64))) != 0;
+}
+
+FDatabaseValue FQueryResultColumn::GetValue(const int64 RowIndex) const
+{
+	if (IsNull(RowIndex))
+	{
+		return FDatabaseValue::Null();
+	}
+
+	switch (Storage)
+	{
+	case EQueryColumnStorage::Integer:
+		switch (Type)
+		{
+		case EDatabaseValueType::Uint8: return (uint8)Integers[RowIndex];
+		case EDatabaseValueType::Int32: return (int32)Integers[RowIndex];
+		default:						return Integers[RowIndex];
+		}
+	case EQueryColumnStorage::Double:		return Doubles	 [RowIndex];
+	case EQueryColumnStorage::Boolean:		return Booleans	 [RowIndex];
+	case EQueryColumnStorage::Timestamp:	return Timestamps[RowIndex];
+	case EQueryColumnStorage::Date:			return Dates	 [RowIndex];
+	case EQueryColumnStorage::String:
+	{
+		const FQueryStringSpan& Span = Strings[RowIndex];
+		return FString(Span.Length, Characters.GetData() + Span.Offset);
+	}
+	case EQueryColumnStorage::Variant:		return Variants[RowIndex];
+	}
+
+	return FDatabaseValue::Null();
+}
+
+SIZE_T FQueryResultColumn::GetAllocatedSize() const
+{
+	// Strings held by boxed values aren't counted, mixed columns are rare.
+	return Integers.GetAllocatedSize() + Doubles.GetAllocatedSize() + Booleans.GetAllocatedSize()
+		+ Timestamps.GetAllocatedSize() + Dates.GetAllocatedSize() + Strings.GetAllocatedSize()
+		+ Characters.GetAllocatedSize() + Variants.GetAllocatedSize() + NullMask.GetAllocatedSize();
+}
+
+//////////////////////////////////////////////////////////////////////
+// FQueryColumnIndex
+
+FQueryColumnIndex::FQueryColumnIndex(const TArray<FString>& Headers)
+	: LayoutHash(GetTypeHash(Headers.Num()))
+{
+	Indices.Reserve(Headers.Num());
+
+	for (int32 i = 0; i < Headers.Num(); ++i)
+	{
+		// FString hashes ignore case.
+		LayoutHash = HashCombine(LayoutHash, GetTypeHash(Headers[i]));
+
+		// The first column with a name wins, as with Headers.Find().
+		if (!Indices.Contains(Headers[i]))
+		{
+			Indices.Add(Headers[i], i);
+		}
+	}
+}
+
+int32 FQueryColumnIndex::Find(const FString& ColumnName) const
+{
+	const int32* const Index = Indices.Find(ColumnName);
+
+	return Index ? *Index : INDEX_NONE;
+}
+
+SIZE_T FQueryColumnIndex::GetAllocatedSize() const
+{
+	SIZE_T Size = sizeof(FQueryColumnIndex) + Indices.GetAllocatedSize();
+
+	for (const TPair<FString, int32>& Index : Indices)
+	{
+		Size += Index.Key.GetAllocatedSize();
+	}
+
+	return Size;
+}
+
+//////////////////////////////////////////////////////////////////////
+// FQueryResultInternal
+
+SIZE_T FQueryResultInternal::GetAllocatedSize() const
+{
+	SIZE_T Size = sizeof(FQueryResultInternal) + Headers.GetAllocatedSize() + Metadata.GetAllocatedSize() + Columns.GetAllocatedSize() + Rows.GetAllocatedSize();
+
+	if (ColumnIndex)
+	{
+		Size += ColumnIndex->GetAllocatedSize();
+	}
+
+	for (const FString& Header : Headers)
+	{
+		Size += Header.GetAllocatedSize();
+	}
+
+	for (const FColumnMetadata& Meta : Metadata)
+	{
+		Size += Meta.DataTypeName.GetAllocatedSize();
+	}
+
+	for (const FQueryResultColumn& Column : Columns)
+	{
+		Size += Column.GetAllocatedSize();
+	}
+
+	return Size;
+}
+
+/**
+ * Builds a column from row-major values.
+ * Columns mixing several types fall back to boxed storage.
+*/
+static FQueryResultColumn MakeColumn(const TArray64<TArray<FDatabaseValue>>& Rows, const int32 ColumnIndex)
+{
+	EDatabaseValueType Type	  = EDatabaseValueType::Null;
+	bool			   bMixed = false;
+
+	for (const TArray<FDatabaseValue>& Row : Rows)
+	{
+		const EDatabaseValueType CellType = Row.IsValidIndex(ColumnIndex) 
+			? Row[ColumnIndex].GetType() : EDatabaseValueType::Null;
+
+		if (CellType == EDatabaseValueType::Null || CellType == Type)
+		{
+			continue;
+		}
+
+		if (Type != EDatabaseValueType::Null)
+		{
+			bMixed = true;
+			break;
+		}
+
+		Type = CellType;
+	}
+
+	FQueryResultColumn Column(Type);
+
+	if (bMixed)
+	{
+		Column.Storage = EQueryColumnStorage::Variant;
+	}
+
+	Column.Reserve(Rows.Num());
+
+	for (const TArray<FDatabaseValue>& Row : Rows)
+	{
+		if (Row.IsValidIndex(ColumnIndex))
+		{
+			Column.AddValue(Row[ColumnIndex]);
+		}
+		else
+		{
+			Column.AddNull();
+		}
+	}
+
+	return Column;
+}
+
+//////////////////////////////////////////////////////////////////////
+// FQueryResult
 
 FQueryResult::FQueryResult(TArray<FString> Headers, TArray64<TArray<FDatabaseValue>> Values, TArray<FColumnMetadata> Metadata, uint64 AffectedRows)
-	: Internal(MakeShared<FQueryResultInternal, ESPMode::ThreadSafe>(
-		MoveTemp(Headers), MoveTemp(Values), MoveTemp(Metadata), AffectedRows))
+{
+	TSharedRef<FQueryResultInternal, ESPMode::ThreadSafe> Result = MakeShared<FQueryResultInternal, ESPMode::ThreadSafe>(AffectedRows);
+
+	Result->Columns.Reserve(Headers.Num());
+
+	for (int32 i = 0; i < Headers.Num(); ++i)
+	{
+		Result->Columns.Emplace(MakeColumn(Values, i));
+	}
+
+	Result->RowCount	= Values.Num();
+	Result->ColumnIndex = MakeShared<FQueryColumnIndex, ESPMode::ThreadSafe>(Headers);
+	Result->Headers		= MoveTemp(Headers);
+	Result->Metadata	= MoveTemp(Metadata);
+
+	Internal = MoveTemp(Result);
+}
+
+FQueryResult::FQueryResult(TSharedRef<const FQueryResultInternal, ESPMode::ThreadSafe> InInternal)
+	: Internal(MoveTemp(InInternal))
 {
 }
 
@@ -71,6 +407,29 @@ int64 FQueryResult::GetAffectedRows() const
 	return (int64)Internal->AffectedRows;
 }
 
+SIZE_T FQueryResult::GetAllocatedSize() const
+{
+	return Internal->GetAllocatedSize();
+}
+
+bool FQueryResult::ReadRows(const UScriptStruct* Struct, void* OutRows, const int64 FirstRow, const int64 RowCount) const
+{
+	if (!Struct || FirstRow < 0 || RowCount < 0 || FirstRow + RowCount > Internal->RowCount || (RowCount > 0 && !OutRows))
+	{
+		UE_LOG(LogDatabaseConnector, Warning, TEXT("Failed to read %lld rows from row %lld into `%s`. Dataset is of size %d/%lld."),
+			RowCount, FirstRow, Struct ? *Struct->GetName() : TEXT("None"), Internal->Headers.Num(), Internal->RowCount);
+
+		return false;
+	}
+
+	if (RowCount > 0)
+	{
+		FRowBindingPlan::Get(Struct, Internal->Headers)->Read(*Internal, OutRows, FirstRow, RowCount);
+	}
+
+	return true;
+}
+
 const TArray<FString>& FQueryResult::GetColumns() const
 {
 	return Internal->Headers;
@@ -78,12 +437,67 @@ const TArray<FString>& FQueryResult::GetColumns() const
 
 const TArray<FDatabaseValue>* FQueryResult::GetRow(const int64 RowIndex) const
 {
-	return Internal->Values.IsValidIndex(RowIndex) ? &Internal->Values[RowIndex] : nullptr;
+	if (RowIndex < 0 || RowIndex >= Internal->RowCount)
+	{
+		return nullptr;
+	}
+
+	if (!Internal->bRowsBuilt)
+	{
+		SIZE_T RowsSize = 0;
+
+		{
+			FScopeLock Lock(&Internal->RowsSection);
+
+			if (!Internal->bRowsBuilt)
+			{
+				Internal->Rows.SetNum(Internal->RowCount);
+
+				RowsSize = Internal->Rows.GetAllocatedSize();
+
+				for (int64 i = 0; i < Internal->RowCount; ++i)
+				{
+					GetRow(i, Internal->Rows[i]);
+
+					RowsSize += Internal->Rows[i].GetAllocatedSize();
+				}
+
+				Internal->bRowsBuilt = true;
+			}
+		}
+
+		// Outside of the lock as the cache locks itself.
+		if (RowsSize > 0 && Internal->OnRowsBuilt)
+		{
+			Internal->OnRowsBuilt(RowsSize);
+		}
+	}
+
+	return &Internal->Rows[RowIndex];
+}
+
+bool FQueryResult::GetRow(const int64 RowIndex, TArray<FDatabaseValue>& OutRow) const
+{
+	OutRow.Reset();
+
+	if (RowIndex < 0 || RowIndex >= Internal->RowCount)
+	{
+		return false;
+	}
+
+	OutRow.Reserve(Internal->Columns.Num());
+
+	for (const FQueryResultColumn& Column : Internal->Columns)
+	{
+		OutRow.Add(Column.GetValue(RowIndex));
+	}
+
+	return true;
 }
 
 int64 FQueryResult::GetRowCount() const
 {
-	return Internal->Values.Num();
+	return Internal->RowCount;
 }
 
 int32 FQueryResult::GetColumnCount() const
@@ -91,34 +505,79 @@ int32 FQueryResult::GetColumnCount() const
 	return Internal->Headers.Num();
 }
 
-const FDatabaseValue& FQueryResult::Get(const FString & ColumnName, const int64 RowIndex) const
+FDatabaseValue FQueryResult::Get(const FString & ColumnName, const int64 RowIndex) const
 {
-	int32 ColumnIndex = -1;
-	if (Internal->Headers.Find(ColumnName, ColumnIndex))
+	const int32 ColumnIndex = GetColumnIndex(ColumnName);
+
+	if (ColumnIndex != INDEX_NONE)
 	{
 		return Get(ColumnIndex, RowIndex);
 	}
 
 	UE_LOG(LogDatabaseConnector, Warning, TEXT("Column `%s` not found."), *ColumnName);
 
-	return FDatabaseValue::NullValue;
+	return FDatabaseValue::Null();
 }
 
-const FDatabaseValue& FQueryResult::Get(const int32 & ColumnIndex, const int64 RowIndex) const
+FDatabaseValue FQueryResult::Get(const int32 & ColumnIndex, const int64 RowIndex) const
 {
-	if (Internal->Values.IsValidIndex(RowIndex))
+	if (RowIndex >= 0 && RowIndex < Internal->RowCount && Internal->Columns.IsValidIndex(ColumnIndex))
 	{
-		const TArray<FDatabaseValue>& Row = Internal->Values[RowIndex];
-		if (Row.IsValidIndex(ColumnIndex))
-		{
-			return Row[ColumnIndex];
-		}
+		return Internal->Columns[ColumnIndex].GetValue(RowIndex);
 	}
 
-	UE_LOG(LogDatabaseConnector, Warning, TEXT("Failed to find column %d row %d. Dataset is of size %d/%d."),
-		ColumnIndex, RowIndex, Internal->Headers.Num(), Internal->Values.Num());
+	UE_LOG(LogDatabaseConnector, Warning, TEXT("Failed to find column %d row %lld. Dataset is of size %d/%lld."),
+		ColumnIndex, RowIndex, Internal->Headers.Num(), Internal->RowCount);
+
+	return FDatabaseValue::Null();
+}
+
+FDatabaseValue FQueryResult::Get(const FQueryColumnHandle& Column, const int64 RowIndex) const
+{
+	const int32 ColumnIndex = GetColumnIndex(Column);
+
+	if (ColumnIndex != INDEX_NONE)
+	{
+		return Get(ColumnIndex, RowIndex);
+	}
+
+	UE_LOG(LogDatabaseConnector, Warning, TEXT("Column `%s` not found."), *Column.ColumnName);
+
+	return FDatabaseValue::Null();
+}
+
+FQueryColumnHandle FQueryResult::GetColumnHandle(const FString& ColumnName) const
+{
+	FQueryColumnHandle Handle;
+
+	Handle.ColumnName	= ColumnName;
+	Handle.ColumnIndex	= GetColumnIndex(ColumnName);
+	Handle.LayoutHash	= Internal->ColumnIndex ? Internal->ColumnIndex->LayoutHash : 0;
 
-	return FDatabaseValue::NullValue;
+	return Handle;
+}
+
+int32 FQueryResult::GetColumnIndex(const FString& ColumnName) const
+{
+	return Internal->ColumnIndex ? Internal->ColumnIndex->Find(ColumnName) : INDEX_NONE;
+}
+
+int32 FQueryResult::GetColumnIndex(const FQueryColumnHandle& Column) const
+{
+	const FQueryColumnIndex* const ColumnIndex = Internal->ColumnIndex.Get();
+
+	if (!ColumnIndex)
+	{
+		return INDEX_NONE;
+	}
+
+	// Same columns as the result the handle was made from.
+	if (Column.LayoutHash == ColumnIndex->LayoutHash && Internal->Headers.IsValidIndex(Column.ColumnIndex))
+	{
+		return Column.ColumnIndex;
+	}
+
+	return ColumnIndex->Find(Column.ColumnName);
 }
 
 const TArray<FColumnMetadata>& FQueryResult::GetColumnsMetadata() const
@@ -138,16 +597,15 @@ const FColumnMetadata* FQueryResult::GetColumnMetadata(const int32 ColumnIndex)
 
 const FColumnMetadata* FQueryResult::GetColumnMetadata(const FString ColumnName) const
 {
-	const int32 Index = Internal->Headers.Find(ColumnName);
-
-	return GetColumnMetadata(Index);
+	return GetColumnMetadata(GetColumnIndex(ColumnName));
 }
 
 void FQueryResult::LogDump() const
 {
-	const TArray<FString>&					Headers		= Internal->Headers;
-	const TArray64<TArray<FDatabaseValue>>& Values		= Internal->Values;
-	const TArray<FColumnMetadata>&			Metadata	= Internal->Metadata;
+	const TArray<FString>&				Headers		= Internal->Headers;
+	const TArray<FQueryResultColumn>&	Columns		= Internal->Columns;
+	const TArray<FColumnMetadata>&		Metadata	= Internal->Metadata;
+	const int64							RowCount	= Internal->RowCount;
 
 	if (Headers.Num() <= 0)
 	{
@@ -177,7 +635,7 @@ void FQueryResult::LogDump() const
 
 	std::stringstream Output;
 
-	if (Values.Num() > 0)
+	if (RowCount > 0)
 	{
 		{
 			Output << Separator << "\n | ";
@@ -191,13 +649,13 @@ void FQueryResult::LogDump() const
 			Output << "\n" << Separator << "\n";
 		}
 
-		for (const TArray<FDatabaseValue>& Row : Values)
+		for (int64 Row = 0; Row < RowCount; ++Row)
 		{
 			Output << " | ";
-			for (int32 i = 0; i < Row.Num(); ++i)
+			for (int32 i = 0; i < Columns.Num(); ++i)
 			{
 				const int32 Size = GetColumnSize(i);
-				Output << TCHAR_TO_UTF8(*Row[i].ToString(false).Left(Size).RightPad(Size)) << " | ";
+				Output << TCHAR_TO_UTF8(*Columns[i].GetValue(Row).ToString(false).Left(Size).RightPad(Size)) << " | ";
 			}
 			Output << "\n";
 		}
@@ -206,9 +664,9 @@ void FQueryResult::LogDump() const
 	}
 
 	UE_LOG(LogDatabaseConnector, Log,
-		TEXT(" -> Start FQueryResult dump (%d rows, %d columns):\n")
+		TEXT(" -> Start FQueryResult dump (%lld rows, %d columns):\n")
 		TEXT(" \n")
-		TEXT("%s\n \n"), Values.Num(), Headers.Num(), UTF8_TO_TCHAR(Output.str().c_str())
+		TEXT("%s\n \n"), RowCount, Headers.Num(), UTF8_TO_TCHAR(Output.str().c_str())
 	);
 
 }
@@ -0,0 +1,133 @@
+// Copyright Pandores Marketplace 2021. All Rights Reserved.
+
+#include "Database/Transaction.h"
+
+#include "Core/OdbClient.h"
+#include "Core/TransactionState.h"
+#include "Core/CompletionQueue.h"
+#include "Core/CompletionMacros.h"
+
+#include "Async/Async.h"
+
+#include "DatabaseConnectorModule.h"
+
+UDatabaseTransaction::UDatabaseTransaction()
+	: bEnded(true)
+{
+}
+
+UDatabaseTransaction::~UDatabaseTransaction()
+{
+	// Releases the connection. Run() rolls back as we didn't commit.
+	if (State)
+	{
+		State->Finish();
+	}
+}
+
+bool UDatabaseTransaction::IsActive() const
+{
+	return !bEnded;
+}
+
+void UDatabaseTransaction::Blueprint_Query(FString Query, TArray<FDatabaseValue> Parameters, FDatabaseQueryDelegate Callback)
+{
+	UDatabaseTransaction::Query(MoveTemp(Query), MoveTemp(Parameters), FDatabaseQueryCallback::CreateLambda([Callback = MoveTemp(Callback)](EDatabaseError Error, const FQueryResult& Results) -> void
+	{
+		Callback.ExecuteIfBound(Error, Results);
+	}));
+}
+
+void UDatabaseTransaction::Query(FString Query, TArray<FDatabaseValue> Parameters, FDatabaseQueryCallback Callback)
+{
+	if (bEnded)
+	{
+		UE_LOG(LogDatabaseConnector, Error, TEXT("Can't query a transaction that has ended."));
+
+		Callback.ExecuteIfBound(EDatabaseError::TransactionEnded, FQueryResult());
+		return;
+	}
+
+	State->Enqueue([ConnectionDsn = this->ConnectionDsn, Completions = this->Completions, LAMBDA_MOVE_TEMP(Query), LAMBDA_MOVE_TEMP(Parameters), LAMBDA_MOVE_TEMP(Callback)](FConnection* const Connection) mutable -> void
+	{
+		EDatabaseError Error = EDatabaseError::TransactionEnded;
+
+		FQueryResult Result;
+
+		if (Connection)
+		{
+			Result = Connection->Query(Query, *ConnectionDsn, Parameters, Error);
+		}
+		else
+		{
+			UE_LOG(LogDatabaseConnector, Error, TEXT("Can't query a transaction that was rolled back."));
+		}
+
+		// Go back to Game Thread for our callback.
+		START_GAME_THREAD_COMPLETION(Completions, Error, LAMBDA_MOVE_TEMP(Result), LAMBDA_MOVE_TEMP(Callback));
+
+		Callback.ExecuteIfBound(Error, Result);
+
+		END_GAME_THREAD_COMPLETION(); // Game Thread.
+	});
+}
+
+void UDatabaseTransaction::Commit(FDatabaseTransactionEndCallback Callback)
+{
+	End(true, MoveTemp(Callback));
+}
+
+void UDatabaseTransaction::Rollback(FDatabaseTransactionEndCallback Callback)
+{
+	End(false, MoveTemp(Callback));
+}
+
+void UDatabaseTransaction::Blueprint_Commit(FDatabaseTransactionEndDelegate Callback)
+{
+	Commit(FDatabaseTransactionEndCallback::CreateLambda([Callback = MoveTemp(Callback)](EDatabaseError Error) -> void
+	{
+		Callback.ExecuteIfBound(Error);
+	}));
+}
+
+void UDatabaseTransaction::Blueprint_Rollback(FDatabaseTransactionEndDelegate Callback)
+{
+	Rollback(FDatabaseTransactionEndCallback::CreateLambda([Callback = MoveTemp(Callback)](EDatabaseError Error) -> void
+	{
+		Callback.ExecuteIfBound(Error);
+	}));
+}
+
+void UDatabaseTransaction::End(const bool bCommit, FDatabaseTransactionEndCallback&& Callback)
+{
+	if (bEnded)
+	{
+		UE_LOG(LogDatabaseConnector, Error, TEXT("Transaction has already ended."));
+
+		Callback.ExecuteIfBound(EDatabaseError::TransactionEnded);
+		return;
+	}
+
+	bEnded = true;
+
+	State->Enqueue([Completions = this->Completions, bCommit, LAMBDA_MOVE_TEMP(Callback)](FConnection* const Connection) mutable -> void
+	{
+		EDatabaseError Error = EDatabaseError::TransactionEnded;
+
+		if (Connection)
+		{
+			Connection->EndTransaction(bCommit, Error);
+		}
+
+		if (Callback.IsBound())
+		{
+			START_GAME_THREAD_COMPLETION(Completions, Error, LAMBDA_MOVE_TEMP(Callback));
+
+			Callback.ExecuteIfBound(Error);
+
+			END_GAME_THREAD_COMPLETION(); // Game Thread.
+		}
+	});
+
+	State->Finish();
+}
@@ -2,21 +2,14 @@
 
 #include "Database/Value.h"
 
-THIRD_PARTY_INCLUDES_START
-#	include <variant>
-#	include <nanodbc/nanodbc.h>
-THIRD_PARTY_INCLUDES_END
-
-#include "Database/Core/DatabaseValueInternal.h"
-
 DEFINE_LOG_CATEGORY(LogDatabaseValue);
 
 const FDatabaseValue FDatabaseValue::NullValue;
 
 FDatabaseValue::FDatabaseValue()
-	: Internal(MakeUnique<FDatabaseValueInternal>())
+	: Type(EDatabaseValueType::Null)
 {
-	Internal->Get() = FNullValue();
+	Scalar.Int64 = 0;
 }
 
 /* static */ FDatabaseValue FDatabaseValue::Null()
@@ -24,63 +17,56 @@ FDatabaseValue::FDatabaseValue()
 	return FDatabaseValue();
 }
 
-FDatabaseValue::FDatabaseValue(const FDatabaseValue& Other)
-	: FDatabaseValue()
-{
-	*this = Other;
-}
+FDatabaseValue::FDatabaseValue(const FDatabaseValue& Other) = default;
 
-FDatabaseValue::FDatabaseValue(FDatabaseValue&& Other) 
-	: Internal(MoveTemp(Other.Internal))
-{}
+FDatabaseValue::FDatabaseValue(FDatabaseValue&& Other) = default;
 
 FDatabaseValue::~FDatabaseValue() = default;
 
-FDatabaseValue& FDatabaseValue::operator=(FDatabaseValue&& Other)
-{
-	Internal = MoveTemp(Other.Internal);
-	return *this;
-}
+FDatabaseValue& FDatabaseValue::operator=(FDatabaseValue&& Other) = default;
 
-FDatabaseValue& FDatabaseValue::operator=(const FDatabaseValue& Other)
-{
-	Internal->Get() = Other.Internal->Get();
-	return *this;
-}
+FDatabaseValue& FDatabaseValue::operator=(const FDatabaseValue& Other) = default;
 
 FDatabaseValue::FDatabaseValue(bool bValue) : FDatabaseValue()
 {
-	Internal->Get() = FValue(bValue);
+	Type			= EDatabaseValueType::Boolean;
+	Scalar.bBoolean = bValue;
 }
 
 FDatabaseValue::FDatabaseValue(const FDatabaseTimestamp& Value) : FDatabaseValue()
 {
-	Internal->Get().operator=(Value);
+	Type			 = EDatabaseValueType::Timestamp;
+	Scalar.Timestamp = Value;
 }
 
 FDatabaseValue::FDatabaseValue(uint8 Value) : FDatabaseValue()
 {
-	Internal->Get().operator=(FValue(Value));
+	Type		 = EDatabaseValueType::Uint8;
+	Scalar.Uint8 = Value;
 }
 
 FDatabaseValue::FDatabaseValue(int32 Value) : FDatabaseValue()
 {
-	Internal->Get().operator=(FValue(Value));
+	Type		 = EDatabaseValueType::Int32;
+	Scalar.Int32 = Value;
 }
 
 FDatabaseValue::FDatabaseValue(int64 Value) : FDatabaseValue()
 {
-	Internal->Get().operator=(FValue(Value));
+	Type		 = EDatabaseValueType::Int64;
+	Scalar.Int64 = Value;
 }
 
 FDatabaseValue::FDatabaseValue(double Value) : FDatabaseValue()
 {
-	Internal->Get().operator=(Value);
+	Type		  = EDatabaseValueType::Double;
+	Scalar.Double = Value;
 }
 
 FDatabaseValue::FDatabaseValue(FString Value) : FDatabaseValue()
 {
-	Internal->Get().operator=(MoveTemp(Value));
+	Type   = EDatabaseValueType::String;
+	String = MoveTemp(Value);
 }
 
 FDatabaseValue::FDatabaseValue(const TCHAR* Value)
@@ -90,25 +76,25 @@ FDatabaseValue::FDatabaseValue(const TCHAR* Value)
 
 FDatabaseValue::FDatabaseValue(const FDatabaseDate& Date) : FDatabaseValue()
 {
-	Internal->Get() = Date;
+	Type		= EDatabaseValueType::Date;
+	Scalar.Date = Date;
 }
 
 FDatabaseValue::operator uint8()	const
 {
-	const EDatabaseValueType Type = GetType();
 	switch (Type)
 	{
-	case EDatabaseValueType::Uint8:		return std::get<uint8>	(Internal->Get());
-	case EDatabaseValueType::Boolean:	return std::get<bool>		(Internal->Get());
+	case EDatabaseValueType::Uint8:		return Scalar.Uint8;
+	case EDatabaseValueType::Boolean:	return Scalar.bBoolean;
 	case EDatabaseValueType::Int32:		
 		UE_LOG(LogDatabaseValue, Warning, TEXT("Converted a database value from int32 to uint8."));
-		return std::get<int32>	(Internal->Get());
+		return Scalar.Int32;
 	case EDatabaseValueType::Int64:		
 		UE_LOG(LogDatabaseValue, Warning, TEXT("Converted a database value from int64 to uint8."));
-		return std::get<int64>	(Internal->Get());
+		return Scalar.Int64;
 	case EDatabaseValueType::Double:	
 		UE_LOG(LogDatabaseValue, Warning, TEXT("Converted a database value from double to uint8."));
-		return std::get<double>	(Internal->Get());
+		return Scalar.Double;
 	}
 	
 	UE_LOG(LogDatabaseValue, Error, TEXT("Converted a database value to uint8 but the type isn't numeric."));
@@ -118,18 +104,17 @@ FDatabaseValue::operator uint8()	const
 
 FDatabaseValue::operator int32()	const
 {
-	const EDatabaseValueType Type = GetType();
 	switch (Type)
 	{
-	case EDatabaseValueType::Uint8:		return std::get<uint8>(Internal->Get());
-	case EDatabaseValueType::Boolean:	return std::get<bool> (Internal->Get());
-	case EDatabaseValueType::Int32:		return std::get<int32>(Internal->Get());
+	case EDatabaseValueType::Uint8:		return Scalar.Uint8;
+	case EDatabaseValueType::Boolean:	return Scalar.bBoolean;
+	case EDatabaseValueType::Int32:		return Scalar.Int32;
 	case EDatabaseValueType::Int64:
 		UE_LOG(LogDatabaseValue, Warning, TEXT("Converted a database value from int64 to int32."));
-		return std::get<int64>(Internal->Get());
+		return Scalar.Int64;
 	case EDatabaseValueType::Double:
 		UE_LOG(LogDatabaseValue, Warning, TEXT("Converted a database value from double to int32."));
-		return std::get<double>(Internal->Get());
+		return Scalar.Double;
 	}
 
 	UE_LOG(LogDatabaseValue, Error, TEXT("Converted a database value to int32 but the type isn't numeric."));
@@ -139,16 +124,15 @@ FDatabaseValue::operator int32()	const
 
 FDatabaseValue::operator int64()	const
 {
-	const EDatabaseValueType Type = GetType();
 	switch (Type)
 	{
-	case EDatabaseValueType::Uint8:		return std::get<uint8>(Internal->Get());
-	case EDatabaseValueType::Boolean:	return std::get<bool> (Internal->Get());
-	case EDatabaseValueType::Int32:		return std::get<int32>(Internal->Get());
-	case EDatabaseValueType::Int64:		return std::get<int64>(Internal->Get());
+	case EDatabaseValueType::Uint8:		return Scalar.Uint8;
+	case EDatabaseValueType::Boolean:	return Scalar.bBoolean;
+	case EDatabaseValueType::Int32:		return Scalar.Int32;
+	case EDatabaseValueType::Int64:		return Scalar.Int64;
 	case EDatabaseValueType::Double:
 		UE_LOG(LogDatabaseValue, Warning, TEXT("Converted a database value from double to int64."));
-		return std::get<double>(Internal->Get());
+		return Scalar.Double;
 	}
 
 	UE_LOG(LogDatabaseValue, Error, TEXT("Converted a database value to int64 but the type isn't numeric."));
@@ -163,14 +147,13 @@ FDatabaseValue::operator float()	const
 
 FDatabaseValue::operator double()	const
 {
-	const EDatabaseValueType Type = GetType();
 	switch (Type)
 	{
-	case EDatabaseValueType::Uint8:		return std::get<uint8> (Internal->Get());
-	case EDatabaseValueType::Boolean:	return std::get<bool>  (Internal->Get());
-	case EDatabaseValueType::Int32:		return std::get<int32> (Internal->Get());
-	case EDatabaseValueType::Int64:		return std::get<int64> (Internal->Get());
-	case EDatabaseValueType::Double:	return std::get<double>(Internal->Get());
+	case EDatabaseValueType::Uint8:		return Scalar.Uint8;
+	case EDatabaseValueType::Boolean:	return Scalar.bBoolean;
+	case EDatabaseValueType::Int32:		return Scalar.Int32;
+	case EDatabaseValueType::Int64:		return Scalar.Int64;
+	case EDatabaseValueType::Double:	return Scalar.Double;
 	}
 
 	UE_LOG(LogDatabaseValue, Error, TEXT("Converted a database value to double but the type isn't numeric."));
@@ -185,41 +168,39 @@ FDatabaseValue::operator FString()	const
 
 FString FDatabaseValue::ToString(bool bWarn) const
 {
-	const EDatabaseValueType Type = GetType();
-
 	switch (Type)
 	{
 	case EDatabaseValueType::Uint8:		
 		if (bWarn) UE_LOG(LogDatabaseValue, Warning, TEXT("Converted a database value from uint8 to FString."));
-		return FString::Printf(TEXT("%f"), std::get<uint8>(Internal->Get()));
+		return FString::Printf(TEXT("%d"), Scalar.Uint8);
 	case EDatabaseValueType::Boolean:	
 		if (bWarn) UE_LOG(LogDatabaseValue, Warning, TEXT("Converted a database value from boolean to FString."));
-		return FString::Printf(TEXT("%s"), std::get<bool>(Internal->Get()) ? TEXT("true") : TEXT("false"));
+		return FString::Printf(TEXT("%s"), Scalar.bBoolean ? TEXT("true") : TEXT("false"));
 	case EDatabaseValueType::Int32:		
 		if (bWarn) UE_LOG(LogDatabaseValue, Warning, TEXT("Converted a database value from int32 to FString."));
-		return FString::Printf(TEXT("%d"), std::get<int32>(Internal->Get()));
+		return FString::Printf(TEXT("%d"), Scalar.Int32);
 	case EDatabaseValueType::Int64:		
 		if (bWarn) UE_LOG(LogDatabaseValue, Warning, TEXT("Converted a database value from int64 to FString."));
-		return FString::Printf(TEXT("%lld"), std::get<int64>(Internal->Get()));
+		return FString::Printf(TEXT("%lld"), Scalar.Int64);
 	case EDatabaseValueType::Double:
 		if (bWarn) UE_LOG(LogDatabaseValue, Warning, TEXT("Converted a database value from double to FString."));
-		return FString::Printf(TEXT("%f"), std::get<double>(Internal->Get()));
+		return FString::Printf(TEXT("%f"), Scalar.Double);
 	case EDatabaseValueType::Timestamp:
 	{
 		if (bWarn) UE_LOG(LogDatabaseValue, Warning, TEXT("Converted a database value from double to FDatabaseTimestamp."));
-		const FDatabaseTimestamp Timestamp = std::get<FDatabaseTimestamp>(Internal->Get());
+		const FDatabaseTimestamp& Timestamp = Scalar.Timestamp;
 		return FString::Printf(TEXT("%04d-%02d-%02d %02d:%02d:%02d"),
 			Timestamp.Year, Timestamp.Month, Timestamp.Day, Timestamp.Hour, Timestamp.Minute, Timestamp.Second);
 	}
 	case EDatabaseValueType::Date:
 	{
 		if (bWarn) UE_LOG(LogDatabaseValue, Warning, TEXT("Converted a database value from double to FDatabaseTimestamp."));
-		const FDatabaseDate Timestamp = std::get<FDatabaseDate>(Internal->Get());
+		const FDatabaseDate& Timestamp = Scalar.Date;
 		return FString::Printf(TEXT("%04d-%02d-%02d"),
 			Timestamp.Year, Timestamp.Month, Timestamp.Day);
 	}
 	case EDatabaseValueType::String:
-		return std::get<FString>(Internal->Get());
+		return String;
 	case EDatabaseValueType::Null:
 		return TEXT("NULL");
 	}
@@ -229,11 +210,75 @@ FString FDatabaseValue::ToString(bool bWarn) const
 	return TEXT("");
 }
 
+bool FDatabaseValue::operator==(const FDatabaseValue& Other) const
+{
+	if (Type != Other.Type)
+	{
+		return false;
+	}
+
+	switch (Type)
+	{
+	case EDatabaseValueType::Null:		return true;
+	case EDatabaseValueType::Boolean:	return Scalar.bBoolean == Other.Scalar.bBoolean;
+	case EDatabaseValueType::Uint8:		return Scalar.Uint8	 == Other.Scalar.Uint8;
+	case EDatabaseValueType::Int32:		return Scalar.Int32	 == Other.Scalar.Int32;
+	case EDatabaseValueType::Int64:		return Scalar.Int64	 == Other.Scalar.Int64;
+	// Compared as bits like they are hashed: a NaN parameter still matches its own cache entry.
+	case EDatabaseValueType::Double:	return FMemory::Memcmp(&Scalar.Double, &Other.Scalar.Double, sizeof(double)) == 0;
+	case EDatabaseValueType::String:	return String.Equals(Other.String, ESearchCase::CaseSensitive);
+	case EDatabaseValueType::Timestamp:
+	{
+		const FDatabaseTimestamp& A = Scalar.Timestamp;
+		const FDatabaseTimestamp& B = Other.Scalar.Timestamp;
+		return A.Year == B.Year && A.Month == B.Month && A.Day == B.Day 
+			&& A.Hour == B.Hour && A.Minute == B.Minute && A.Second == B.Second && A.Fract == B.Fract;
+	}
+	case EDatabaseValueType::Date:
+	{
+		const FDatabaseDate& A = Scalar.Date;
+		const FDatabaseDate& B = Other.Scalar.Date;
+		return A.Year == B.Year && A.Month == B.Month && A.Day == B.Day;
+	}
+	}
+
+	return false;
+}
+
+uint32 GetTypeHash(const FDatabaseValue& Value)
+{
+	const uint32 TypeHash = GetTypeHash((uint8)Value.Type);
+
+	switch (Value.Type)
+	{
+	case EDatabaseValueType::Boolean:	return HashCombine(TypeHash, GetTypeHash((uint8)Value.Scalar.bBoolean));
+	case EDatabaseValueType::Uint8:		return HashCombine(TypeHash, GetTypeHash(Value.Scalar.Uint8));
+	case EDatabaseValueType::Int32:		return HashCombine(TypeHash, GetTypeHash(Value.Scalar.Int32));
+	case EDatabaseValueType::Int64:		return HashCombine(TypeHash, GetTypeHash(Value.Scalar.Int64));
+	case EDatabaseValueType::Double:	return HashCombine(TypeHash, GetTypeHash(Value.Scalar.Double));
+	case EDatabaseValueType::String:	return HashCombine(TypeHash, GetTypeHash(Value.String));
+	case EDatabaseValueType::Timestamp:
+	{
+		const FDatabaseTimestamp& Timestamp = Value.Scalar.Timestamp;
+		const uint32 DayHash  = HashCombine(GetTypeHash(Timestamp.Year), GetTypeHash(Timestamp.Month * 32 + Timestamp.Day));
+		const uint32 TimeHash = HashCombine(GetTypeHash((Timestamp.Hour * 60 + Timestamp.Minute) * 60 + Timestamp.Second), GetTypeHash(Timestamp.Fract));
+		return HashCombine(TypeHash, HashCombine(DayHash, TimeHash));
+	}
+	case EDatabaseValueType::Date:
+	{
+		const FDatabaseDate& Date = Value.Scalar.Date;
+		return HashCombine(TypeHash, HashCombine(GetTypeHash(Date.Year), GetTypeHash(Date.Month * 32 + Date.Day)));
+	}
+	}
+
+	return TypeHash;
+}
+
 FDatabaseValue::operator FDatabaseTimestamp() const
 {
-	if (GetType() == EDatabaseValueType::Timestamp)
+	if (Type == EDatabaseValueType::Timestamp)
 	{
-		return std::get<FDatabaseTimestamp>(Internal->Get());
+		return Scalar.Timestamp;
 	}
 
 	UE_LOG(LogDatabaseValue, Error, TEXT("Converted a database value to FDatabaseTimestamp but the type isn't convertible."));
@@ -243,9 +288,9 @@ FDatabaseValue::operator FDatabaseTimestamp() const
 
 FDatabaseValue::operator FDatabaseDate()	const
 {
-	if (GetType() == EDatabaseValueType::Date)
+	if (Type == EDatabaseValueType::Date)
 	{
-		return std::get<FDatabaseDate>(Internal->Get());
+		return Scalar.Date;
 	}
 
 	UE_LOG(LogDatabaseValue, Error, TEXT("Converted a database value to FDatabaseDate but the type isn't convertible."));
@@ -253,31 +298,6 @@ FDatabaseValue::operator FDatabaseDate()	const
 	return FDatabaseDate();
 }
 
-EDatabaseValueType FDatabaseValue::GetType() const
-{
-	class FVariantTypeVisitor
-	{
-	public:
-		EDatabaseValueType Type;
-	public:
-#		define MakeVisitorFunc(InType, Value)					\
-			void operator()(const InType&) { Type = Value; }	
-		MakeVisitorFunc(uint8,				EDatabaseValueType::Uint8);
-		MakeVisitorFunc(int32,				EDatabaseValueType::Int32);
-		MakeVisitorFunc(int64,				EDatabaseValueType::Int64);
-		MakeVisitorFunc(double,				EDatabaseValueType::Double);
-		MakeVisitorFunc(FString,			EDatabaseValueType::String);
-		MakeVisitorFunc(FNullValue,			EDatabaseValueType::Null);
-		MakeVisitorFunc(FDatabaseDate,		EDatabaseValueType::Date);
-		MakeVisitorFunc(FDatabaseTimestamp,	EDatabaseValueType::Timestamp);
-#		undef MakeVisitorFunc
-	} Visitor;
-
-	std::visit(Visitor, Internal->Get());
-
-	return Visitor.Type;
-}
-
 FDatabaseDate FDatabaseDate::Now()
 {
 	const FDateTime Current = FDateTime::Now();
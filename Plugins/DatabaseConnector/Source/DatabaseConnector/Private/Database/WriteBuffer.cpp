@@ -0,0 +1,314 @@
+// Copyright Pandores Marketplace 2021. All Rights Reserved.
+
+#include "Database/WriteBuffer.h"
+
+#include "Core/CompletionMacros.h"
+
+#include "Misc/CoreDelegates.h"
+#include "HAL/Event.h"
+
+#include "DatabaseConnectorModule.h"
+
+/**
+ * Signaled by the pool's thread once a flush is executed, so synchronous flushes are applied after it.
+*/
+struct FDatabaseFlushCompletion
+{
+	FDatabaseFlushCompletion()
+		: Executed(FPlatformProcess::GetSynchEventFromPool(true))
+	{
+	}
+
+	~FDatabaseFlushCompletion()
+	{
+		FPlatformProcess::ReturnSynchEventToPool(Executed);
+	}
+
+	FEvent* const Executed;
+};
+
+UDatabaseWriteBuffer::UDatabaseWriteBuffer()
+	: Pool(nullptr)
+	, PendingCount(0)
+	, RejectedCount(0)
+	, RecentRejectedCount(0)
+	, bFlushing(false)
+{
+}
+
+void UDatabaseWriteBuffer::Initialize(UDatabasePool* InPool, const FDatabaseWriteBufferSettings& InSettings)
+{
+	Pool	 = InPool;
+	Settings = InSettings;
+
+	if (Settings.FlushInterval > 0.f)
+	{
+#if ENGINE_MAJOR_VERSION > 4
+		FlushHandle = FTSTicker::GetCoreTicker().AddTicker(
+#else
+		FlushHandle = FTicker::GetCoreTicker().AddTicker(
+#endif
+			FTickerDelegate::CreateUObject(this, &UDatabaseWriteBuffer::TickFlush), Settings.FlushInterval);
+	}
+
+	PreExitHandle = FCoreDelegates::OnPreExit.AddUObject(this, &UDatabaseWriteBuffer::OnPreExit);
+}
+
+void UDatabaseWriteBuffer::BeginDestroy()
+{
+	if (FlushHandle.IsValid())
+	{
+#if ENGINE_MAJOR_VERSION > 4
+		FTSTicker::GetCoreTicker().RemoveTicker(FlushHandle);
+#else
+		FTicker::GetCoreTicker().RemoveTicker(FlushHandle);
+#endif
+		FlushHandle.Reset();
+	}
+
+	FCoreDelegates::OnPreExit.Remove(PreExitHandle);
+
+	if (PendingCount > 0)
+	{
+		// The pool's threads would drop the writes if it is collected with us.
+		if (IsValid(Pool) && !Pool->IsUnreachable() && !Pool->HasAnyFlags(RF_BeginDestroyed))
+		{
+			const int32 WriteCount = PendingCount;
+
+			// Sent without waiting as flushing would block the garbage collection on the database.
+			// They wait for the running flush on the pool's thread so writes are still applied in order.
+			Pool->ExecuteBatches(TakePending(), FDatabaseQueryCallback::CreateLambda([WriteCount](EDatabaseError Error, const FQueryResult& Result) -> void
+			{
+				if (Error != EDatabaseError::None)
+				{
+					UE_LOG(LogDatabaseConnector, Error, TEXT("Failed to flush %d writes. They have been dropped."), WriteCount);
+				}
+			}), FDatabaseQueryOptions(Settings.Priority), [PreviousFlush = RunningFlush]() -> void
+			{
+				if (PreviousFlush)
+				{
+					PreviousFlush->Executed->Wait();
+				}
+			}, TUniqueFunction<void()>());
+		}
+		else
+		{
+			UE_LOG(LogDatabaseConnector, Warning, TEXT("Write buffer destroyed with its pool with %d pending writes. They have been dropped."), PendingCount);
+		}
+	}
+
+	Super::BeginDestroy();
+}
+
+bool UDatabaseWriteBuffer::Write(const FString& Query, const TArray<FDatabaseValue>& Parameters, const FString& Key)
+{
+	const int32* const BatchIndex = BatchIndices.Find(Query);
+
+	if (BatchIndex)
+	{
+		FDatabaseBatch& Batch = Batches[*BatchIndex];
+
+		// It would fail the whole flush.
+		if (Batch.Rows.Num() > 0 && Batch.Rows[0].Num() != Parameters.Num())
+		{
+			UE_LOG(LogDatabaseConnector, Error, TEXT("All the writes of a statement must have the same number of parameters. Expected %d, got %d."), Batch.Rows[0].Num(), Parameters.Num());
+			return false;
+		}
+
+		if (!Key.IsEmpty())
+		{
+			if (const int32* const Row = KeyedRows.Find(TPair<int32, FString>(*BatchIndex, Key)))
+			{
+				Batch.Rows[*Row] = Parameters;
+				return true;
+			}
+		}
+	}
+
+	if (PendingCount >= Settings.MaxPendingWrites)
+	{
+		++RejectedCount;
+		++RecentRejectedCount;
+		return false;
+	}
+
+	int32 Index = INDEX_NONE;
+
+	if (BatchIndex)
+	{
+		Index = *BatchIndex;
+	}
+	else
+	{
+		Index = Batches.AddDefaulted();
+
+		Batches[Index].Query = Query;
+
+		BatchIndices.Add(Query, Index);
+	}
+
+	const int32 Row = Batches[Index].Rows.Add(Parameters);
+
+	if (!Key.IsEmpty())
+	{
+		KeyedRows.Add(TPair<int32, FString>(Index, Key), Row);
+	}
+
+	++PendingCount;
+
+	if (PendingCount >= Settings.FlushThreshold)
+	{
+		StartFlush();
+	}
+
+	return true;
+}
+
+void UDatabaseWriteBuffer::Blueprint_Flush(FDatabaseQueryDelegate Callback)
+{
+	Flush(FDatabaseQueryCallback::CreateLambda([Callback = MoveTemp(Callback)](EDatabaseError Error, const FQueryResult& Result) -> void
+	{
+		Callback.ExecuteIfBound(Error, Result);
+	}));
+}
+
+void UDatabaseWriteBuffer::Flush(FDatabaseQueryCallback Callback)
+{
+	FlushCallbacks.Emplace(MoveTemp(Callback));
+
+	StartFlush();
+}
+
+void UDatabaseWriteBuffer::FlushSync(EDatabaseError& OutError)
+{
+	OutError = EDatabaseError::None;
+
+	if (!Pool)
+	{
+		return;
+	}
+
+	// Its writes were queued first, and all of them are expected to be applied once we return.
+	if (RunningFlush)
+	{
+		RunningFlush->Executed->Wait();
+	}
+
+	if (PendingCount <= 0)
+	{
+		return;
+	}
+
+	const int32 WriteCount = PendingCount;
+
+	Pool->ExecuteBatchesSync(TakePending(), OutError);
+
+	if (OutError != EDatabaseError::None)
+	{
+		UE_LOG(LogDatabaseConnector, Error, TEXT("Failed to flush %d writes. They have been dropped."), WriteCount);
+	}
+}
+
+int32 UDatabaseWriteBuffer::GetPendingCount() const
+{
+	return PendingCount;
+}
+
+int64 UDatabaseWriteBuffer::GetRejectedCount() const
+{
+	return RejectedCount;
+}
+
+void UDatabaseWriteBuffer::StartFlush()
+{
+	if (bFlushing || !Pool)
+	{
+		return;
+	}
+
+	if (RecentRejectedCount > 0)
+	{
+		UE_LOG(LogDatabaseConnector, Warning, TEXT("Write buffer full: %d writes have been dropped since the last flush."), RecentRejectedCount);
+
+		RecentRejectedCount = 0;
+	}
+
+	TArray<FDatabaseQueryCallback> Callbacks = MoveTemp(FlushCallbacks);
+
+	FlushCallbacks.Reset();
+
+	if (PendingCount <= 0)
+	{
+		for (const FDatabaseQueryCallback& Callback : Callbacks)
+		{
+			Callback.ExecuteIfBound(EDatabaseError::None, FQueryResult(0));
+		}
+
+		return;
+	}
+
+	const int32 WriteCount = PendingCount;
+
+	bFlushing	 = true;
+	RunningFlush = MakeShared<FDatabaseFlushCompletion, ESPMode::ThreadSafe>();
+
+	Pool->ExecuteBatches(TakePending(), FDatabaseQueryCallback::CreateLambda(
+		[WeakThis = TWeakObjectPtr<UDatabaseWriteBuffer>(this), LAMBDA_MOVE_TEMP(Callbacks), WriteCount](EDatabaseError Error, const FQueryResult& Result) -> void
+	{
+		if (Error != EDatabaseError::None)
+		{
+			UE_LOG(LogDatabaseConnector, Error, TEXT("Failed to flush %d writes. They have been dropped."), WriteCount);
+		}
+
+		for (const FDatabaseQueryCallback& Callback : Callbacks)
+		{
+			Callback.ExecuteIfBound(Error, Result);
+		}
+
+		UDatabaseWriteBuffer* const This = WeakThis.Get();
+
+		if (!This)
+		{
+			return;
+		}
+
+		This->bFlushing = false;
+		This->RunningFlush.Reset();
+
+		// Writes queued meanwhile that reached the threshold, or were asked to be flushed.
+		if (This->PendingCount >= This->Settings.FlushThreshold || This->FlushCallbacks.Num() > 0)
+		{
+			This->StartFlush();
+		}
+	}), FDatabaseQueryOptions(Settings.Priority), TUniqueFunction<void()>(), [Completion = RunningFlush]() -> void
+	{
+		Completion->Executed->Trigger();
+	});
+}
+
+TArray<FDatabaseBatch> UDatabaseWriteBuffer::TakePending()
+{
+	TArray<FDatabaseBatch> Pending = MoveTemp(Batches);
+
+	Batches		.Reset();
+	BatchIndices.Reset();
+	KeyedRows	.Reset();
+
+	PendingCount = 0;
+
+	return Pending;
+}
+
+bool UDatabaseWriteBuffer::TickFlush(float DeltaTime)
+{
+	StartFlush();
+
+	return true;
+}
+
+void UDatabaseWriteBuffer::OnPreExit()
+{
+	EDatabaseError Error;
+
+	FlushSync(Error);
+}
@@ -3,6 +3,7 @@
 #include "DatabaseConnectorModule.h"
 
 DEFINE_LOG_CATEGORY(LogDatabaseConnector);
+DEFINE_LOG_CATEGORY(LogDatabaseSlowQuery);
 
 #define LOCTEXT_NAMESPACE "FDatabaseConnectorModule"
 
@@ -0,0 +1,25 @@
+// Copyright Pandores Marketplace 2021. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Database/Value.h"
+
+/**
+ * A statement executed once per row of parameters.
+*/
+struct FDatabaseBatch
+{
+	FDatabaseBatch() = default;
+	FDatabaseBatch(FString InQuery, TArray<TArray<FDatabaseValue>> InRows)
+		: Query(MoveTemp(InQuery))
+		, Rows(MoveTemp(InRows))
+	{}
+
+	FString Query;
+
+	/**
+	 * The parameters of each execution. All rows must have the same number of parameters.
+	*/
+	TArray<TArray<FDatabaseValue>> Rows;
+};
@@ -5,6 +5,8 @@
 #include "CoreMinimal.h"
 
 class FConnectionPool;
+class FQueryResultCache;
 
-using FConnectionPoolPtr = TSharedPtr<FConnectionPool, ESPMode::ThreadSafe>;
+using FConnectionPoolPtr   = TSharedPtr<FConnectionPool,   ESPMode::ThreadSafe>;
+using FQueryResultCachePtr = TSharedPtr<FQueryResultCache, ESPMode::ThreadSafe>;
 
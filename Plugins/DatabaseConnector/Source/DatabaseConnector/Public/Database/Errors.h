@@ -13,7 +13,12 @@ enum class EDatabaseError : uint8
 	InvalidPoolSize,
 	FailedToOpenConnection,
 	QueryFailed,
-	ConnectionClosed
+	ConnectionClosed,
+	TransactionEnded,
+	Timeout,
+	Cancelled,
+	/* The database failed repeatedly: queries fail right away until it answers again. */
+	Unavailable
 };
 
 
@@ -8,16 +8,35 @@
 #include "Database/Errors.h"
 #include "Database/Value.h"
 #include "Database/QueryResult.h"
+#include "Database/PoolSettings.h"
+#include "Database/QueryOptions.h"
+#include "Database/QueryCancellation.h"
+#include "Database/PoolStats.h"
+#include "Database/Batch.h"
+#include "Containers/Ticker.h"
+#include "Templates/Atomic.h"
+#include "Runtime/Launch/Resources/Version.h"
 #include "Pool.generated.h"
 
 class UDatabasePool;
+class UDatabaseTransaction;
+class UDatabaseWriteBuffer;
+struct FInFlightQueries;
+struct FQueryStreamState;
+class FAsyncQueryExecutor;
+class FDatabaseCompletionQueue;
 
 DECLARE_DELEGATE_TwoParams (FDatabasePoolCallback,	EDatabaseError /* Error */, UDatabasePool* /* Pool */);
 DECLARE_DELEGATE_TwoParams (FDatabaseQueryCallback,	EDatabaseError /* Error */, const FQueryResult& /* Results */);
 DECLARE_DELEGATE_FourParams(FPoolReconnectCallback,	EDatabaseError /* Error */, int32 /* ReconnectedCount */, int32 /* SkippedCount */, int32 /* FailedCount */);
+DECLARE_DELEGATE_TwoParams (FDatabaseTransactionCallback,	EDatabaseError /* Error */, UDatabaseTransaction* /* Transaction */);
+DECLARE_DELEGATE_OneParam  (FDatabaseTransactionEndCallback,	EDatabaseError /* Error */);
+DECLARE_DELEGATE_RetVal_ThreeParams(bool, FDatabaseQueryChunkCallback, EDatabaseError /* Error */, const FQueryResult& /* Chunk */, bool /* bIsLastChunk */);
 
 DECLARE_DYNAMIC_DELEGATE_TwoParams(FDatabasePoolDelegate,	EDatabaseError, Error, UDatabasePool*, Pool);
 DECLARE_DYNAMIC_DELEGATE_TwoParams(FDatabaseQueryDelegate,	EDatabaseError, Error, const FQueryResult&, Results);
+DECLARE_DYNAMIC_DELEGATE_TwoParams(FDatabaseTransactionDelegate,	EDatabaseError, Error, UDatabaseTransaction*, Transaction);
+DECLARE_DYNAMIC_DELEGATE_OneParam (FDatabaseTransactionEndDelegate,	EDatabaseError, Error);
 
 /**
  * A pool containing clients used to communicate via ODBC to a database.
@@ -43,6 +62,26 @@ private:
 	*/
 	static FString ThreadName;
 
+	/**
+	 * Name of the threads running Critical queries.
+	*/
+	static FString CriticalThreadName;
+
+	/**
+	 * Name of the threads holding transactions.
+	*/
+	static FString TransactionThreadName;
+
+	/**
+	 * The number of chunks a stream can have fetched but not yet consumed by the Game Thread.
+	*/
+	static constexpr int32 MaxStreamChunksInFlight = 2;
+
+	/**
+	 * How often the pool looks for idle connections to close, check or renew, in seconds.
+	*/
+	static constexpr float MaintenanceInterval = 5.f;
+
 public:
 	/**
 	 * Don't use NewObject on this class. RAII is not implemented in the constructor
@@ -93,12 +132,83 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Database|Pool", Meta = (DisplayName = "Create Pool with Callback"))
 	static void Blueprint_CreatePool(const FString& DriverName, const FString& Username, const FString& Password, const FString& Server, const int32 Port, const FString& Database, const int32 PoolSize, FDatabasePoolDelegate Callback);
 
+	/**
+	 * Creates a new pool asynchronously, with connections opened on demand.
+	 * @param DriverName	The driver to use, previously installed on your machine.
+	 * @param Username		The username used to connect to your database.
+	 * @param Password		The password used to connect to your database. Leave empty for none.
+	 * @param Server		The URL where your database is.
+	 * @param Port			The port to access the database on your server.
+	 * @param Database		The name of the database to access.
+	 * @param Settings		How the pool sizes its connections and threads.
+	 * @param Callback		Called when the pool has been created.
+	*/
+	static void CreatePool(const FString& DriverName, const FString& Username, const FString& Password, const FString& Server, const int32 Port, const FString& Database, const FDatabasePoolSettings& Settings, FDatabasePoolCallback Callback);
+
+	/**
+	 * Creates a new pool synchronously, with connections opened on demand.
+	 * /!\ The application will block until the minimum number of connections are established /!\
+	 * @param DriverName	The driver to use, previously installed on your machine.
+	 * @param Username		The username used to connect to your database.
+	 * @param Password		The password used to connect to your database. Leave empty for none.
+	 * @param Server		The URL where your database is.
+	 * @param Port			The port to access the database on your server.
+	 * @param Database		The name of the database to access.
+	 * @param Settings		How the pool sizes its connections and threads.
+	*/
+	UFUNCTION(BlueprintCallable, Category = "Database|Pool")
+	static UPARAM(DisplayName = "Pool") UDatabasePool* CreatePoolWithSettingsSync(const FString& DriverName, const FString& Username, const FString& Password, const FString& Server, const int32 Port, const FString& Database, const FDatabasePoolSettings& Settings, EDatabaseError& OutError);
+
+	/**
+	 * Creates a new pool asynchronously, with connections opened on demand.
+	 * @param DriverName	The driver to use, previously installed on your machine.
+	 * @param Username		The username used to connect to your database.
+	 * @param Password		The password used to connect to your database. Leave empty for none.
+	 * @param Server		The URL where your database is.
+	 * @param Port			The port to access the database on your server.
+	 * @param Database		The name of the database to access.
+	 * @param Settings		How the pool sizes its connections and threads.
+	 * @param Callback		Called when the pool has been created.
+	*/
+	UFUNCTION(BlueprintCallable, Category = "Database|Pool", Meta = (DisplayName = "Create Pool with Settings and Callback"))
+	static void Blueprint_CreatePoolWithSettings(const FString& DriverName, const FString& Username, const FString& Password, const FString& Server, const int32 Port, const FString& Database, const FDatabasePoolSettings& Settings, FDatabasePoolDelegate Callback);
+
 	/**
 	 * Query the database.
 	 * @param Query The query string.
 	 * @param Parameters The query parameters inserted into the query.
+	 * @param Options How the query is executed. If its result is cached, the callback is called before returning.
+	 * @return A token to cancel the query.
+	*/
+	FDatabaseCancellationToken Query(FString Query, TArray<FDatabaseValue> Parameters, FDatabaseQueryCallback Callback, const FDatabaseQueryOptions& Options = FDatabaseQueryOptions());
+
+	/**
+	 * Query the database and read the rows into structures whose properties are named after the columns.
+	 * See `FQueryResult::ReadRows()` for the supported properties.
+	 * @param Query The query string.
+	 * @param Parameters The query parameters inserted into the query.
+	 * @param Callback Called with the rows, read on the Game Thread. Empty if the query failed.
+	 * @param Options How the query is executed.
+	 * @return A token to cancel the query.
 	*/
-	void Query(FString Query, TArray<FDatabaseValue> Parameters, FDatabaseQueryCallback Callback);
+	template<typename TStruct>
+	FDatabaseCancellationToken QueryInto(FString Query, TArray<FDatabaseValue> Parameters, TFunction<void(EDatabaseError, TArray<TStruct>&&)> Callback, const FDatabaseQueryOptions& Options = FDatabaseQueryOptions())
+	{
+		return UDatabasePool::Query(MoveTemp(Query), MoveTemp(Parameters), FDatabaseQueryCallback::CreateLambda([Callback = MoveTemp(Callback)](EDatabaseError Error, const FQueryResult& Result) -> void
+		{
+			TArray<TStruct> Rows;
+
+			if (Error == EDatabaseError::None)
+			{
+				Result.ReadRows(Rows);
+			}
+
+			if (Callback)
+			{
+				Callback(Error, MoveTemp(Rows));
+			}
+		}), Options);
+	}
 
 	/**
 	 * Query the database synchronously.
@@ -114,35 +224,245 @@ public:
 	 * Query the database.
 	 * @param Query The query string.
 	 * @param Parameters The query parameters inserted into the query.
+	 * @param Options How the query is executed.
+	*/
+	UFUNCTION(BlueprintCallable, Category = "Database|Pool", Meta = (DisplayName = "Query with Callback", AutoCreateRefTerm = "Options"))
+	void Blueprint_Query(FString Query, TArray<FDatabaseValue> Parameters, FDatabaseQueryDelegate Callback, const FDatabaseQueryOptions& Options);
+
+	/**
+	 * Query the database and receive the result in chunks while the cursor stays open.
+	 * The connection is held until the last chunk is read or the stream is stopped.
+	 * Memory is bounded by the chunk size: rows are only fetched once previous chunks have been consumed.
+	 * Each chunk is a standalone result whose row indices start at 0.
+	 * @param Query The query string.
+	 * @param Parameters The query parameters inserted into the query.
+	 * @param ChunkSize The maximum number of rows per chunk.
+	 * @param Callback Called on the Game Thread for each chunk. Return false to stop the stream.
+	 * @param Options How the query is executed.
+	 * @return A token to cancel the stream, including the fetch of the current chunk.
+	*/
+	FDatabaseCancellationToken QueryStream(FString Query, TArray<FDatabaseValue> Parameters, const int32 ChunkSize, FDatabaseQueryChunkCallback Callback, const FDatabaseQueryOptions& Options = FDatabaseQueryOptions());
+
+	/**
+	 * Executes a statement once per row of parameters, e.g. a bulk INSERT or UPDATE.
+	 * Parameters are bound as arrays so the driver sends many rows per round trip.
+	 * All the rows are executed in a single transaction: if one fails, none is applied.
+	 * @param Query The statement string.
+	 * @param Rows The parameters of each execution. All rows must have the same number of parameters.
+	 * @param Callback Called with a result holding the total number of affected rows.
+	 * @param Options How the statement is executed.
+	 * @return A token to cancel the statement. The rows already sent are rolled back.
+	*/
+	FDatabaseCancellationToken ExecuteBatch(FString Query, TArray<TArray<FDatabaseValue>> Rows, FDatabaseQueryCallback Callback, const FDatabaseQueryOptions& Options = FDatabaseQueryOptions());
+
+	/**
+	 * Executes statements once per row of their parameters, in order, in a single transaction.
+	 * See `ExecuteBatch()`.
+	 * @param Batches The statements and the parameters of each of their executions.
+	 * @param Callback Called with a result holding the total number of affected rows.
+	 * @param Options How the statements are executed.
+	 * @return A token to cancel the statements. The rows already sent are rolled back.
+	*/
+	FDatabaseCancellationToken ExecuteBatches(TArray<FDatabaseBatch> Batches, FDatabaseQueryCallback Callback, const FDatabaseQueryOptions& Options = FDatabaseQueryOptions());
+
+	/**
+	 * Executes statements once per row of their parameters, in order, in a single transaction.
+	 * See `ExecuteBatch()`.
+	 * @param OnStarted Called on the pool's thread before the transaction begins, e.g. to wait for a previous one.
+	 * @param OnExecuted Called on the pool's thread once the transaction is committed or failed, before the callback.
+	*/
+	FDatabaseCancellationToken ExecuteBatches(TArray<FDatabaseBatch> Batches, FDatabaseQueryCallback Callback, const FDatabaseQueryOptions& Options, 
+		TUniqueFunction<void()> OnStarted, TUniqueFunction<void()> OnExecuted);
+
+	/**
+	 * Executes statements once per row of their parameters synchronously, in a single transaction.
+	 * /!\ The application will block until the statements complete /!\
+	 * @return A result holding the total number of affected rows.
+	*/
+	FQueryResult ExecuteBatchesSync(const TArray<FDatabaseBatch>& Batches, EDatabaseError& OutError);
+
+	/**
+	 * Creates a buffer queuing writes on the Game Thread and sending them to this pool by batches.
+	 * @param Settings When the writes are sent.
+	 * @return The buffer, or nullptr if the settings are invalid.
+	*/
+	UFUNCTION(BlueprintCallable, Category = "Database|Pool")
+	UPARAM(DisplayName = "Write Buffer") UDatabaseWriteBuffer* CreateWriteBuffer(const FDatabaseWriteBufferSettings& Settings);
+
+	/**
+	 * Leases a connection and starts a transaction on it.
+	 * Queries queued on the transaction run on this connection until it is committed or rolled back.
+	 * The connection and a thread dedicated to transactions are held until then, so queries never wait for them.
+	 * Keep a reference to the transaction: it is rolled back if garbage collected or idle for too long before being committed.
+	 * @param Callback Called with the transaction once it started.
+	 * @param Options The lane of the transaction, used by all its queries.
 	*/
-	UFUNCTION(BlueprintCallable, Category = "Database|Pool", Meta = (DisplayName = "Query with Callback"))
-	void Blueprint_Query(FString Query, TArray<FDatabaseValue> Parameters, FDatabaseQueryDelegate Callback);
+	void BeginTransaction(FDatabaseTransactionCallback Callback, const FDatabaseQueryOptions& Options = FDatabaseQueryOptions());
 
 	/**
-	 * Reconnect all conections. Connections currently used will be skipped.
+	 * Leases a connection and starts a transaction on it.
+	 * @param Callback Called with the transaction once it started.
+	 * @param Options The lane of the transaction, used by all its queries.
+	*/
+	UFUNCTION(BlueprintCallable, Category = "Database|Pool", Meta = (DisplayName = "Begin Transaction with Callback", AutoCreateRefTerm = "Options"))
+	void Blueprint_BeginTransaction(FDatabaseTransactionDelegate Callback, const FDatabaseQueryOptions& Options);
+
+	/**
+	 * Reconnect all conections at once. Connections currently used will be skipped.
 	 * @pram Timeout The connection timeout.
 	 * @param Callback Called when all connections have been reconnected.
 	*/
 	void Reconnect(const int32 Timeout = 0, FPoolReconnectCallback Callback = FPoolReconnectCallback());
 
+	/**
+	 * Sets the maximum number of rows fetched from the database per round trip.
+	 * The rowset of each statement adapts to the size of its previous results up to this limit.
+	 * Queries with parameters are always fetched row by row.
+	 * Larger values speed up large reads at the cost of larger fetch buffers.
+	 * @param RowsetSize The maximum number of rows per round trip. 1 disables bulk fetching.
+	*/
+	UFUNCTION(BlueprintCallable, Category = "Database|Pool")
+	void SetMaxRowsetSize(const int32 RowsetSize);
+
+	/**
+	 * Drops the cached results read from these tables.
+	 * Statements with InvalidateTags already do it, this is for writes made by other means such as transactions.
+	 * @param Tags The tables that changed.
+	*/
+	UFUNCTION(BlueprintCallable, Category = "Database|Pool")
+	void InvalidateCache(const TArray<FName>& Tags);
+
+	/**
+	 * Gets how the pool's callbacks were called on the Game Thread during the last frame.
+	*/
+	UFUNCTION(BlueprintCallable, Category = "Database|Pool")
+	UPARAM(DisplayName = "Stats") FDatabaseCompletionStats GetCompletionStats() const;
+
+	/**
+	 * Gets the counters and latencies of the pool since it was created.
+	 * Also printed by the `Database.DumpPoolStats` console command, and summed in `stat DatabaseConnector`.
+	*/
+	UFUNCTION(BlueprintCallable, Category = "Database|Pool")
+	UPARAM(DisplayName = "Stats") FDatabasePoolStats GetStats() const;
+
+private:
+	/**
+	 * Formats the connection string and logs it without the password.
+	*/
+	static FString MakeConnectionUrl(const FString& DriverName, const FString& Username, const FString& Password, const FString& Server, const int32 Port, const FString& Database, const FDatabasePoolSettings& Settings);
+
+	/**
+	 * Creates the pool object around its connections. Must be called on Game Thread.
+	*/
+	static UDatabasePool* MakePool(FConnectionPoolPtr ConnectionPool, FString Url, const FDatabasePoolSettings& Settings);
+
+	bool TickMaintenance(float DeltaTime);
+
+	/**
+	 * Calls the queued callbacks within the frame budget.
+	*/
+	bool TickCompletions(float DeltaTime);
+
+	/**
+	 * Gets the threads executing the queries of a lane.
+	*/
+	FQueuedThreadPool* GetThreadPool(const EDatabaseQueryPriority Priority) const;
+
 private:
 	/**
 	 * The thread pool this connection pool is going to use.
-	 * We have to use a thread pool as our ODBC driver provides
-	 * only a blocking synchronous interface.
+	 * We have to use a thread pool as most ODBC drivers provide
+	 * only a blocking synchronous interface. With asynchronous
+	 * execution, its threads only start queries.
 	*/
 	FThreadPoolPtr ThreadPool;
 
+	/**
+	 * The threads dedicated to Critical queries so they never queue
+	 * behind other work. Null if no connection is reserved for them.
+	*/
+	FThreadPoolPtr CriticalThreadPool;
+
+	/**
+	 * The threads holding open transactions, apart from the ones running queries.
+	*/
+	FThreadPoolPtr TransactionThreadPool;
+
+	/**
+	 * Seconds an open transaction waits for a query before it is rolled back. 0 to wait indefinitely.
+	*/
+	double TransactionIdleTimeout;
+
 	/**
 	 * The database connection pool.
 	 * Must be thread-safe as it travels across threads.
 	*/
 	FConnectionPoolPtr ConnectionPool;
 
+	/**
+	 * The results of queries with a cache TTL. Null if the cache is disabled.
+	*/
+	FQueryResultCachePtr ResultCache;
+
+	/**
+	 * The coalesced queries being executed.
+	*/
+	TSharedPtr<FInFlightQueries, ESPMode::ThreadSafe> InFlightQueries;
+
+	/**
+	 * If all queries are coalesced.
+	*/
+	bool bCoalesceQueries;
+
+	/**
+	 * Waits for queries executed asynchronously. Null if queries block their thread.
+	*/
+	TSharedPtr<FAsyncQueryExecutor, ESPMode::ThreadSafe> AsyncExecutor;
+
+	/**
+	 * The callbacks waiting to be called on the Game Thread.
+	*/
+	TSharedPtr<FDatabaseCompletionQueue, ESPMode::ThreadSafe> Completions;
+
+	/**
+	 * Seconds per frame spent calling the callbacks. 0 for no limit.
+	*/
+	double CompletionBudget;
+
+	/**
+	 * Set when the pool is destroyed so the transactions holding its threads end.
+	*/
+	TSharedPtr<TAtomic<bool>, ESPMode::ThreadSafe> PoolDestroyed;
+
+	/**
+	 * The streams started by this pool, stopped when it is destroyed.
+	*/
+	TArray<TWeakPtr<FQueryStreamState, ESPMode::ThreadSafe>> Streams;
+
+	FCriticalSection StreamsSection;
+
 private:
 	/**
 	 * The connection DSN of this pool.
 	*/
 	TSharedPtr<const FString, ESPMode::ThreadSafe> ConnectionDsn;
+
+	/**
+	 * Closes idle connections periodically.
+	*/
+#if ENGINE_MAJOR_VERSION > 4
+	FTSTicker::FDelegateHandle MaintenanceHandle;
+#else
+	FDelegateHandle MaintenanceHandle;
+#endif
+
+	/**
+	 * Drains the completion queue every frame.
+	*/
+#if ENGINE_MAJOR_VERSION > 4
+	FTSTicker::FDelegateHandle CompletionHandle;
+#else
+	FDelegateHandle CompletionHandle;
+#endif
 };
 
@@ -0,0 +1,327 @@
+// Copyright Pandores Marketplace 2021. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Database/QueryOptions.h"
+#include "PoolSettings.generated.h"
+
+/**
+ * When the queries of a pool are written to the LogDatabaseSlowQuery category.
+*/
+USTRUCT(BlueprintType)
+struct DATABASECONNECTOR_API FDatabaseSlowQuerySettings
+{
+	GENERATED_BODY()
+public:
+	/**
+	 * Milliseconds a query can take, from being queued to its result being read, before it is logged. 0 to not log queries.
+	*/
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Database|Slow Queries", Meta = (ClampMin = 0, Units = "Milliseconds"))
+	float Threshold = 0.f;
+
+	/**
+	 * The maximum number of queries logged per minute. Queries past the limit are only counted.
+	*/
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Database|Slow Queries", Meta = (ClampMin = 1))
+	int32 MaxEntriesPerMinute = 20;
+
+	/**
+	 * Writes the values bound to the parameters of the query.
+	*/
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Database|Slow Queries")
+	bool bLogParameters = true;
+
+	/**
+	 * Writes string parameters as <redacted>, e.g. when they can hold player data.
+	*/
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Database|Slow Queries")
+	bool bRedactStrings = false;
+
+	/**
+	 * Parameters of queries containing one of these words, case insensitive, are all written as <redacted>.
+	*/
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Database|Slow Queries")
+	TArray<FString> RedactedKeywords = { TEXT("password"), TEXT("token"), TEXT("secret") };
+};
+
+/**
+ * How statements are sent again when their connection is lost.
+*/
+USTRUCT(BlueprintType)
+struct DATABASECONNECTOR_API FDatabaseRetrySettings
+{
+	GENERATED_BODY()
+public:
+	/**
+	 * The number of times a statement is sent again after reconnecting. 0 to fail right away.
+	*/
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Database|Retry", Meta = (ClampMin = 0))
+	int32 MaxRetries = 2;
+
+	/**
+	 * Milliseconds before the first retry. Doubled for each following retry.
+	*/
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Database|Retry", Meta = (ClampMin = 0, Units = "Milliseconds"))
+	float InitialBackoff = 100.f;
+
+	/**
+	 * The maximum milliseconds between two retries.
+	*/
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Database|Retry", Meta = (ClampMin = 0, Units = "Milliseconds"))
+	float MaxBackoff = 2000.f;
+
+	/**
+	 * The share of the backoff removed at random, so connections lost together don't all retry at once.
+	*/
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Database|Retry", Meta = (ClampMin = 0, ClampMax = 1))
+	float Jitter = 0.5f;
+
+	/**
+	 * Only sends again SELECT statements and queries marked as bIdempotent.
+	 * Other writes might have been applied before the connection was lost.
+	 * Batches are retried if the connection is lost before they are committed, as they are then rolled back.
+	*/
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Database|Retry")
+	bool bOnlyRetryIdempotent = false;
+
+public:
+	/**
+	 * Gets the seconds to wait before a retry, jitter included.
+	 * @param Attempt The number of retries already made.
+	*/
+	double GetBackoff(const int32 Attempt) const;
+};
+
+/**
+ * When a pool stops sending queries to a database that keeps failing.
+*/
+USTRUCT(BlueprintType)
+struct DATABASECONNECTOR_API FDatabaseCircuitBreakerSettings
+{
+	GENERATED_BODY()
+public:
+	/**
+	 * The number of consecutive connection failures after which queries fail right away with Unavailable. 0 to never stop.
+	*/
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Database|Circuit Breaker", Meta = (ClampMin = 0))
+	int32 FailureThreshold = 5;
+
+	/**
+	 * Seconds between two queries let through to check if the database answers again.
+	*/
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Database|Circuit Breaker", Meta = (ClampMin = 0, Units = "Seconds"))
+	float ProbeInterval = 5.f;
+};
+
+/**
+ * How a pool sizes its connections and threads.
+*/
+USTRUCT(BlueprintType)
+struct DATABASECONNECTOR_API FDatabasePoolSettings
+{
+	GENERATED_BODY()
+public:
+	/**
+	 * The number of connections opened with the pool and kept open when idle.
+	*/
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Database|Pool", Meta = (ClampMin = 0))
+	int32 MinConnections = 1;
+
+	/**
+	 * The maximum number of connections opened under load.
+	*/
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Database|Pool", Meta = (ClampMin = 1))
+	int32 MaxConnections = 8;
+
+	/**
+	 * The number of threads executing Normal and Background queries. 0 to use one thread per shared connection,
+	 * or a few threads with asynchronous execution.
+	*/
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Database|Pool", Meta = (ClampMin = 0))
+	int32 ThreadCount = 0;
+
+	/**
+	 * Seconds after which an unused connection is closed, down to MinConnections. 0 to never close them.
+	*/
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Database|Pool", Meta = (ClampMin = 0, Units = "Seconds"))
+	float IdleTimeout = 60.f;
+
+	/**
+	 * Seconds a connection stays unused before the pool checks in the background that it still works,
+	 * so lost connections are opened again before a query needs them. 0 to not check them.
+	*/
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Database|Pool", Meta = (ClampMin = 0, Units = "Seconds"))
+	float HealthCheckInterval = 30.f;
+
+	/**
+	 * The statement executed to check a connection. Some databases need a table, e.g. "SELECT 1 FROM DUAL" for Oracle.
+	*/
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Database|Pool")
+	FString HealthCheckQuery = TEXT("SELECT 1");
+
+	/**
+	 * Seconds after which a connection is opened again, e.g. to follow load balancers or failovers. 0 for no limit.
+	 * Unused connections are renewed in the background, others when they are acquired.
+	*/
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Database|Pool", Meta = (ClampMin = 0, Units = "Seconds"))
+	float MaxLifetime = 0.f;
+
+	/**
+	 * Milliseconds a query waits for a busy connection before a new one is opened.
+	*/
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Database|Pool", Meta = (ClampMin = 0, Units = "Milliseconds"))
+	float GrowthWaitTime = 5.f;
+
+	/**
+	 * Seconds a query waits for a connection before failing with a timeout error. 0 to wait indefinitely.
+	*/
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Database|Pool", Meta = (ClampMin = 0, Units = "Seconds"))
+	float AcquireTimeout = 0.f;
+
+	/**
+	 * The number of connections only Critical queries can use, with as many dedicated threads.
+	*/
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Database|Pool", Meta = (ClampMin = 0))
+	int32 ReservedCriticalConnections = 1;
+
+	/**
+	 * The maximum number of connections used by Background queries at once. 0 to use half of the connections.
+	*/
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Database|Pool", Meta = (ClampMin = 0))
+	int32 MaxBackgroundConnections = 0;
+
+	/**
+	 * The number of transactions open at once, each holding a dedicated thread and a connection until it ends.
+	 * Transactions past the limit start once another one ends.
+	*/
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Database|Pool", Meta = (ClampMin = 1))
+	int32 MaxTransactions = 2;
+
+	/**
+	 * Seconds an open transaction waits for a query before it is rolled back, e.g. when its owner dropped it. 0 to wait indefinitely.
+	*/
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Database|Pool", Meta = (ClampMin = 0, Units = "Seconds"))
+	float TransactionIdleTimeout = 30.f;
+
+	/**
+	 * The memory cached results can use before the least recently used are evicted. 0 disables the cache.
+	 * Results are only cached for queries with a CacheTTL.
+	*/
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Database|Pool", Meta = (ClampMin = 0, Units = "Megabytes"))
+	int32 ResultCacheSize = 32;
+
+	/**
+	 * Attaches queries to identical running ones instead of executing them again, as if they all had bCoalesce set.
+	 * Only reads are coalesced, identical writes are all executed.
+	*/
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Database|Pool")
+	bool bCoalesceQueries = false;
+
+	/**
+	 * Executes queries asynchronously if the driver supports it: a few threads then drive all
+	 * the connections instead of one thread blocked per connection. Windows only.
+	 * Falls back to a thread per connection if unsupported.
+	*/
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Database|Pool")
+	bool bAsyncExecution = false;
+
+	/**
+	 * Binds string parameters as wide characters, as they are stored in FString, instead of converting them to UTF-8.
+	 * Requires a Unicode driver, such as the Unicode variants of the MySQL and PostgreSQL drivers.
+	 * Wide columns (NCHAR, NVARCHAR, ...) are always read without conversion.
+	*/
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Database|Pool")
+	bool bWideStringParameters = false;
+
+	/**
+	 * Stores the repeated strings of a column once in results, e.g. names or categories.
+	 * Saves memory and copies on columns with few distinct values at the cost of a lookup per cell.
+	 * Columns with many distinct values stop being deduplicated.
+	*/
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Database|Pool")
+	bool bDeduplicateStrings = false;
+
+	/**
+	 * Milliseconds per frame the Game Thread spends calling the pool's callbacks.
+	 * Callbacks past the budget are called on the next frames. 0 for no limit.
+	*/
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Database|Pool", Meta = (ClampMin = 0, Units = "Milliseconds"))
+	float CompletionBudget = 2.f;
+
+	/**
+	 * Logs the queries slower than a threshold with their timings and parameters.
+	*/
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Database|Pool")
+	FDatabaseSlowQuerySettings SlowQueries;
+
+	/**
+	 * How statements are sent again when their connection is lost.
+	*/
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Database|Pool")
+	FDatabaseRetrySettings Retry;
+
+	/**
+	 * When queries fail right away because the database keeps failing.
+	*/
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Database|Pool")
+	FDatabaseCircuitBreakerSettings CircuitBreaker;
+
+public:
+	/**
+	 * The default number of threads starting asynchronous queries.
+	*/
+	static constexpr int32 DefaultAsyncThreadCount = 4;
+
+public:
+	/**
+	 * Settings of a pool with a fixed number of connections, always open.
+	*/
+	static FDatabasePoolSettings Fixed(const int32 PoolSize);
+
+	bool IsValid() const;
+
+	/**
+	 * @param bWithAsyncExecution If queries are executed asynchronously.
+	*/
+	int32 GetThreadCount(const bool bWithAsyncExecution = false) const;
+
+	int32 GetMaxBackgroundConnections() const;
+};
+
+/**
+ * When a write buffer sends its writes to the database.
+*/
+USTRUCT(BlueprintType)
+struct DATABASECONNECTOR_API FDatabaseWriteBufferSettings
+{
+	GENERATED_BODY()
+public:
+	/**
+	 * The number of pending writes that triggers a flush.
+	*/
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Database|Write Buffer", Meta = (ClampMin = 1))
+	int32 FlushThreshold = 256;
+
+	/**
+	 * Seconds between two flushes of the pending writes. 0 to only flush on the threshold or when asked.
+	*/
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Database|Write Buffer", Meta = (ClampMin = 0, Units = "Seconds"))
+	float FlushInterval = 1.f;
+
+	/**
+	 * The number of pending writes past which new writes are rejected,
+	 * e.g. while the database is slower than the writes.
+	*/
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Database|Write Buffer", Meta = (ClampMin = 1))
+	int32 MaxPendingWrites = 8192;
+
+	/**
+	 * The lane of the flushes.
+	*/
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Database|Write Buffer")
+	EDatabaseQueryPriority Priority = EDatabaseQueryPriority::Background;
+
+public:
+	bool IsValid() const;
+};
@@ -0,0 +1,151 @@
+// Copyright Pandores Marketplace 2021. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "PoolStats.generated.h"
+
+/**
+ * How a pool's callbacks are called on the Game Thread.
+*/
+USTRUCT(BlueprintType)
+struct DATABASECONNECTOR_API FDatabaseCompletionStats
+{
+	GENERATED_BODY()
+public:
+	/**
+	 * Callbacks waiting for the next frames.
+	*/
+	UPROPERTY(BlueprintReadOnly, Category = "Database|Stats")
+	int32 Pending = 0;
+
+	/**
+	 * Callbacks called during the last frame.
+	*/
+	UPROPERTY(BlueprintReadOnly, Category = "Database|Stats")
+	int32 LastFrameCount = 0;
+
+	/**
+	 * Milliseconds spent in callbacks during the last frame.
+	*/
+	UPROPERTY(BlueprintReadOnly, Category = "Database|Stats")
+	float LastFrameTime = 0.f;
+
+	/**
+	 * Average milliseconds between a query completing and its callback, during the last frame.
+	*/
+	UPROPERTY(BlueprintReadOnly, Category = "Database|Stats")
+	float AverageLatency = 0.f;
+
+	/**
+	 * Longest milliseconds between a query completing and its callback, during the last frame.
+	*/
+	UPROPERTY(BlueprintReadOnly, Category = "Database|Stats")
+	float MaxLatency = 0.f;
+
+	/**
+	 * Callbacks called since the pool was created.
+	*/
+	UPROPERTY(BlueprintReadOnly, Category = "Database|Stats")
+	int64 TotalCount = 0;
+};
+
+/**
+ * The distribution of a duration, in milliseconds.
+ * Percentiles are rounded up to the next power of two microseconds.
+*/
+USTRUCT(BlueprintType)
+struct DATABASECONNECTOR_API FDatabaseLatencyStats
+{
+	GENERATED_BODY()
+public:
+	/**
+	 * The number of durations recorded.
+	*/
+	UPROPERTY(BlueprintReadOnly, Category = "Database|Stats")
+	int64 Count = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Database|Stats")
+	float P50 = 0.f;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Database|Stats")
+	float P99 = 0.f;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Database|Stats")
+	float Max = 0.f;
+};
+
+/**
+ * What a pool did since it was created.
+*/
+USTRUCT(BlueprintType)
+struct DATABASECONNECTOR_API FDatabasePoolStats
+{
+	GENERATED_BODY()
+public:
+	/**
+	 * Tasks waiting for a pool thread.
+	*/
+	UPROPERTY(BlueprintReadOnly, Category = "Database|Stats")
+	int32 QueuedTasks = 0;
+
+	/**
+	 * Threads waiting for a connection to be released.
+	*/
+	UPROPERTY(BlueprintReadOnly, Category = "Database|Stats")
+	int32 WaitingForConnection = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Database|Stats")
+	int32 OpenConnections = 0;
+
+	/**
+	 * Statements executed, batches included.
+	*/
+	UPROPERTY(BlueprintReadOnly, Category = "Database|Stats")
+	int64 Queries = 0;
+
+	/**
+	 * Statements that failed, cancelled ones included.
+	*/
+	UPROPERTY(BlueprintReadOnly, Category = "Database|Stats")
+	int64 Failures = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Database|Stats")
+	int64 RowsReturned = 0;
+
+	/**
+	 * Connections re-established after being lost, or by `Reconnect()`.
+	*/
+	UPROPERTY(BlueprintReadOnly, Category = "Database|Stats")
+	int64 Reconnects = 0;
+
+	/**
+	 * Times no connection was released before the acquire timeout.
+	*/
+	UPROPERTY(BlueprintReadOnly, Category = "Database|Stats")
+	int64 AcquireTimeouts = 0;
+
+	/**
+	 * From a task being queued to a pool thread starting it.
+	*/
+	UPROPERTY(BlueprintReadOnly, Category = "Database|Stats")
+	FDatabaseLatencyStats QueueWait;
+
+	/**
+	 * Waiting for a connection.
+	*/
+	UPROPERTY(BlueprintReadOnly, Category = "Database|Stats")
+	FDatabaseLatencyStats AcquireWait;
+
+	/**
+	 * Executing statements, until their first rows can be fetched.
+	*/
+	UPROPERTY(BlueprintReadOnly, Category = "Database|Stats")
+	FDatabaseLatencyStats Execute;
+
+	/**
+	 * Fetching and decoding results.
+	*/
+	UPROPERTY(BlueprintReadOnly, Category = "Database|Stats")
+	FDatabaseLatencyStats Fetch;
+};
@@ -0,0 +1,50 @@
+// Copyright Pandores Marketplace 2021. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+struct FDatabaseCancellationState;
+
+/**
+ * Cancels a query sent to a pool. Copies refer to the same query.
+ * Can be used from any thread.
+*/
+class DATABASECONNECTOR_API FDatabaseCancellationToken
+{
+public:
+	/**
+	 * Creates a token not bound to any query.
+	*/
+	FDatabaseCancellationToken() = default;
+
+	/**
+	 * Creates a token for a new query.
+	*/
+	static FDatabaseCancellationToken Create();
+
+	/**
+	 * Cancels the query. If it is still queued, it is dropped.
+	 * If it is running, the driver is asked to cancel the statement.
+	 * The query's callback is called with EDatabaseError::Cancelled.
+	*/
+	void Cancel() const;
+
+	/**
+	 * Drops the query if it didn't start yet, typically because nobody is interested in the result anymore.
+	 * Running queries complete normally.
+	*/
+	void Abandon() const;
+
+	bool IsCancelled() const;
+
+	bool IsValid() const;
+
+	/**
+	 * Gets the state shared with the thread executing the query.
+	*/
+	FDatabaseCancellationState* GetState() const;
+
+private:
+	TSharedPtr<FDatabaseCancellationState, ESPMode::ThreadSafe> State;
+};
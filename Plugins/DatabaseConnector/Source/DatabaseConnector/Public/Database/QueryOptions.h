@@ -0,0 +1,84 @@
+// Copyright Pandores Marketplace 2021. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "QueryOptions.generated.h"
+
+/**
+ * The lane a query is executed in.
+*/
+UENUM(BlueprintType)
+enum class EDatabaseQueryPriority : uint8
+{
+	/* Interactive requests a player waits for. Runs on dedicated threads and can use reserved connections. */
+	Critical,
+	Normal,
+	/* Work nobody waits for. Only uses a share of the connections and runs after queued Normal work. */
+	Background
+};
+
+/**
+ * How a query is executed.
+*/
+USTRUCT(BlueprintType)
+struct DATABASECONNECTOR_API FDatabaseQueryOptions
+{
+	GENERATED_BODY()
+public:
+	FDatabaseQueryOptions() = default;
+	FDatabaseQueryOptions(const EDatabaseQueryPriority InPriority)
+		: Priority(InPriority)
+	{}
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Database|Query")
+	EDatabaseQueryPriority Priority = EDatabaseQueryPriority::Normal;
+
+	/**
+	 * Seconds the statement can run before the driver cancels it with a timeout error. 0 for no limit.
+	 * Drivers only support whole seconds. Waiting for a connection is bounded by the pool's AcquireTimeout instead.
+	*/
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Database|Query", Meta = (ClampMin = 0, Units = "Seconds"))
+	float Timeout = 0.f;
+
+	/**
+	 * Seconds the result is kept by the pool and given to identical queries, with the same SQL and parameters,
+	 * without reaching the database. 0 to not cache it. Only successful results of SELECT statements are cached.
+	*/
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Database|Query", Meta = (ClampMin = 0, Units = "Seconds"))
+	float CacheTTL = 0.f;
+
+	/**
+	 * The tables a cached result is read from. It is dropped when one of them is invalidated.
+	*/
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Database|Query")
+	TArray<FName> CacheTags;
+
+	/**
+	 * The tables the statement writes to. Cached results tagged with one of them are dropped once it executed.
+	*/
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Database|Query")
+	TArray<FName> InvalidateTags;
+
+	/**
+	 * If an identical query, with the same SQL and parameters, is already running, waits for its result instead of executing again.
+	 * The attached query shares the options and the outcome of the running one. Cancelling one of them only
+	 * detaches it: the execution is cancelled once all the identical queries are.
+	 * Always enabled if the pool was created with bCoalesceQueries. Ignored for writes.
+	*/
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Database|Query")
+	bool bCoalesce = false;
+
+	/**
+	 * If the statement can be executed twice without changing the outcome, so it can be sent again
+	 * when the connection is lost even if the pool only retries idempotent statements. SELECT statements always are.
+	*/
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Database|Query")
+	bool bIdempotent = false;
+
+	/**
+	 * Identifies the call site in the slow query log, e.g. "Inventory.LoadItems".
+	*/
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Database|Query")
+	FName Label;
+};
@@ -21,6 +21,45 @@ public:
 	int32 Size = 0;
 };
 
+struct FQueryResultInternal;
+class UScriptStruct;
+
+/**
+ * A column of query results, found by name once and then accessed by index.
+ * Can be reused for all the rows of a result and for other results with the same columns.
+ * Used with a result having other columns, it is resolved again by name.
+*/
+USTRUCT(BlueprintType)
+struct DATABASECONNECTOR_API FQueryColumnHandle
+{
+	GENERATED_BODY()
+public:
+	FQueryColumnHandle() = default;
+
+	/**
+	 * @return If the column was found when the handle was made.
+	*/
+	FORCEINLINE bool IsValid() const { return ColumnIndex != INDEX_NONE; }
+
+	FORCEINLINE const FString& GetColumnName() const { return ColumnName; }
+
+private:
+	UPROPERTY()
+	FString ColumnName;
+
+	UPROPERTY()
+	int32 ColumnIndex = INDEX_NONE;
+
+	/**
+	 * The layout of the result the handle was made from.
+	*/
+	UPROPERTY()
+	uint32 LayoutHash = 0;
+
+private:
+	friend struct FQueryResult;
+};
+
 /**
  * The query of a result.
  * Holds a pointer to a shared dataset. Cheap to copy and Thread-safe.
@@ -30,6 +69,9 @@ struct DATABASECONNECTOR_API FQueryResult
 {
 	GENERATED_BODY()
 
+private:
+	friend class FQueryResultCache;
+
 public:
 	FQueryResult();
 	~FQueryResult();
@@ -39,6 +81,9 @@ public:
 	/* Initializer constructor. Create internally a shared result. */
 	FQueryResult(TArray<FString> Headers, TArray64<TArray<FDatabaseValue>> Values, TArray<FColumnMetadata> Metadata, uint64 AffectedRows);
 
+	/* Wraps an already built dataset. */
+	explicit FQueryResult(TSharedRef<const FQueryResultInternal, ESPMode::ThreadSafe> InInternal);
+
 	/* Copy constructor. It is cheap, whatever the resultset size is. */
 	FQueryResult(const FQueryResult&);
 
@@ -50,21 +95,53 @@ public:
 
 	/**
 	 * Gets a value by column name. 
-	 * Access cost is O(ColumnCount) so it is O(1) on a fixed table.
+	 * Columns are found with a case-insensitive hash lookup.
+	 * Values are stored by column, the returned value is a copy of the cell.
 	 * @param ColumnName The column to get the value from.
 	 * @param RowIndex The row index to get the value from.
 	 * @return The value at the specified location.
 	*/
-	const FDatabaseValue& Get(const FString& ColumnName, const int64 RowIndex) const;
+	FDatabaseValue Get(const FString& ColumnName, const int64 RowIndex) const;
 
 	/**
 	 * Gets a value by column index.
 	 * Access cost is O(1) (faster than get by column name).
+	 * Values are stored by column, the returned value is a copy of the cell.
 	 * @param ColumnName The column to get the value from.
 	 * @param RowIndex The row index to get the value from.
 	 * @return The value at the specified location.
 	*/
-	const FDatabaseValue& Get(const int32& ColumnIndex, const int64 RowIndex) const;
+	FDatabaseValue Get(const int32& ColumnIndex, const int64 RowIndex) const;
+
+	/**
+	 * Gets a value by column handle.
+	 * Access cost is O(1) if the handle was made from a result with the same columns.
+	 * @param Column The column to get the value from.
+	 * @param RowIndex The row index to get the value from.
+	 * @return The value at the specified location.
+	*/
+	FDatabaseValue Get(const FQueryColumnHandle& Column, const int64 RowIndex) const;
+
+	/**
+	 * Finds a column once to access it by index afterward.
+	 * @param ColumnName The name of the column, case-insensitive.
+	 * @return The handle of the column. Invalid if not found.
+	*/
+	FQueryColumnHandle GetColumnHandle(const FString& ColumnName) const;
+
+	/**
+	 * Gets the index of a column.
+	 * @param ColumnName The name of the column, case-insensitive.
+	 * @return The index of the column or INDEX_NONE if not found.
+	*/
+	int32 GetColumnIndex(const FString& ColumnName) const;
+
+	/**
+	 * Gets the index of a column in this result.
+	 * @param Column A handle made from this result or from another result.
+	 * @return The index of the column or INDEX_NONE if not found.
+	*/
+	int32 GetColumnIndex(const FQueryColumnHandle& Column) const;
 
 	/**
 	 * Gets the columns.
@@ -74,11 +151,22 @@ public:
 
 	/**
 	 * Gets a row.
-	 * Access cost is O(1).
+	 * The first call builds all the rows of the result, kept as long as any copy of it, cached ones included.
+	 * This takes several times the memory of the result itself.
 	 * @return The row or nullptr if invalid index.
 	*/
+	UE_DEPRECATED(5.4, "Builds and keeps a copy of every row of the result. Use GetRow(RowIndex, OutRow) or Get() instead.")
 	const TArray<FDatabaseValue>* GetRow(const int64 RowIndex) const;
 
+	/**
+	 * Gets a row.
+	 * Access cost is O(ColumnCount).
+	 * @param RowIndex The row to get.
+	 * @param OutRow The row's values. Reuse the same array across calls to avoid reallocations.
+	 * @return If the row exists. OutRow is emptied otherwise.
+	*/
+	bool GetRow(const int64 RowIndex, TArray<FDatabaseValue>& OutRow) const;
+
 	/**
 	 * Dumps the data nicely in the output log.
 	*/
@@ -122,6 +210,62 @@ public:
 	*/
 	int64 GetAffectedRows() const;
 
+	/**
+	 * Gets the memory used by the dataset, shared by all the copies of this result.
+	 * @return The size in bytes.
+	*/
+	SIZE_T GetAllocatedSize() const;
+
+	/**
+	 * Reads the rows into structures whose properties are named after the columns.
+	 * Cells are written straight to the properties, without building FDatabaseValues.
+	 * How columns bind to properties is computed once per structure and set of columns.
+	 * Supports booleans, numbers, enums, strings, names, texts, FDatabaseTimestamp,
+	 * FDatabaseDate, FDateTime and FDatabaseValue properties.
+	 * @param OutRows The rows, one per row of the result.
+	 * @return If the rows could be read.
+	*/
+	template<typename TStruct>
+	bool ReadRows(TArray<TStruct>& OutRows) const
+	{
+		const int64 RowCount = GetRowCount();
+
+		OutRows.Reset();
+
+		if (RowCount > MAX_int32)
+		{
+			return false;
+		}
+
+		OutRows.SetNum((int32)RowCount);
+
+		return ReadRows(TStruct::StaticStruct(), OutRows.GetData(), 0, RowCount);
+	}
+
+	/**
+	 * Reads a row into a structure whose properties are named after the columns.
+	 * NULL cells and columns without property leave the structure untouched.
+	 * @param RowIndex The row to read.
+	 * @param OutRow The structure to write to.
+	 * @return If the row exists.
+	*/
+	template<typename TStruct>
+	bool ReadRow(const int64 RowIndex, TStruct& OutRow) const
+	{
+		return ReadRows(TStruct::StaticStruct(), &OutRow, RowIndex, 1);
+	}
+
+	/**
+	 * Reads rows into contiguous structures whose properties are named after the columns.
+	 * NULL cells and columns without property leave the structures untouched.
+	 * @param Struct	The type of the structures.
+	 * @param OutRows	The first structure, followed by the others. Must hold RowCount structures.
+	 * @param FirstRow	The first row to read.
+	 * @param RowCount	The number of rows to read.
+	 * @return If the rows exist.
+	*/
+	bool ReadRows(const UScriptStruct* Struct, void* OutRows, const int64 FirstRow, const int64 RowCount) const;
+
 private:
-	TSharedPtr<const struct FQueryResultInternal, ESPMode::ThreadSafe> Internal;
+	TSharedPtr<const FQueryResultInternal, ESPMode::ThreadSafe> Internal;
 };
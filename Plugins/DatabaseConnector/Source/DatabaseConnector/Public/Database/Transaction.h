@@ -0,0 +1,100 @@
+// Copyright Pandores Marketplace 2021. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Database/Errors.h"
+#include "Database/Value.h"
+#include "Database/QueryResult.h"
+#include "Database/Pool.h"
+#include "Transaction.generated.h"
+
+struct FDatabaseTransactionState;
+class FDatabaseCompletionQueue;
+
+/**
+ * A transaction running on a connection leased from a pool.
+ * Queries are executed in the order they are queued, on the same connection,
+ * and are only applied once `Commit()` succeeds.
+ * The connection and one pool thread are held until the transaction ends.
+ * A transaction destroyed before being committed is rolled back.
+*/
+UCLASS(BlueprintType)
+class DATABASECONNECTOR_API UDatabaseTransaction : public UObject
+{
+	GENERATED_BODY()
+private:
+	friend class UDatabasePool;
+
+public:
+	/**
+	 * Don't use NewObject on this class. Use `UDatabasePool::BeginTransaction()` instead.
+	*/
+	 UDatabaseTransaction();
+	~UDatabaseTransaction();
+
+	/**
+	 * Queues a query in the transaction.
+	 * @param Query The query string.
+	 * @param Parameters The query parameters inserted into the query.
+	 * @param Callback Called when the query completes.
+	*/
+	void Query(FString Query, TArray<FDatabaseValue> Parameters, FDatabaseQueryCallback Callback);
+
+	/**
+	 * Queues a query in the transaction.
+	 * @param Query The query string.
+	 * @param Parameters The query parameters inserted into the query.
+	*/
+	UFUNCTION(BlueprintCallable, Category = "Database|Transaction", Meta = (DisplayName = "Query with Callback"))
+	void Blueprint_Query(FString Query, TArray<FDatabaseValue> Parameters, FDatabaseQueryDelegate Callback);
+
+	/**
+	 * Commits the transaction once the queued queries completed and releases its connection.
+	 * If the commit fails, the transaction is rolled back.
+	 * @param Callback Called when the transaction has been committed.
+	*/
+	void Commit(FDatabaseTransactionEndCallback Callback = FDatabaseTransactionEndCallback());
+
+	/**
+	 * Rolls back the transaction once the queued queries completed and releases its connection.
+	 * @param Callback Called when the transaction has been rolled back.
+	*/
+	void Rollback(FDatabaseTransactionEndCallback Callback = FDatabaseTransactionEndCallback());
+
+	UFUNCTION(BlueprintCallable, Category = "Database|Transaction", Meta = (DisplayName = "Commit with Callback"))
+	void Blueprint_Commit(FDatabaseTransactionEndDelegate Callback);
+
+	UFUNCTION(BlueprintCallable, Category = "Database|Transaction", Meta = (DisplayName = "Rollback with Callback"))
+	void Blueprint_Rollback(FDatabaseTransactionEndDelegate Callback);
+
+	/**
+	 * @return If queries can still be queued in this transaction.
+	*/
+	UFUNCTION(BlueprintPure, Category = "Database|Transaction")
+	bool IsActive() const;
+
+private:
+	void End(const bool bCommit, FDatabaseTransactionEndCallback&& Callback);
+
+private:
+	/**
+	 * Shared with the thread holding the connection.
+	*/
+	TSharedPtr<FDatabaseTransactionState, ESPMode::ThreadSafe> State;
+
+	/**
+	 * The connection DSN of the pool.
+	*/
+	TSharedPtr<const FString, ESPMode::ThreadSafe> ConnectionDsn;
+
+	/**
+	 * The callbacks queue of the pool.
+	*/
+	TSharedPtr<FDatabaseCompletionQueue, ESPMode::ThreadSafe> Completions;
+
+	/**
+	 * Set once Commit() or Rollback() has been called.
+	*/
+	bool bEnded;
+};
@@ -61,6 +61,24 @@ public:
 	static FDatabaseDate Now();
 };
 
+/**
+ * Inline storage of the scalar values a FDatabaseValue can hold.
+*/
+union FDatabaseValueScalar
+{
+	bool				bBoolean;
+	uint8				Uint8;
+	int32				Int32;
+	int64				Int64;
+	double				Double;
+	FDatabaseTimestamp	Timestamp;
+	FDatabaseDate		Date;
+};
+
+/**
+ * A value sent to or read from the database.
+ * Scalars are stored inline, only strings may allocate.
+*/
 USTRUCT(BlueprintType)
 struct DATABASECONNECTOR_API FDatabaseValue
 {
@@ -100,7 +118,7 @@ public:
 	operator FDatabaseTimestamp()	const;
 	operator FDatabaseDate()		const;
 
-	FORCEINLINE bool	IsNull()   const { return GetType() == EDatabaseValueType::Null; }
+	FORCEINLINE bool	IsNull()   const { return Type == EDatabaseValueType::Null; }
 	FORCEINLINE uint8	ToUint8()  const { return *this; }
 	FORCEINLINE int32   ToInt32()  const { return *this; }
 	FORCEINLINE int64   ToInt64()  const { return *this; }
@@ -111,12 +129,35 @@ public:
 	FORCEINLINE FDatabaseTimestamp	ToTimestamp()	const { return *this; }
 	FORCEINLINE FDatabaseDate		ToDate()		const { return *this; }
 
-	EDatabaseValueType GetType() const;
+	FORCEINLINE EDatabaseValueType GetType() const { return Type; }
+
+	/**
+	 * Compares the types and the values. No conversion is made: an Int32 never equals an Int64.
+	 * Doubles are compared bit by bit, as they are hashed: 0.0 and -0.0 differ, a NaN equals itself.
+	*/
+	bool operator==(const FDatabaseValue& Other) const;
+	FORCEINLINE bool operator!=(const FDatabaseValue& Other) const { return !(*this == Other); }
+
+	friend DATABASECONNECTOR_API uint32 GetTypeHash(const FDatabaseValue& Value);
 
 private:
-	TUniquePtr<class FDatabaseValueInternal> Internal;
+	/**
+	 * The type of the value held.
+	*/
+	EDatabaseValueType Type;
+
+	/**
+	 * The value if the type is a scalar.
+	*/
+	FDatabaseValueScalar Scalar;
+
+	/**
+	 * The value if the type is String. Empty strings don't allocate.
+	*/
+	FString String;
 
 private:
 	friend class FDatabasePoolQueryTask;
 	friend class UDatabasePool;
+	friend class FParameterArena;
 };
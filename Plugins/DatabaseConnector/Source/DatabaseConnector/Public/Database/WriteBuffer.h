@@ -0,0 +1,156 @@
+// Copyright Pandores Marketplace 2021. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Database/Errors.h"
+#include "Database/Value.h"
+#include "Database/Batch.h"
+#include "Database/PoolSettings.h"
+#include "Database/Pool.h"
+#include "Containers/Ticker.h"
+#include "Runtime/Launch/Resources/Version.h"
+#include "WriteBuffer.generated.h"
+
+struct FDatabaseFlushCompletion;
+
+/**
+ * Queues frequent small writes, e.g. telemetry or inventory changes, and sends them
+ * to a pool by batches in a single transaction, instead of one round trip per write.
+ * Writes are flushed when enough are pending, periodically, when asked, and before exiting.
+ * Writes still pending when the buffer is destroyed are sent to its pool, or dropped if the pool is destroyed too.
+ * Only one flush runs at a time so flushes are applied in order.
+ * Must be used on the Game Thread.
+*/
+UCLASS(BlueprintType)
+class DATABASECONNECTOR_API UDatabaseWriteBuffer : public UObject
+{
+	GENERATED_BODY()
+private:
+	friend class UDatabasePool;
+
+public:
+	/**
+	 * Don't use NewObject on this class. Use `UDatabasePool::CreateWriteBuffer()` instead.
+	*/
+	UDatabaseWriteBuffer();
+
+	/**
+	 * Queues a write, sent with the next flush.
+	 * Writes are grouped by statement, in the order each statement was first queued since the last flush.
+	 * Flush between writes of different statements that depend on each other.
+	 * @param Query The statement string, e.g. an INSERT or an UPDATE.
+	 * @param Parameters The query parameters inserted into the statement.
+	 * @param Key What the write changes, e.g. the id of a row. A write with the same statement and key
+	 *			  replaces the pending one so only the last is sent. Empty to never merge the write.
+	 * @return False if the buffer is full, or the number of parameters differs from the pending writes
+	 *		   of this statement. The write is dropped.
+	*/
+	UFUNCTION(BlueprintCallable, Category = "Database|Write Buffer", Meta = (AutoCreateRefTerm = "Parameters"))
+	bool Write(const FString& Query, const TArray<FDatabaseValue>& Parameters, const FString& Key = TEXT(""));
+
+	/**
+	 * Sends the pending writes in a single transaction.
+	 * If a flush is running, they are sent once it completes.
+	 * @param Callback Called with a result holding the number of affected rows. The writes of a failed flush are dropped.
+	*/
+	void Flush(FDatabaseQueryCallback Callback = FDatabaseQueryCallback());
+
+	/**
+	 * Sends the pending writes in a single transaction.
+	 * @param Callback Called with a result holding the number of affected rows.
+	*/
+	UFUNCTION(BlueprintCallable, Category = "Database|Write Buffer", Meta = (DisplayName = "Flush with Callback"))
+	void Blueprint_Flush(FDatabaseQueryDelegate Callback);
+
+	/**
+	 * Sends the pending writes synchronously, once the running flush is committed.
+	 * /!\ The application will block until the writes complete /!\
+	*/
+	UFUNCTION(BlueprintCallable, Category = "Database|Write Buffer")
+	void FlushSync(EDatabaseError& OutError);
+
+	/**
+	 * @return The number of writes waiting for a flush, merged writes counted once.
+	*/
+	UFUNCTION(BlueprintPure, Category = "Database|Write Buffer")
+	int32 GetPendingCount() const;
+
+	/**
+	 * @return The number of writes dropped because the buffer was full.
+	*/
+	UFUNCTION(BlueprintPure, Category = "Database|Write Buffer")
+	int64 GetRejectedCount() const;
+
+	virtual void BeginDestroy() override;
+
+private:
+	void Initialize(UDatabasePool* InPool, const FDatabaseWriteBufferSettings& InSettings);
+
+	/**
+	 * Sends the pending writes if no flush is running.
+	*/
+	void StartFlush();
+
+	/**
+	 * Takes the pending writes out of the buffer.
+	*/
+	TArray<FDatabaseBatch> TakePending();
+
+	bool TickFlush(float DeltaTime);
+
+	void OnPreExit();
+
+private:
+	UPROPERTY()
+	UDatabasePool* Pool;
+
+	FDatabaseWriteBufferSettings Settings;
+
+	/**
+	 * The pending writes, a batch per statement.
+	*/
+	TArray<FDatabaseBatch> Batches;
+
+	/**
+	 * The index of the batch of each statement.
+	*/
+	TMap<FString, int32> BatchIndices;
+
+	/**
+	 * The row of the pending write of each batch index and key.
+	*/
+	TMap<TPair<int32, FString>, int32> KeyedRows;
+
+	int32 PendingCount;
+
+	int64 RejectedCount;
+
+	/**
+	 * The writes dropped since the last flush, reported when it starts.
+	*/
+	int32 RecentRejectedCount;
+
+	/**
+	 * If a flush is running.
+	*/
+	bool bFlushing;
+
+	/**
+	 * Signaled once the running flush is committed or failed.
+	*/
+	TSharedPtr<FDatabaseFlushCompletion, ESPMode::ThreadSafe> RunningFlush;
+
+	/**
+	 * The callbacks of the flush sending the pending writes.
+	*/
+	TArray<FDatabaseQueryCallback> FlushCallbacks;
+
+#if ENGINE_MAJOR_VERSION > 4
+	FTSTicker::FDelegateHandle FlushHandle;
+#else
+	FDelegateHandle FlushHandle;
+#endif
+
+	FDelegateHandle PreExitHandle;
+};
@@ -7,6 +7,11 @@
 
 DECLARE_LOG_CATEGORY_EXTERN(LogDatabaseConnector, Log, All);
 
+/**
+ * Queries slower than the threshold of their pool.
+*/
+DECLARE_LOG_CATEGORY_EXTERN(LogDatabaseSlowQuery, Log, All);
+
 class FDatabaseConnectorModule : public IModuleInterface
 {
 public: